@@ -0,0 +1,472 @@
+#include "StdAfx.h"
+#include "common/RDMUtils.h"
+#include "common/RDMDict.h"
+#include "ChainHandler.h"
+#include <boost/lexical_cast.hpp>
+#include <boost/unordered_set.hpp>
+
+// records requested ahead of the one the resolution waits for
+static const int prefetchRecords = 4;
+
+static const char* linkFieldNames[] =
+{
+    "LINK_1", "LINK_2", "LINK_3", "LINK_4", "LINK_5", "LINK_6", "LINK_7",
+    "LINK_8", "LINK_9", "LINK_10", "LINK_11", "LINK_12", "LINK_13", "LINK_14",
+    "LONGLINK1", "LONGLINK2", "LONGLINK3", "LONGLINK4", "LONGLINK5", "LONGLINK6", "LONGLINK7",
+    "LONGLINK8", "LONGLINK9", "LONGLINK10", "LONGLINK11", "LONGLINK12", "LONGLINK13", "LONGLINK14",
+    "BR_LINK1", "BR_LINK2", "BR_LINK3", "BR_LINK4", "BR_LINK5", "BR_LINK6", "BR_LINK7",
+    "BR_LINK8", "BR_LINK9", "BR_LINK10", "BR_LINK11", "BR_LINK12", "BR_LINK13", "BR_LINK14"
+};
+
+static const char* nextFieldNames[] = { "NEXT_LR", "LONGNEXTLR", "BR_NEXTLR" };
+
+/*
+* Decode sink of the link and next fields of a chain record, see FieldDecodeTable::decodeFieldList().
+* a blank field clears its link.
+*/
+class ChainRecordSink
+{
+public:
+    ChainRecordSink(const std::vector<rfa::common::Int16> &linkFields, std::vector<std::string> &links,
+                    const std::vector<rfa::common::Int16> &nextFields, std::vector<std::string> &nexts) :
+     _linkFields(linkFields), _links(links), _nextFields(nextFields), _nexts(nexts), _value(0) {}
+
+    bool    accepts(rfa::common::Int16 fieldId) {
+        _value = find(_linkFields, _links, fieldId);
+        if(!_value)
+            _value = find(_nextFields, _nexts, fieldId);
+        return _value != 0;
+    }
+    bool    typedDateTime() const { return false; }
+
+    void    blank(rfa::common::Int16, const FieldDecodeTable::Entry*) { _value->clear(); }
+    void    string(rfa::common::Int16, const FieldDecodeTable::Entry*, const std::string &value) { *_value = value; }
+    void    number(rfa::common::Int16, const FieldDecodeTable::Entry*, double) {}
+    void    integer(rfa::common::Int16, const FieldDecodeTable::Entry*, rfa::common::Int64, FieldValue::ValueType) {}
+    void    real(rfa::common::Int16, const FieldDecodeTable::Entry*, const RealValue&) {}
+    void    dateTime(rfa::common::Int16, const FieldDecodeTable::Entry*, FieldValue::ValueType, rfa::common::Int64) {}
+
+private:
+    static std::string* find(const std::vector<rfa::common::Int16> &fields, std::vector<std::string> &values, rfa::common::Int16 fieldId) {
+        for(size_t i = 0; i < fields.size(); i++) {
+            if(fields[i] == fieldId)
+                return &values[i];
+        }
+        return 0;
+    }
+
+    const std::vector<rfa::common::Int16>   &_linkFields;
+    std::vector<std::string>                &_links;
+    const std::vector<rfa::common::Int16>   &_nextFields;
+    std::vector<std::string>                &_nexts;
+    std::string                             *_value;
+};
+
+/*
+* The record likely ahead of recordName, "3#.FTSE" for "0#.FTSE" 3 records ahead.
+* Empty if the name is not numbered.
+*/
+static std::string recordAhead(const std::string &recordName, int ahead) {
+    const size_t hash = recordName.find('#');
+    if(hash == 0 || hash == std::string::npos || recordName.find_first_not_of("0123456789") != hash)
+        return "";
+    try {
+        return boost::lexical_cast<std::string>(boost::lexical_cast<int>(recordName.substr(0, hash)) + ahead) + recordName.substr(hash);
+    } catch(boost::bad_lexical_cast &) {
+        return "";
+    }
+}
+
+ChainHandler::ChainHandler(rfa::sessionLayer::OMMConsumer* pOMMConsumer,
+                           rfa::common::EventQueue& eventQueue,
+                           rfa::common::Client& client,
+                           const std::string& serviceName,
+                           const RDMFieldDict* dict,
+                           const FieldDecodeTable* decodeTable,
+                           rfa::logger::ComponentLogger& componentLogger):
+_pOMMConsumer(pOMMConsumer),
+_componentLogger(componentLogger),
+_eventQueue(eventQueue),
+_client(client),
+_serviceName(serviceName),
+_pDict(dict),
+_pDecodeTable(decodeTable),
+_debug(false),
+_pCompletions(0),
+_log("")
+{
+    // the link and next fields the dictionary has
+    for(size_t i = 0; _pDict && i < sizeof(linkFieldNames) / sizeof(linkFieldNames[0]); i++) {
+        const RDMFieldDef* fieldDef = _pDict->getFieldDef(linkFieldNames[i]);
+        if(fieldDef)
+            _linkFields.push_back((rfa::common::Int16)fieldDef->getFieldId());
+    }
+    for(size_t i = 0; _pDict && i < sizeof(nextFieldNames) / sizeof(nextFieldNames[0]); i++) {
+        const RDMFieldDef* fieldDef = _pDict->getFieldDef(nextFieldNames[i]);
+        if(fieldDef)
+            _nextFields.push_back((rfa::common::Int16)fieldDef->getFieldId());
+    }
+}
+
+
+ChainHandler::~ChainHandler(void){}
+
+
+/*
+* Resolve a chain. With track the chain records stay open and changes of the
+* constituents are delivered as they happen, with subscribe the constituents
+* are subscribed and unsubscribed with them. A resolved snapshot chain is
+* resolved again, the constituents it keeps subscribed change with it.
+*/
+void ChainHandler::sendRequest(const std::string &chainName, bool subscribe, bool track){
+    ChainIndex::iterator it = _chains.find(chainName);
+    if(it != _chains.end() && (it->second.track || !it->second.resolved)) {
+        if(_debug) {
+            _log = "[ChainHandler::sendRequest] Chain is already requested: ";
+            _log.append(chainName.c_str());
+            _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+        }
+        return;
+    }
+
+    Chain &chain = _chains[chainName];
+    if(chain.resolved) {
+        // the constituents are kept to subscribe and unsubscribe only the changes
+        if(chain.subscribe && !subscribe) {
+            const boost::unordered_set<std::string> constituents(chain.constituents.begin(), chain.constituents.end());
+            _removed.insert(_removed.end(), constituents.begin(), constituents.end());
+        }
+        if(chain.subscribe != subscribe)
+            chain.constituents.clear();
+        chain.resolved = false;
+    }
+    chain.serviceName = _serviceName;
+    chain.subscribe = subscribe;
+    chain.track = track;
+    std::vector<std::string> constituents;
+    resolve(chainName, chain, constituents);
+    if(_debug) {
+        _log = "[ChainHandler::sendRequest] Resolve chain: ";
+        _log.append((chainName+"."+_serviceName).c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+}
+
+void ChainHandler::requestRecord(const std::string &chainName, Chain &chain, const std::string &recordName){
+    rfa::message::ReqMsg reqMsg;
+    rfa::message::AttribInfo attribInfo(true);
+
+    attribInfo.setName(recordName.c_str());
+    attribInfo.setNameType(rfa::rdm::INSTRUMENT_NAME_RIC);
+    attribInfo.setServiceName(chain.serviceName.c_str());
+    reqMsg.setAttribInfo(attribInfo);
+
+    reqMsg.setMsgModelType(rfa::rdm::MMT_MARKET_PRICE);
+    if(chain.track)
+        reqMsg.setInteractionType(rfa::message::ReqMsg::InitialImageFlag | rfa::message::ReqMsg::InterestAfterRefreshFlag);
+    else
+        reqMsg.setInteractionType(rfa::message::ReqMsg::InitialImageFlag);
+
+    rfa::sessionLayer::OMMItemIntSpec intSpec;
+    intSpec.setMsg(&reqMsg);
+
+    Record &record = chain.records[recordName];
+    record.requested = true;
+    record.links.assign(_linkFields.size(), "");
+    record.nexts.assign(_nextFields.size(), "");
+    CMutex::CGuard guard(_handleMutex);
+    record.handle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
+    _handles[record.handle] = RecordKey(chainName, recordName);
+}
+
+void ChainHandler::closeRecord(Record &record){
+    if(!record.handle)
+        return;
+    _pOMMConsumer->unregisterClient(record.handle);
+    forgetHandle(record.handle);
+    record.handle = 0;
+}
+
+void ChainHandler::forgetHandle(rfa::common::Handle* handle){
+    CMutex::CGuard guard(_handleMutex);
+    _handles.erase(handle);
+}
+
+bool ChainHandler::isChainRecord(rfa::common::Handle* handle){
+    CMutex::CGuard guard(_handleMutex);
+    return _handles.find(handle) != _handles.end();
+}
+
+void ChainHandler::closeRequest(const std::string &chainName){
+    ChainIndex::iterator it = _chains.find(chainName);
+    if(it == _chains.end())
+        return;
+
+    Chain &chain = it->second;
+    for(boost::unordered_map<std::string, Record>::iterator record = chain.records.begin(); record != chain.records.end(); ++record)
+        closeRecord(record->second);
+    if(chain.subscribe) {
+        const boost::unordered_set<std::string> constituents(chain.constituents.begin(), chain.constituents.end());
+        _removed.insert(_removed.end(), constituents.begin(), constituents.end());
+    }
+    _chains.erase(it);
+    // nobody gets the resolution of a closed chain
+    if(_pCompletions)
+        _pCompletions->complete(CompletionRegistry::Chain, chainName, false);
+    if(_debug) {
+        _log = "[ChainHandler::closeRequest] Close chain: ";
+        _log.append(chainName.c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+}
+
+void ChainHandler::closeAllRequest(){
+    while(!_chains.empty())
+        closeRequest(_chains.begin()->first);
+}
+
+void ChainHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out){
+    RecordKey key;
+    {
+        CMutex::CGuard guard(_handleMutex);
+        boost::unordered_map<rfa::common::Handle*, RecordKey>::const_iterator it = _handles.find(handle);
+        if(it == _handles.end())
+            return;
+        key = it->second;
+    }
+    ChainIndex::iterator chainIt = _chains.find(key.first);
+    if(chainIt == _chains.end())
+        return;
+    Chain &chain = chainIt->second;
+    boost::unordered_map<std::string, Record>::iterator recordIt = chain.records.find(key.second);
+    if(recordIt == chain.records.end())
+        return;
+    Record &record = recordIt->second;
+
+    if(_debug)
+        cout << "[ChainHandler::processResponse] Chain record: " << key.second << " of " << key.first << endl;
+
+    switch (respMsg.getRespType()){
+        case rfa::message::RespMsg::RefreshEnum:
+            if(respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)
+                decodeRecord(respMsg.getPayload(), record);
+            if(respMsg.getIndicationMask() & rfa::message::RespMsg::RefreshCompleteFlag) {
+                record.received = true;
+                // snapshot streams close with their refresh
+                if(!chain.track) {
+                    forgetHandle(handle);
+                    record.handle = 0;
+                }
+            }
+            break;
+
+        case rfa::message::RespMsg::UpdateEnum:
+            if(respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)
+                decodeRecord(respMsg.getPayload(), record);
+            break;
+
+        default:
+            break;
+    }
+
+    // the stream of the record is over in any state but open, a snapshot refresh aside
+    if(respMsg.getHintMask() & rfa::message::RespMsg::RespStatusFlag) {
+        const rfa::common::RespStatus& status = respMsg.getRespStatus();
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum &&
+                !(respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && status.getStreamState() == rfa::common::RespStatus::NonStreamingEnum)) {
+            record.closed = true;
+            record.statusText = status.getStatusText().c_str();
+            record.dataState = RDMUtils::dataStateToString(status.getDataState()).c_str();
+            record.streamState = RDMUtils::streamStateToString(status.getStreamState()).c_str();
+            record.statusCode = RDMUtils::statusCodeToString(status.getStatusCode()).c_str();
+            forgetHandle(handle);
+            record.handle = 0;
+            if(_debug) {
+                _log = "[ChainHandler::processResponse] Chain record closed: " + status.getStatusText();
+                _componentLogger.log(LM_GENERIC_ONE,rfa::common::Warning,_log.c_str());
+            }
+        }
+    }
+
+    publish(key.first, chain, out);
+    if(!chain.failedRecord.empty())
+        fail(key.first, chain, out);
+}
+
+void ChainHandler::decodeRecord(const rfa::common::Data& data, Record &record){
+    if(data.getDataType() != rfa::data::FieldListEnum)
+        return;
+    ChainRecordSink sink(_linkFields, record.links, _nextFields, record.nexts);
+    _pDecodeTable->decodeFieldList(static_cast<const rfa::data::FieldList&>(data), sink);
+}
+
+bool ChainHandler::resolve(const std::string &chainName, Chain &chain, std::vector<std::string> &constituents){
+    constituents.clear();
+    boost::unordered_set<std::string> visited;
+    std::string recordName = chainName;
+    // a next link back into the chain ends it too
+    while(visited.insert(recordName).second) {
+        Record &record = chain.records[recordName];
+        if(!record.requested)
+            requestRecord(chainName, chain, recordName);
+        // a closed record breaks the chain, records requested ahead and closed do not matter
+        if(record.closed) {
+            chain.failedRecord = recordName;
+            return false;
+        }
+        if(!record.received) {
+            for(int i = 1; i <= prefetchRecords; i++) {
+                const std::string ahead = recordAhead(recordName, i);
+                if(ahead.empty())
+                    break;
+                if(!chain.records[ahead].requested)
+                    requestRecord(chainName, chain, ahead);
+            }
+            return false;
+        }
+
+        for(size_t i = 0; i < record.links.size(); i++) {
+            if(!record.links[i].empty())
+                constituents.push_back(record.links[i]);
+        }
+        recordName.clear();
+        for(size_t i = 0; i < record.nexts.size() && recordName.empty(); i++)
+            recordName = record.nexts[i];
+        if(recordName.empty())
+            break;
+    }
+
+    // records requested ahead past the end of the chain
+    for(boost::unordered_map<std::string, Record>::iterator it = chain.records.begin(); it != chain.records.end(); ) {
+        if(visited.find(it->first) == visited.end()) {
+            closeRecord(it->second);
+            it = chain.records.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+/*
+* Deliver a CHAIN record with the constituents added and removed, once the chain
+* is resolved and then whenever its constituents change.
+*/
+void ChainHandler::publish(const std::string &chainName, Chain &chain, boost::python::list& out){
+    std::vector<std::string> constituents;
+    if(!resolve(chainName, chain, constituents))
+        return;
+
+    const boost::unordered_set<std::string> before(chain.constituents.begin(), chain.constituents.end());
+    const boost::unordered_set<std::string> after(constituents.begin(), constituents.end());
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    for(size_t i = 0; i < constituents.size(); i++) {
+        if(before.find(constituents[i]) == before.end())
+            added.push_back(constituents[i]);
+    }
+    for(size_t i = 0; i < chain.constituents.size(); i++) {
+        if(after.find(chain.constituents[i]) == after.end())
+            removed.push_back(chain.constituents[i]);
+    }
+    // the first CHAIN record of a resolution has all the constituents
+    const bool first = !chain.resolved;
+    if(!first && added.empty() && removed.empty())
+        return;
+    chain.constituents.swap(constituents);
+    chain.resolved = true;
+    if(first) {
+        added = chain.constituents;
+        removed.clear();
+    }
+
+    // a snapshot chain is done with its records
+    if(!chain.track) {
+        for(boost::unordered_map<std::string, Record>::iterator it = chain.records.begin(); it != chain.records.end(); ++it)
+            closeRecord(it->second);
+        chain.records.clear();
+    }
+    if(chain.subscribe) {
+        // the chain owns a constituent once, however often it is linked
+        for(boost::unordered_set<std::string>::const_iterator it = after.begin(); it != after.end(); ++it) {
+            if(before.find(*it) == before.end())
+                _added.push_back(*it);
+        }
+        for(boost::unordered_set<std::string>::const_iterator it = before.begin(); it != before.end(); ++it) {
+            if(after.find(*it) == after.end())
+                _removed.push_back(*it);
+        }
+    }
+
+    boost::python::list addedList;
+    for(size_t i = 0; i < added.size(); i++)
+        addedList.append(added[i]);
+    boost::python::list removedList;
+    for(size_t i = 0; i < removed.size(); i++)
+        removedList.append(removed[i]);
+    dict d;
+    d["RIC"] = chainName;
+    d["SERVICE"] = chain.serviceName;
+    d["MTYPE"] = "CHAIN";
+    d["ADD"] = tuple(addedList);
+    d["DELETE"] = tuple(removedList);
+    out.append(d);
+    if(_debug) {
+        _log = "[ChainHandler::publish] Chain ";
+        _log.append(chainName.c_str());
+        _log += " has ";
+        _log.append((int)chain.constituents.size());
+        _log += " constituents";
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+    if(first && _pCompletions)
+        _pCompletions->complete(CompletionRegistry::Chain, chainName, true);
+}
+
+/*
+* Deliver a STATUS record for a chain whose record is closed and close the chain,
+* its records and the constituents subscribed to with it.
+*/
+void ChainHandler::fail(const std::string &chainName, Chain &chain, boost::python::list& out){
+    const Record &record = chain.records[chain.failedRecord];
+    dict d;
+    d["RIC"] = chainName;
+    d["SERVICE"] = chain.serviceName;
+    d["MTYPE"] = "STATUS";
+    d["TEXT"] = chain.failedRecord + ": " + record.statusText;
+    d["DATA_STATE"] = record.dataState;
+    d["STREAM_STATE"] = record.streamState;
+    d["STATUS_CODE"] = record.statusCode;
+    out.append(d);
+    if(_debug) {
+        _log = "[ChainHandler::fail] Chain ";
+        _log.append(chainName.c_str());
+        _log += " failed at record ";
+        _log.append(chain.failedRecord.c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Warning,_log.c_str());
+    }
+    const std::string name = chainName;
+    closeRequest(name);
+}
+
+const std::vector<std::string>* ChainHandler::getConstituents(const std::string &chainName) const{
+    ChainIndex::const_iterator it = _chains.find(chainName);
+    if(it == _chains.end() || !it->second.resolved)
+        return 0;
+    return &it->second.constituents;
+}
+
+void ChainHandler::takeSubscriptions(std::vector<std::string> &added, std::vector<std::string> &removed){
+    added.swap(_added);
+    removed.swap(_removed);
+    _added.clear();
+    _removed.clear();
+}
+
+void ChainHandler::setCompletions(CompletionRegistry *completions){
+    _pCompletions = completions;
+}
+
+void ChainHandler::setDebugMode(const bool &debug){
+    _debug = debug;
+}
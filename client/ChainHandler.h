@@ -0,0 +1,113 @@
+#ifndef CHAINHANDLER_H
+#define CHAINHANDLER_H
+
+#include "StdAfx.h"
+#include "common/Completion.h"
+#include "common/FieldDecodeTable.h"
+#include "common/Mutex.h"
+#include <boost/python.hpp>
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+class RDMFieldDict;
+
+using namespace boost::python;
+
+/*
+* Expands legacy chains natively. The chain records are market price items whose
+* LINK_n, LONGLINKn or BR_LINKn fields hold the constituents and whose NEXT_LR,
+* LONGNEXTLR or BR_NEXTLR field names the next record. The records following the
+* one waited for are requested ahead by name ("1#.FTSE" after "0#.FTSE"), so several
+* requests are in flight instead of one round trip per record.
+*/
+class ChainHandler
+{
+public:
+    ChainHandler(rfa::sessionLayer::OMMConsumer* pOMMConsumer,
+                    rfa::common::EventQueue& eventQueue,
+                    rfa::common::Client& client,
+                    const std::string& serviceName,
+                    const RDMFieldDict* dict,
+                    const FieldDecodeTable* decodeTable,
+                    rfa::logger::ComponentLogger& componentLogger);
+    ~ChainHandler(void);
+    void                                        sendRequest(const std::string &chainName, bool subscribe, bool track);
+    void                                        closeRequest(const std::string &chainName);
+    void                                        closeAllRequest();
+    // safe without the GIL
+    bool                                        isChainRecord(rfa::common::Handle* handle);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out);
+    // 0 until the chain is resolved
+    const std::vector<std::string>*             getConstituents(const std::string &chainName) const;
+    // constituents of the auto-subscribed chains added and removed since the last call
+    void                                        takeSubscriptions(std::vector<std::string> &added, std::vector<std::string> &removed);
+    // the completions waiting for chains of this handler to resolve
+    void                                        setCompletions(CompletionRegistry *completions);
+    void                                        setDebugMode(const bool &debugLevel);
+
+private:
+    struct Record
+    {
+        Record() : requested(false), received(false), closed(false), handle(0) {}
+
+        bool                                    requested;
+        bool                                    received;
+        // the stream ended in a state other than open, with its status
+        bool                                    closed;
+        std::string                             statusText;
+        std::string                             dataState;
+        std::string                             streamState;
+        std::string                             statusCode;
+        rfa::common::Handle                     *handle;
+        std::vector<std::string>                links;      // by position of the link FIDs
+        std::vector<std::string>                nexts;      // by position of the next FIDs
+    };
+
+    struct Chain
+    {
+        Chain() : subscribe(false), track(false), resolved(false) {}
+
+        std::string                             serviceName;
+        bool                                    subscribe;
+        bool                                    track;
+        bool                                    resolved;
+        boost::unordered_map<std::string, Record> records;
+        std::vector<std::string>                constituents;
+        // the closed record the chain cannot be resolved past
+        std::string                             failedRecord;
+    };
+
+    typedef boost::unordered_map<std::string, Chain>    ChainIndex;
+    // chain and record of a stream
+    typedef std::pair<std::string, std::string>         RecordKey;
+
+    void                                        requestRecord(const std::string &chainName, Chain &chain, const std::string &recordName);
+    void                                        closeRecord(Record &record);
+    void                                        forgetHandle(rfa::common::Handle* handle);
+    void                                        decodeRecord(const rfa::common::Data& data, Record &record);
+    // false while a record of the chain is still missing or closed
+    bool                                        resolve(const std::string &chainName, Chain &chain, std::vector<std::string> &constituents);
+    void                                        publish(const std::string &chainName, Chain &chain, boost::python::list& out);
+    void                                        fail(const std::string &chainName, Chain &chain, boost::python::list& out);
+    rfa::sessionLayer::OMMConsumer              *_pOMMConsumer;
+    rfa::logger::ComponentLogger                &_componentLogger;
+    rfa::common::EventQueue                     &_eventQueue;
+    rfa::common::Client                         &_client;
+    const std::string                           &_serviceName;
+    const RDMFieldDict*                         _pDict;
+    const FieldDecodeTable*                     _pDecodeTable;
+    bool                                        _debug;
+    CompletionRegistry                          *_pCompletions;
+    std::vector<rfa::common::Int16>             _linkFields;
+    std::vector<rfa::common::Int16>             _nextFields;
+    ChainIndex                                  _chains;
+    // the dispatch thread asks for chain records without the GIL
+    boost::unordered_map<rfa::common::Handle*, RecordKey> _handles;
+    CMutex                                      _handleMutex;
+    std::vector<std::string>                    _added;
+    std::vector<std::string>                    _removed;
+    rfa::common::RFA_String                     _log;
+};
+#endif
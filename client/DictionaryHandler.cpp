@@ -4,6 +4,7 @@
 #include "common/RDMDictionaryDecoder.h"
 #include "DictionaryHandler.h"
 #include "common/RDMUtils.h"
+#include "common/PyGIL.h"
 
 DictionaryHandler::DictionaryHandler(rfa::sessionLayer::OMMConsumer* pOMMConsumer, 
                                      rfa::common::EventQueue* eventQueue,
@@ -11,6 +12,9 @@ DictionaryHandler::DictionaryHandler(rfa::sessionLayer::OMMConsumer* pOMMConsume
                                      std::string& serviceName,
                                      rfa::common::UInt32 dictTraceLevel,
                                      rfa::logger::ComponentLogger& componentLogger):
+_pDict(new RDMFieldDict()),
+_pDecodeTable(new FieldDecodeTable()),
+_pDecodeLock(0),
 _pOMMConsumer(pOMMConsumer),
 _pEventQueue(eventQueue),
 _pClient(client),
@@ -29,18 +33,21 @@ _componentLogger(componentLogger)
     //RDMDict::Trace = 0x10; // dump enumTypedef
 
      // prepare to download dictionaries from network
-    _pNetworkDictDecoder = new RDMNetworkDictionaryDecoder(_dict);
+    _pNetworkDictDecoder = new RDMNetworkDictionaryDecoder(*_pDict);
 }
 
 DictionaryHandler::DictionaryHandler(const std::string& fieldDictFile,
                                      const std::string& enumDictFile,
                                      rfa::logger::ComponentLogger& componentLogger):
+_pDict(new RDMFieldDict()),
+_pDecodeTable(new FieldDecodeTable()),
+_pDecodeLock(0),
 _debug(false),
 _log(""),
 _componentLogger(componentLogger)
 {
     // load dictionaries from disk
-    _pFileDictDecoder = new RDMFileDictionaryDecoder(_dict);
+    _pFileDictDecoder = new RDMFileDictionaryDecoder(*_pDict);
     _isAvailable = _pFileDictDecoder->load(fieldDictFile.c_str(), enumDictFile.c_str());
     if (!_isAvailable) {
         _log = "[DictionaryHandler::DictionaryHandler] Unable to load dictionaries from  ";
@@ -51,6 +58,7 @@ _componentLogger(componentLogger)
         if(_debug)
             cout << "[DictionaryHandler::DictionaryHandler] Unable to load dictionaries from  "<< fieldDictFile << ", " << enumDictFile << endl;
     } else {
+        _pDecodeTable->build(*_pDict);
         if(_debug)
             cout << "[DictionaryHandler::DictionaryHandler] Successfully load dictionaries from  "<< fieldDictFile << ", " << enumDictFile << endl;
     }
@@ -159,6 +167,19 @@ void DictionaryHandler::processRefreshMsg( const rfa::message::RespMsg& respMsg)
             const rfa::message::AttribInfo& attrib = respMsg.getAttribInfo();
             if (attrib.getName() == "RWFFld") {
                _pNetworkDictDecoder->loadAppendix_A(respMsg.getPayload(), moreFragments);
+                if (!moreFragments) {
+                    // the table is rebuilt off to the side, the dispatch thread may be decoding with it
+                    FieldDecodeTable next;
+                    next.build(*_pDict);
+                    if(_pDecodeLock) {
+                        CPyGILRelease noGIL;
+                        CMutex::CGuard guard(*_pDecodeLock);
+                        _pDecodeTable->swap(next);
+                    } else {
+                        _pDecodeTable->swap(next);
+                    }
+                    // the old entries go with next, the GIL held again
+                }
             } else if (attrib.getName()== "RWFEnum") {
                 _pNetworkDictDecoder->loadEnumTypeDef(respMsg.getPayload(), moreFragments);
                 if (!moreFragments) {
@@ -230,11 +251,39 @@ bool DictionaryHandler::isAvailable() const {
 
 const RDMFieldDict* DictionaryHandler::getDictionary() const {
     if (isAvailable()) 
-        return &_dict;
+        return _pDict.get();
     else
         return NULL;
 }
 
+// decode plan for the loaded field dictionary, empty until it has loaded
+const FieldDecodeTable* DictionaryHandler::getDecodeTable() const {
+    return _pDecodeTable.get();
+}
+
+boost::shared_ptr<const RDMFieldDict> DictionaryHandler::getSharedDictionary() const {
+    if (isAvailable()) 
+        return _pDict;
+    else
+        return boost::shared_ptr<const RDMFieldDict>();
+}
+
+boost::shared_ptr<const FieldDecodeTable> DictionaryHandler::getSharedDecodeTable() const {
+    return _pDecodeTable;
+}
+
+void DictionaryHandler::setDateTimeMode(FieldDecodeTable::DateTimeMode mode) {
+    _pDecodeTable->setDateTimeMode(mode);
+}
+
+void DictionaryHandler::setRealMode(FieldDecodeTable::RealMode mode) {
+    _pDecodeTable->setRealMode(mode);
+}
+
+void DictionaryHandler::setDecodeLock(CMutex *mutex) {
+    _pDecodeLock = mutex;
+}
+
 bool DictionaryHandler::isDictionaryRefreshComplete() const {
     return _isDictionaryRefreshComplete;
 }
@@ -3,6 +3,9 @@
 
 #include "../common/RDMDictDef.h"
 #include "../common/RDMDict.h"
+#include "../common/FieldDecodeTable.h"
+#include "../common/Mutex.h"
+#include <boost/shared_ptr.hpp>
 
 
 class RDMNetworkDictionaryDecoder;
@@ -31,6 +34,14 @@ public:
     bool isAvailable() const;
     bool isDictionaryRefreshComplete() const;
     const RDMFieldDict* getDictionary() const;
+    const FieldDecodeTable* getDecodeTable() const;
+    // shared with the objects that decode after the handler is gone, e.g. a LazyUpdate
+    boost::shared_ptr<const RDMFieldDict> getSharedDictionary() const;
+    boost::shared_ptr<const FieldDecodeTable> getSharedDecodeTable() const;
+    void setDateTimeMode(FieldDecodeTable::DateTimeMode mode);
+    void setRealMode(FieldDecodeTable::RealMode mode);
+    // the lock the dispatch thread decodes market prices under
+    void setDecodeLock(CMutex *mutex);
     void setDebugMode(const bool &debugLevel);
 
 private:
@@ -38,7 +49,9 @@ private:
     void processRefreshMsg( const rfa::message::RespMsg& respMsg);
     void processStatusMsg( const rfa::message::RespMsg& respMsg);
 
-    RDMFieldDict _dict;
+    boost::shared_ptr<RDMFieldDict> _pDict;
+    boost::shared_ptr<FieldDecodeTable> _pDecodeTable;
+    CMutex                          *_pDecodeLock;
     RDMNetworkDictionaryDecoder     *_pNetworkDictDecoder;
     RDMFileDictionaryDecoder        *_pFileDictDecoder;
     rfa::sessionLayer::OMMConsumer  *_pOMMConsumer;
@@ -41,7 +41,7 @@ void DirectoryHandler::sendRequest(){
     _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
 }
 
-void DirectoryHandler::processResponse(const rfa::message::RespMsg& respMsg, boost::python::tuple& out){
+void DirectoryHandler::processResponse(const rfa::message::RespMsg& respMsg, boost::python::list& out){
 
     switch (respMsg.getRespType())
     {
@@ -86,7 +86,7 @@ void DirectoryHandler::processResponse(const rfa::message::RespMsg& respMsg, boo
     }*/
 }
 
-void DirectoryHandler::decodeDirectory(const rfa::common::Data& directory, boost::python::tuple& out) {
+void DirectoryHandler::decodeDirectory(const rfa::common::Data& directory, boost::python::list& out) {
     const rfa::data::Map& map = static_cast<const rfa::data::Map&>(directory);
     rfa::data::MapReadIterator mri;
     for (mri.start(map); !mri.off(); mri.forth()) { 
@@ -105,7 +105,7 @@ void DirectoryHandler::decodeDirectory(const rfa::common::Data& directory, boost
         decodeFilterList(filterList, serviceName, d);
         d["MTYPE"] = "DIRECTORY";
         d["SERVICE"] = serviceName;
-        out += boost::python::make_tuple(d);
+        out.append(d);
     }
 }
 
@@ -20,14 +20,14 @@ public:
     void sendRequest();
     void closeRequest();
 
-    void processResponse( const rfa::message::RespMsg& respMsg, boost::python::tuple& out);
+    void processResponse( const rfa::message::RespMsg& respMsg, boost::python::list& out);
 
     bool isServiceUp() const;
     void setDebugMode(const bool &debug);
 
 private:
 
-    void decodeDirectory( const rfa::common::Data& directory, boost::python::tuple& out);
+    void decodeDirectory( const rfa::common::Data& directory, boost::python::list& out);
     void decodeFilterList(const rfa::data::FilterList& filterList, const std::string& serviceName, dict &d);
     void decodeElementList(const rfa::data::ElementList& elementList, const std::string& serviceName, dict &d);
     rfa::common::RFA_String decodeArray(const rfa::data::Array& array);
@@ -1,6 +1,7 @@
 #include "StdAfx.h"
 #include "common/RDMUtils.h"
 #include "common/RDMDict.h"
+#include "common/FieldDecodeTable.h"
 #include "HistoryHandler.h"
 #include <boost/algorithm/string.hpp>
 
@@ -9,6 +10,7 @@ HistoryHandler::HistoryHandler(rfa::sessionLayer::OMMConsumer* pOMMConsumer,
                                      rfa::common::Client& client,
                                      const std::string& serviceName,
                                      const RDMFieldDict* dict,
+                                     const FieldDecodeTable* decodeTable,
                                      rfa::logger::ComponentLogger& componentLogger):
 _pOMMConsumer(pOMMConsumer),
 _eventQueue(eventQueue),
@@ -16,9 +18,11 @@ _client(client),
 _pHandle(0),
 _serviceName(serviceName),
 _pDict(dict),
+_pDecodeTable(decodeTable),
 _isHistoryRefreshComplete(true),
 _history(0),
 _debug(false),
+_pCompletions(0),
 _maxRecords(0),
 _log(""),
 _componentLogger(componentLogger),
@@ -46,16 +50,14 @@ void HistoryHandler::sendRequest(const std::string &itemName, const rfa::common:
     rfa::sessionLayer::OMMItemIntSpec intSpec;
     intSpec.setMsg( &reqMsg );
 
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    std::pair<map<rfa::common::Handle*,std::string>::iterator,bool> ret;
-
-    it = _watchList.find(getHandle(itemName));
+    // release the names of removed items
+    _watchList.collect();
+    rfa::common::Handle* handle = getHandle(itemName);
 
     // If item already exists, re-issue the request
-    if(it == _watchList.end()) {
+    if(!handle) {
         _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
-        ret = _watchList.insert(  pair<rfa::common::Handle*,std::string>(_pHandle,itemName+"."+_serviceName) );
-        if(ret.second) {
+        if(_watchList.add(_pHandle, itemName, _serviceName)) {
             if(_debug) {
                 _log = "[HistoryHandler::sendRequest] Add item subscription for: ";
                 _log.append((itemName+"."+_serviceName).c_str());
@@ -78,42 +80,123 @@ void HistoryHandler::sendRequest(const std::string &itemName, const rfa::common:
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
-        _pOMMConsumer->reissueClient(it->first, &intSpec);
+        _pOMMConsumer->reissueClient(handle, &intSpec);
     }
     _isHistoryRefreshComplete = false;
     // cache is clear when request is resent
     _history.clear();
 }
 
+/*
+* Request many items in one batch request message.
+* Items already in the watchlist are re-issued one by one, the rest are listed in :ItemList.
+*/
+void HistoryHandler::sendBatchRequest(const std::vector<std::string> &itemNames, const rfa::common::UInt8 &interactionType){
+    std::vector<std::string> batchItems;
+    for(size_t i = 0; i < itemNames.size(); i++) {
+        if(getHandle(itemNames[i]))
+            sendRequest(itemNames[i], interactionType);
+        else if(!_watchList.isPending(itemNames[i], _serviceName))
+            batchItems.push_back(itemNames[i]);
+    }
+    if(batchItems.empty())
+        return;
+
+    rfa::message::ReqMsg reqMsg;
+    rfa::message::AttribInfo attribInfo(true) ;
+
+    attribInfo.setNameType(rfa::rdm::INSTRUMENT_NAME_RIC);
+    attribInfo.setServiceName(_serviceName.c_str());
+    reqMsg.setAttribInfo(attribInfo);
+
+    reqMsg.setMsgModelType(rfa::rdm::MMT_HISTORY);
+    reqMsg.setInteractionType(interactionType);
+
+    rfa::data::ElementList elementList;
+    rfa::data::ElementListWriteIterator elwiter;
+    elwiter.start(elementList);
+    RDMUtils::encodeBatchItemList(batchItems, elwiter);
+    elwiter.complete();
+    reqMsg.setPayload(elementList);
+
+    rfa::sessionLayer::OMMItemIntSpec intSpec;
+    intSpec.setMsg( &reqMsg );
+
+    _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
+    _watchList.addBatch(_pHandle);
+    for(size_t i = 0; i < batchItems.size(); i++)
+        _watchList.addPending(batchItems[i], _serviceName);
+    if(_debug) {
+        _log = "[HistoryHandler::sendBatchRequest] Batch request for ";
+        _log.append((int)batchItems.size());
+        _log += " items from ";
+        _log.append(_serviceName.c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+}
+
+/*
+* Register a batch requested item under the handle of its first response.
+* Return true if the response is to be dropped: it belongs to the batch request itself
+* or to an item closed while it was pending.
+*/
+bool HistoryHandler::adoptItem(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle){
+    if(_watchList.isBatch(handle)) {
+        if((respMsg.getHintMask() & rfa::message::RespMsg::RespStatusFlag) &&
+                respMsg.getRespStatus().getStreamState() == rfa::common::RespStatus::ClosedEnum)
+            _watchList.removeBatch(handle);
+        if(_debug) {
+            _log = "[HistoryHandler::processResponse] Batch request status: " + respMsg.getRespStatus().getStatusText();
+            _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+        }
+        return true;
+    }
+    bool cancelled = false;
+    if(!_watchList.find(handle) && (respMsg.getHintMask() & rfa::message::RespMsg::AttribInfoFlag))
+        _watchList.adopt(handle, respMsg.getAttribInfo().getName().c_str(), _serviceName, cancelled);
+    if(cancelled)
+        _pOMMConsumer->unregisterClient(handle);
+    return cancelled;
+}
+
 void HistoryHandler::closeRequest(const std::string &itemName){
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(getHandle(itemName));
-    if(it != _watchList.end()) {
+    // a batch requested item still waiting for its handle is closed with its first response
+    _watchList.cancelPending(itemName, _serviceName);
+    rfa::common::Handle* handle = getHandle(itemName);
+    if(handle) {
         if(_debug) {
             _log = "[HistoryHandler::closeRequest] Close history subscription for: ";
-            _log.append(it->second.c_str());
+            _log.append(_watchList.find(handle)->watchName.c_str());
         }
-        _pOMMConsumer->unregisterClient(it->first);
-        _watchList.erase(it);
+        _pOMMConsumer->unregisterClient(handle);
+        _watchList.remove(handle);
         if(_debug) {
             _log += ". Watchlist size: ";
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
     }
+    // nobody gets the refresh of a closed item
+    if(_pCompletions)
+        _pCompletions->complete(CompletionRegistry::History, itemName, false);
     _isHistoryRefreshComplete = true;
 }
 
 void HistoryHandler::closeAllRequest(){
     _pOMMConsumer->unregisterClient();
     _watchList.clear();
+    if(_pCompletions)
+        _pCompletions->failAll(CompletionRegistry::History);
     if(_debug) {
         _log = "[HistoryHandler::closeAllRequest] Close all history subscription.";
         _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
     }
 }
 
-void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out){
+void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out){
+    if(adoptItem(respMsg, handle))
+        return;
+
     std::string itemName = "";
     std::string itemServiceName = "";
     itemName = getItemName(handle);
@@ -136,11 +219,11 @@ void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::
                 preempt["RIC"] = itemName;
                 preempt["SERVICE"] = itemServiceName;
                 preempt["MTYPE"] = "REFRESH";
-                out += boost::python::make_tuple(preempt);
+                out.append(preempt);
             }
 
             if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeHistory(respMsg.getPayload(), out, itemName, itemServiceName, "IMAGE");
+                decodeHistory(respMsg.getPayload(), out, itemName, itemServiceName, FieldDecodeTable::ImageValue);
             } else {
                 cout << "[HistoryHandler::processResponse] Empty Refresh." << endl;
             }
@@ -156,6 +239,8 @@ void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::
                 }
                 _refreshCount = 0;
                 _isHistoryRefreshComplete = true;
+                if(_pCompletions)
+                    _pCompletions->complete(CompletionRegistry::History, itemName, true);
             } else {
                 _refreshCount++;
             }
@@ -166,7 +251,7 @@ void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::
                 cout << "[HistoryHandler::processResponse] History Update: " << itemName << "." << itemServiceName << endl;
 
             if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeHistory(respMsg.getPayload(), out, itemName, itemServiceName, "UPDATE");
+                decodeHistory(respMsg.getPayload(), out, itemName, itemServiceName, FieldDecodeTable::UpdateValue);
             } else {
                 cout << "[HistoryHandler::processResponse] Empty Update." << endl;
             }
@@ -180,7 +265,7 @@ void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::
             d["DATA_STATE"] = RDMUtils::dataStateToString(respMsg.getRespStatus().getDataState()).c_str();
             d["STREAM_STATE"] = RDMUtils::streamStateToString(respMsg.getRespStatus().getStreamState()).c_str();
             d["STATUS_CODE"] = RDMUtils::statusCodeToString(respMsg.getRespStatus().getStatusCode()).c_str();
-            out += boost::python::make_tuple(d);
+            out.append(d);
             cout << "[HistoryHandler::processResponse] History Status: "<< respMsg.getRespStatus().getStatusText().c_str() << endl;
             _log = "[HistoryHandler::processResponse] History Status: " + respMsg.getRespStatus().getStatusText();
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Warning,_log.c_str());
@@ -210,6 +295,13 @@ void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::
             closeRequest(itemName);
         }
 
+        // the refresh is not coming in any other stream state, a snapshot refresh aside
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum &&
+                !(respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && status.getStreamState() == rfa::common::RespStatus::NonStreamingEnum)) {
+            if(_pCompletions)
+                _pCompletions->complete(CompletionRegistry::History, itemName, false);
+        }
+
         // Unspecified dataState
         if(status.getDataState() == rfa::common::RespStatus::UnspecifiedEnum) {
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
@@ -217,19 +309,19 @@ void HistoryHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::
     }
 
     // "out" is contructed to be Tcl dict
-    if(_debug && (out != boost::python::tuple()))
+    if(_debug && (len(out) > 0))
         prettyPrint(out);
 }
 
-void HistoryHandler::prettyPrint(boost::python::tuple& inputTuple) {
+void HistoryHandler::prettyPrint(boost::python::list& inputList) {
     string out = "";
     out.append("(");
-    for ( int i = 0 ; i < len(inputTuple) ; i++ ) {
-        extract<dict>dictElement(inputTuple[i]);
+    for ( int i = 0 ; i < len(inputList) ; i++ ) {
+        extract<dict>dictElement(inputList[i]);
         //check whether the converted data is python dictionary
         if (dictElement.check()) {
             out.append("{");
-            dict dictElement = extract<dict>(inputTuple[i]);
+            dict dictElement = extract<dict>(inputList[i]);
             boost::python::list keys = (boost::python::list)dictElement.keys();
 
             for (int j = 0; j < len(keys); j++) {
@@ -266,7 +358,7 @@ void HistoryHandler::prettyPrint(boost::python::tuple& inputTuple) {
                 }
             }
             out.append("}");
-            if (i != len(inputTuple) - 1) {
+            if (i != len(inputList) - 1) {
                 out.append(",");
             }
         }
@@ -275,7 +367,9 @@ void HistoryHandler::prettyPrint(boost::python::tuple& inputTuple) {
     cout << out << endl;
 }
 
-void HistoryHandler::decodeHistory(const rfa::common::Data& data, boost::python::tuple &out, const std::string &itemName, const std::string &serviceName, const std::string &mtype){
+void HistoryHandler::decodeHistory(const rfa::common::Data& data, boost::python::list& out, const std::string &itemName, const std::string &serviceName, FieldDecodeTable::FixedKey mtype){
+    object ric(itemName);
+    object service(serviceName);
     const rfa::data::Series& seriesData = static_cast<const rfa::data::Series&>(data);
     // data is RFA update message
     if(seriesData.getIndicationMask() & rfa::data::Series::EntriesFlag) {
@@ -285,86 +379,20 @@ void HistoryHandler::decodeHistory(const rfa::common::Data& data, boost::python:
         const rfa::common::Data & valueDataInit = entryInit.getData();
         const rfa::data::FieldList & EntryFieldList = static_cast<const rfa::data::FieldList &>(valueDataInit);
         for(sri.start(seriesData); !sri.off(); sri.forth()) {
-            dict d;
-            d["SERVICE"] = serviceName.c_str();
-            d["RIC"] = itemName.c_str();
-            d["MTYPE"]= mtype.c_str();
+            dict d = FieldDecodeTable::newDict(EntryFieldList, 3);
+            _pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, service);
+            _pDecodeTable->setItem(d, FieldDecodeTable::RicKey, ric);
+            _pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, mtype);
             const rfa::data::SeriesEntry & entry = sri.value();
             const rfa::common::Data & valueData = entry.getData();
             if (valueData.getDataType() != rfa::data::FieldListEnum) {
                 cout << "[HistoryHandler::decodeHistory] Expected data datatype of FieldList" << endl;
                 return;
             }
-            rfa::data::FieldListReadIterator flri;
-            for(flri.start(EntryFieldList); !flri.off(); flri.forth()) {
-                const rfa::data::FieldEntry& field = flri.value();
-                const rfa::common::Int16 fieldID = field.getFieldID();
-                const RDMFieldDef* fieldDef = _pDict->getFieldDef(fieldID);
-                rfa::common::RFA_String fieldValue;
-
-                // if field name does not exist, use the field ID instead
-                // if no field definition then no dict then no dataType
-                if(!fieldDef) {
-                    const rfa::common::UInt8 dataType = (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
-                    const rfa::common::Data& fieldData = field.getData(dataType);
-                    const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    d[fieldID] = fieldValue.trimWhitespace().c_str();
-                } else {
-                    // convert to DataBuffer
-                    const rfa::common::UInt8 dataType = fieldDef->getDataType();
-                    const rfa::common::Data& fieldData = field.getData(dataType);
-                    const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-                    const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
-                    const RDMEnumDef* enumDef = 0;
-
-                    //Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
-                    //check and decode according to data buffer type
-                    switch(dataBufferType) {
-                        case rfa::data::DataBuffer::EnumerationEnum:
-                            enumDef = fieldDef->getEnumDef();
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer,enumDef).c_str();
-                            d[fieldDef->getName().c_str()] = fieldValue.c_str();
-                            break;
-                        case rfa::data::DataBuffer::FloatEnum:
-                        case rfa::data::DataBuffer::DoubleEnum:
-                        case rfa::data::DataBuffer::Real32Enum:
-                        case rfa::data::DataBuffer::Real64Enum:
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                            if(fieldValue.empty()) {
-                                //d[fieldDef->getName().c_str()] = boost::python::object();
-                                d[fieldDef->getName().c_str()] = "";
-                            } else {
-                                d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToDouble(dataBuffer);
-                            }
-                            break;
-                        case rfa::data::DataBuffer::Int32Enum:
-                        case rfa::data::DataBuffer::UInt32Enum:
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                            if(fieldValue.empty()) {
-                                d[fieldDef->getName().c_str()] = "";
-                            } else {
-                                d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToInt(dataBuffer);
-                            }
-                            break;
-                        case rfa::data::DataBuffer::Int64Enum:
-                        case rfa::data::DataBuffer::UInt64Enum:
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                            if(fieldValue.empty()) {
-                                d[fieldDef->getName().c_str()] = "";
-                            } else {
-                                d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToLong(dataBuffer);
-                            }
-                            break;
-                        default:
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                            d[fieldDef->getName().c_str()] = fieldValue.trimWhitespace().c_str();
-                            break;
-                    }
-                }
-            }
+            FieldDecodeTable::DictSink sink(*_pDecodeTable, d);
+            _pDecodeTable->decodeFieldList(EntryFieldList, sink);
             // append a decoded dict entry to a tuple
-            out += boost::python::make_tuple(d);
+            out.append(d);
         }
     }
 }
@@ -377,6 +405,10 @@ void HistoryHandler::setDebugMode(const bool &debug) {
     _debug = debug;
 }
 
+void HistoryHandler::setCompletions(CompletionRegistry *completions) {
+    _pCompletions = completions;
+}
+
 void HistoryHandler::setMaxRecords(const rfa::common::UInt32 &maxRecords) {
     _maxRecords = maxRecords;
 }
@@ -390,49 +422,19 @@ const std::list<std::string>* HistoryHandler::getHistory() const {
 }
 
 std::string HistoryHandler::getItemName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        if (strs.size() > 2) {
-            std::vector<std::string>::iterator strsit = strs.begin();
-            itemName = *strsit;
-            strsit++;
-            for (std::vector<std::string>::size_type i=1; i < strs.size()-1; i++) {
-                itemName = itemName + "." + *strsit;
-                strsit++;
-            }
-        } else {
-            itemName = strs[0];
-        }
-    }
-    return itemName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->itemName : "";
 }
 
 std::string HistoryHandler::getItemServiceName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemServiceName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        itemServiceName = strs.back();
-    }
-    return itemServiceName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->serviceName : "";
 }
 
 rfa::common::Handle* HistoryHandler::getHandle(const std::string &itemName) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    for(it = _watchList.begin(); it != _watchList.end(); it++) {
-        if(it->second == itemName+"."+_serviceName) {
-            return it->first;
-        }
-    }
-    return NULL;
+    return _watchList.findHandle(itemName, _serviceName);
 }
 
-std::map<rfa::common::Handle*,std::string> &HistoryHandler::getWatchList() {
+ItemRegistry &HistoryHandler::getWatchList() {
     return _watchList;
 }
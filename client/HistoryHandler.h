@@ -2,6 +2,9 @@
 #define HISTORYHANDLER_H
 
 #include "StdAfx.h"
+#include "common/ItemRegistry.h"
+#include "common/Completion.h"
+#include "common/FieldDecodeTable.h"
 #include <boost/python.hpp>
 
 class RDMFieldDict;
@@ -16,38 +19,45 @@ public:
                     rfa::common::Client& client,
                     const std::string& serviceName, 
                     const RDMFieldDict* dict,
+                    const FieldDecodeTable* decodeTable,
                     rfa::logger::ComponentLogger& componentLogger);
     ~HistoryHandler(void);
     void                                        sendRequest(const std::string &itemName, const rfa::common::UInt8 &interactionType);
+    void                                        sendBatchRequest(const std::vector<std::string> &itemNames, const rfa::common::UInt8 &interactionType);
     void                                        closeRequest(const std::string &itemName);
     void                                        closeAllRequest();
-    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out);
     std::string                                 getItemName(rfa::common::Handle* handle);
     std::string                                 getItemServiceName(rfa::common::Handle* handle);
     bool                                        isHistoryRefreshComplete() const;
     rfa::common::Handle*                        getHandle(const std::string &itemName);
     void                                        setDebugMode(const bool &debugLevel);
+    // the completions waiting for refreshes of this handler
+    void                                        setCompletions(CompletionRegistry *completions);
     void                                        setMaxRecords(const rfa::common::UInt32 &maxRecords);
     const rfa::common::UInt32&                  getMaxRecords();
     const std::list<std::string>*               getHistory() const;
-    void                                        prettyPrint(boost::python::tuple& inputTuple);
-    std::map<rfa::common::Handle*,std::string>  &getWatchList();
+    void                                        prettyPrint(boost::python::list& inputList);
+    ItemRegistry                                &getWatchList();
 
 private:
-    void                                        decodeHistory(const rfa::common::Data& data, boost::python::tuple &out, const std::string &itemName, const std::string &serviceName, const std::string &mtype);
+    bool                                        adoptItem(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle);
+    void                                        decodeHistory(const rfa::common::Data& data, boost::python::list& out, const std::string &itemName, const std::string &serviceName, FieldDecodeTable::FixedKey mtype);
     rfa::sessionLayer::OMMConsumer              *_pOMMConsumer;
     rfa::common::EventQueue                     &_eventQueue;
     rfa::common::Client                         &_client;
     rfa::common::Handle                         *_pHandle;
     const std::string                           &_serviceName;
     const RDMFieldDict                          *_pDict;
+    const FieldDecodeTable                      *_pDecodeTable;
     bool                                        _isHistoryRefreshComplete;
     std::list<std::string>                      _history;
     bool                                        _debug;
+    CompletionRegistry                          *_pCompletions;
     rfa::common::UInt32                         _maxRecords;
     rfa::common::RFA_String                     _log;
     rfa::logger::ComponentLogger                &_componentLogger;
-    std::map<rfa::common::Handle*,std::string>  _watchList;
+    ItemRegistry                                _watchList;
     int                                         _refreshCount;
 };
 #endif
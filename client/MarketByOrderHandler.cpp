@@ -1,9 +1,11 @@
 
 #include "common/RDMUtils.h"
 #include "common/RDMDict.h"
+#include "common/FieldDecodeTable.h"
 
 #include "MarketByOrderHandler.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/unordered_map.hpp>
 
 using namespace rfa::data;
 
@@ -12,6 +14,7 @@ MarketByOrderHandler::MarketByOrderHandler(rfa::sessionLayer::OMMConsumer* pOMMC
                                        rfa::common::Client& client,
                                        const std::string& serviceName,
                                        const RDMFieldDict* dict,
+                                       const FieldDecodeTable* decodeTable,
                                        rfa::logger::ComponentLogger& componentLogger):
 _pOMMConsumer(pOMMConsumer),
 _componentLogger(componentLogger),
@@ -19,10 +22,15 @@ _eventQueue(eventQueue),
 _client(client),
 _serviceName(serviceName),
 _pDict(dict),
+_pDecodeTable(decodeTable),
 _debug(false),
+_batchMode(false),
+_bookDepth(0),
 _refreshCount(0),
 _log("")
 {
+    if(_pDict)
+        _bookFields.resolve(*_pDict);
 }
 
 
@@ -47,17 +55,15 @@ void MarketByOrderHandler::sendRequest(const std::string &itemName, const rfa::c
     rfa::sessionLayer::OMMItemIntSpec intSpec;
     intSpec.setMsg( &reqMsg );
 
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    std::pair<map<rfa::common::Handle*,std::string>::iterator,bool> ret;
-
-    it = _watchList.find(getHandle(itemName));
+    // release the names of removed items
+    _watchList.collect();
+    rfa::common::Handle* handle = getHandle(itemName);
 
     // If item already exists, re-issue the request
-    if(it == _watchList.end()) {
+    if(!handle) {
         _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
         if(interactionType == (rfa::message::ReqMsg::InitialImageFlag | rfa::message::ReqMsg::InterestAfterRefreshFlag)) {
-            ret = _watchList.insert(  pair<rfa::common::Handle*,std::string>(_pHandle,itemName+"."+_serviceName) );
-            if(ret.second) {
+            if(_watchList.add(_pHandle, itemName, _serviceName)) {
                 if(_debug) {
                     _log = "[MarketByOrderHandler::sendRequest] Add item subscription for: ";
                     _log.append((itemName+"."+_serviceName).c_str());
@@ -81,38 +87,164 @@ void MarketByOrderHandler::sendRequest(const std::string &itemName, const rfa::c
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
-        _pOMMConsumer->reissueClient(it->first, &intSpec);
+        _pOMMConsumer->reissueClient(handle, &intSpec);
+    }
+}
+
+/*
+* Request an item through the scheduler, or at once when pacing is off.
+* Items already open are re-issued at once.
+*/
+void MarketByOrderHandler::queueRequest(const std::string &itemName, const rfa::common::UInt8 &interactionType, int priority){
+    // release the names of removed items
+    _watchList.collect();
+    if(!_scheduler.isEnabled() || getHandle(itemName)) {
+        sendRequest(itemName, interactionType);
+        return;
+    }
+
+    RequestScheduler::Request request;
+    request.itemName = itemName;
+    request.interactionType = interactionType;
+    if(!_scheduler.enqueue(request, priority) && _debug) {
+        _log = "[MarketByOrderHandler::queueRequest] Request is already queued or outstanding for: ";
+        _log.append((itemName+"."+_serviceName).c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+    pumpRequests();
+}
+
+/*
+* Send the queued requests the window lets through.
+*/
+void MarketByOrderHandler::pumpRequests(){
+    RequestScheduler::Request request;
+    while(_scheduler.next(request))
+        sendRequest(request.itemName, request.interactionType);
+}
+
+void MarketByOrderHandler::setRequestWindow(size_t window, long timeout){
+    _scheduler.setWindow(window);
+    _scheduler.setTimeout(timeout);
+    pumpRequests();
+}
+
+const RequestScheduler &MarketByOrderHandler::getScheduler() const{
+    return _scheduler;
+}
+
+/*
+* Request many items in one batch request message.
+* Items already in the watchlist are re-issued one by one, the rest are listed in :ItemList.
+*/
+void MarketByOrderHandler::sendBatchRequest(const std::vector<std::string> &itemNames, const rfa::common::UInt8 &interactionType){
+    const bool streaming = interactionType == (rfa::message::ReqMsg::InitialImageFlag | rfa::message::ReqMsg::InterestAfterRefreshFlag);
+    std::vector<std::string> batchItems;
+    for(size_t i = 0; i < itemNames.size(); i++) {
+        if(getHandle(itemNames[i]))
+            sendRequest(itemNames[i], interactionType);
+        else if(!_watchList.isPending(itemNames[i], _serviceName))
+            batchItems.push_back(itemNames[i]);
+    }
+    if(batchItems.empty())
+        return;
+
+    rfa::message::ReqMsg reqMsg;
+    rfa::message::AttribInfo attribInfo(true) ;
+
+    attribInfo.setNameType(rfa::rdm::INSTRUMENT_NAME_RIC);
+    attribInfo.setServiceName(_serviceName.c_str());
+    reqMsg.setAttribInfo(attribInfo);
+
+    reqMsg.setMsgModelType(rfa::rdm::MMT_MARKET_BY_ORDER);
+    reqMsg.setInteractionType(interactionType);
+
+    rfa::data::ElementList elementList;
+    rfa::data::ElementListWriteIterator elwiter;
+    elwiter.start(elementList);
+    RDMUtils::encodeBatchItemList(batchItems, elwiter);
+    elwiter.complete();
+    reqMsg.setPayload(elementList);
+
+    rfa::sessionLayer::OMMItemIntSpec intSpec;
+    intSpec.setMsg( &reqMsg );
+
+    _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
+    _watchList.addBatch(_pHandle);
+    if(streaming) {
+        for(size_t i = 0; i < batchItems.size(); i++)
+            _watchList.addPending(batchItems[i], _serviceName);
+    }
+    if(_debug) {
+        _log = "[MarketByOrderHandler::sendBatchRequest] Batch request for ";
+        _log.append((int)batchItems.size());
+        _log += " items from ";
+        _log.append(_serviceName.c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+}
+
+/*
+* Register a batch requested item under the handle of its first response.
+* Return true if the response is to be dropped: it belongs to the batch request itself
+* or to an item closed while it was pending.
+*/
+bool MarketByOrderHandler::adoptItem(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle){
+    if(_watchList.isBatch(handle)) {
+        if((respMsg.getHintMask() & rfa::message::RespMsg::RespStatusFlag) &&
+                respMsg.getRespStatus().getStreamState() == rfa::common::RespStatus::ClosedEnum)
+            _watchList.removeBatch(handle);
+        if(_debug) {
+            _log = "[MarketByOrderHandler::processResponse] Batch request status: " + respMsg.getRespStatus().getStatusText();
+            _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+        }
+        return true;
     }
+    bool cancelled = false;
+    if(!_watchList.find(handle) && (respMsg.getHintMask() & rfa::message::RespMsg::AttribInfoFlag))
+        _watchList.adopt(handle, respMsg.getAttribInfo().getName().c_str(), _serviceName, cancelled);
+    if(cancelled)
+        _pOMMConsumer->unregisterClient(handle);
+    return cancelled;
 }
 
 void MarketByOrderHandler::closeRequest(const std::string &itemName){
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(getHandle(itemName));
-    if(it != _watchList.end()) {
+    // a batch requested item still waiting for its handle is closed with its first response
+    _watchList.cancelPending(itemName, _serviceName);
+    _scheduler.cancel(itemName);
+    rfa::common::Handle* handle = getHandle(itemName);
+    if(handle) {
         if(_debug) {
             _log = "[MarketByOrderHandler::closeRequest] Close item subscription for: ";
-            _log.append(it->second.c_str());
+            _log.append(_watchList.find(handle)->watchName.c_str());
         }
-        _pOMMConsumer->unregisterClient(it->first);
-        _watchList.erase(it);
+        _pOMMConsumer->unregisterClient(handle);
+        _watchList.remove(handle);
+        _books.erase(handle);
         if(_debug) {
             _log += ". Watchlist size: ";
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
     }
+    pumpRequests();
 }
 
 void MarketByOrderHandler::closeAllRequest(){
     _pOMMConsumer->unregisterClient();
     _watchList.clear();
+    _scheduler.clear();
+    _books.clear();
     if(_debug) {
         _log = "[MarketByOrderHandler::closeAllRequest] Close all item subscription.";
          _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
     }
 }
 
-void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out) {
+void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out) {
+    if(adoptItem(respMsg, handle))
+        return;
+
     std::string itemName = "";
     std::string itemServiceName = "";
     itemName = getItemName(handle);
@@ -129,21 +261,38 @@ void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg,
             if(_debug)
                 cout << "[MarketByOrderHandler::processResponse] MarketByOrder Refresh: " << itemName << "." << itemServiceName << endl;
 
-            // Notify that this is a refresh
-            if(_refreshCount == 0) {
-                dict preempt;
-                preempt["RIC"] = itemName;
-                preempt["SERVICE"] = itemServiceName;
-                preempt["MTYPE"] = "REFRESH";
-                out += boost::python::make_tuple(preempt);
-            }
-
-            if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeMarketByOrder(respMsg.getPayload(), out, itemName, itemServiceName, "IMAGE");
+            if(_bookDepth > 0) {
+                // the book is rebuilt from the refresh and delivered once it is complete
+                ItemBook &itemBook = _books[handle];
+                if(!itemBook.book)
+                    itemBook.book.reset(new OrderBook());
+                if(!itemBook.refreshing) {
+                    itemBook.book->clear();
+                    itemBook.refreshing = true;
+                }
+                if(respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)
+                    updateBook(respMsg.getPayload(), *itemBook.book);
+                if(respMsg.getIndicationMask() & rfa::message::RespMsg::RefreshCompleteFlag) {
+                    itemBook.refreshing = false;
+                    publishBook(itemBook, out, itemName, itemServiceName, true);
+                }
             } else {
-                if(_debug) {
-                    _log = "[MarketByOrderHandler::processResponse] Empty Refresh.";
-                    _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+                // Notify that this is a refresh
+                if(_refreshCount == 0) {
+                    dict preempt;
+                    preempt["RIC"] = itemName;
+                    preempt["SERVICE"] = itemServiceName;
+                    preempt["MTYPE"] = "REFRESH";
+                    out.append(preempt);
+                }
+
+                if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
+                    decodeMarketByOrder(respMsg.getPayload(), out, itemName, itemServiceName, FieldDecodeTable::ImageValue);
+                } else {
+                    if(_debug) {
+                        _log = "[MarketByOrderHandler::processResponse] Empty Refresh.";
+                        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+                    }
                 }
             }
 
@@ -154,6 +303,8 @@ void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg,
                     _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
                 }
                 _refreshCount = 0;
+                _scheduler.complete(itemName);
+                pumpRequests();
             } else {
                 _refreshCount++;
             }
@@ -163,13 +314,19 @@ void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg,
             if(_debug)
                 cout << "[MarketByOrderHandler::processResponse] MarketByOrder Update: " << itemName << "." << itemServiceName << endl;
 
-            if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeMarketByOrder(respMsg.getPayload(), out, itemName, itemServiceName, "UPDATE");
-            } else {
+            if (!(respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
                 if(_debug) {
                     _log = "[MarketByOrderHandler::processResponse] Empty Update.";
                     _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
                 }
+            } else if(_bookDepth > 0) {
+                boost::unordered_map<rfa::common::Handle*, ItemBook>::iterator it = _books.find(handle);
+                if(it != _books.end()) {
+                    updateBook(respMsg.getPayload(), *it->second.book);
+                    publishBook(it->second, out, itemName, itemServiceName, false);
+                }
+            } else {
+                decodeMarketByOrder(respMsg.getPayload(), out, itemName, itemServiceName, FieldDecodeTable::UpdateValue);
             }
             break;
 
@@ -182,7 +339,7 @@ void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg,
             d["DATA_STATE"] = RDMUtils::dataStateToString(respMsg.getRespStatus().getDataState()).c_str();
             d["STREAM_STATE"] = RDMUtils::streamStateToString(respMsg.getRespStatus().getStreamState()).c_str();
             d["STATUS_CODE"] = RDMUtils::statusCodeToString(respMsg.getRespStatus().getStatusCode()).c_str();
-            out += boost::python::make_tuple(d);
+            out.append(d);
             if(_debug)
                 cout << "[MarketByOrderHandler::processResponse] MarketByOrder Status: "<< respMsg.getRespStatus().getStatusText().c_str() << endl;
             _log = "[MarketByOrderHandler::processResponse] MarketByOrder Status: " + respMsg.getRespStatus().getStatusText();
@@ -207,6 +364,12 @@ void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg,
         _log += status.getStatusText();
         _log += "\"";
 
+        // the request is over in any other stream state, its window slot is free again
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum) {
+            _scheduler.cancel(itemName);
+            pumpRequests();
+        }
+
         // close item if streamState is closed
         if(status.getStreamState() == rfa::common::RespStatus::ClosedEnum) {
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
@@ -219,19 +382,23 @@ void MarketByOrderHandler::processResponse(const rfa::message::RespMsg& respMsg,
         }
     }
 
-    if(_debug && (out != boost::python::tuple()))
+    // the slots of timed out requests
+    if(_scheduler.queued() > 0)
+        pumpRequests();
+
+    if(_debug && (len(out) > 0))
         prettyPrint(out);
 }
 
-void MarketByOrderHandler::prettyPrint(boost::python::tuple& inputTuple) {
+void MarketByOrderHandler::prettyPrint(boost::python::list& inputList) {
     string out = "";
     out.append("(");
-    for ( int i = 0 ; i < len(inputTuple) ; i++ ) {
-        extract<dict>dictElement(inputTuple[i]);
+    for ( int i = 0 ; i < len(inputList) ; i++ ) {
+        extract<dict>dictElement(inputList[i]);
         //check whether the converted data is python dictionary
         if (dictElement.check()) {
             out.append("{");
-            dict dictElement = extract<dict>(inputTuple[i]);
+            dict dictElement = extract<dict>(inputList[i]);
             boost::python::list keys = (boost::python::list)dictElement.keys();
 
             for (int j = 0; j < len(keys); j++) {
@@ -268,7 +435,7 @@ void MarketByOrderHandler::prettyPrint(boost::python::tuple& inputTuple) {
                 }
             }
             out.append("}");
-            if (i != len(inputTuple) - 1) {
+            if (i != len(inputList) - 1) {
                 out.append(",");
             }
         }
@@ -277,238 +444,286 @@ void MarketByOrderHandler::prettyPrint(boost::python::tuple& inputTuple) {
     cout << out << endl;
 }
 
-void MarketByOrderHandler::decodeMarketByOrder(const rfa::common::Data& data, boost::python::tuple &out, const std::string &itemName, const std::string &serviceName, const std::string &mtype) {
-    dict d;
+/*
+* Decode the summary data of an order book map, false if it has none.
+*/
+bool MarketByOrderHandler::decodeSummary(const rfa::data::Map& mapData, dict& summary, Py_ssize_t extra) {
+    if(!(mapData.getIndicationMask() & rfa::data::Map::SummaryDataFlag))
+        return false;
+    const rfa::common::Data & summaryData = mapData.getSummaryData();
+    if (summaryData.getDataType() != rfa::data::FieldListEnum)
+        return false;
+    const rfa::data::FieldList & summaryFieldList = static_cast<const rfa::data::FieldList &>(summaryData);
+    summary = FieldDecodeTable::newDict(summaryFieldList, extra);
+    FieldDecodeTable::DictSink sink(*_pDecodeTable, summary, &_fieldFilter);
+    _pDecodeTable->decodeFieldList(summaryFieldList, sink);
+    return true;
+}
+
+/*
+* The key of an order, 0 if it is not a buffer.
+*/
+static const rfa::data::DataBuffer* orderKey(const rfa::data::MapEntry & entry) {
+    const rfa::common::Data & keyData = entry.getKeyData();
+    if (keyData.getDataType() != rfa::data::DataBufferEnum) {
+        cout << "[MarketByOrderHandler::decodeMarketByOrder] Expected key datatype of DataBuffer" << endl;
+        return 0;
+    }
+    const rfa::data::DataBuffer & keyBuffer = static_cast<const rfa::data::DataBuffer &>(keyData);
+    if (keyBuffer.getDataBufferType() != rfa::data::DataBuffer::BufferEnum){
+        cout << "[MarketByOrderHandler::decodeMarketByOrder] Expected key buffer data buffer type of Buffer" << endl;
+        return 0;
+    }
+    return &keyBuffer;
+}
+
+/*
+* The fields of an added or updated order, 0 for deleted orders.
+*/
+static const rfa::data::FieldList* orderFields(const rfa::data::MapEntry & entry) {
+    if (entry.getAction() == rfa::data::MapEntry::Delete)
+        return 0;
+    const rfa::common::Data & valueData = entry.getData();
+    if (valueData.getDataType() != rfa::data::FieldListEnum) {
+        cout << "[MarketByOrderHandler::decodeMarketByOrder] Expected data datatype of FieldList" << endl;
+        return 0;
+    }
+    return &static_cast<const rfa::data::FieldList &>(valueData);
+}
+
+static FieldDecodeTable::FixedKey orderAction(const rfa::data::MapEntry & entry) {
+    switch (entry.getAction()) {
+        case rfa::data::MapEntry::Add:
+            return FieldDecodeTable::AddValue;
+        case rfa::data::MapEntry::Delete:
+            return FieldDecodeTable::DeleteValue;
+        default:
+            return FieldDecodeTable::UpdateValue;
+    }
+}
+
+/*
+* One record per order with its own fields, after a SUMMARY record when the map has summary data.
+*/
+void MarketByOrderHandler::decodeMarketByOrder(const rfa::common::Data& data, boost::python::list& out, const std::string &itemName, const std::string &serviceName, FieldDecodeTable::FixedKey mtype) {
+    object ric(itemName);
+    object service(serviceName);
     const rfa::data::Map& mapData = static_cast<const rfa::data::Map&>(data);
-    // data is RFA update message
+    if(_batchMode) {
+        decodeMarketByOrderBatch(mapData, out, ric, service, mtype);
+        return;
+    }
+
+    dict summary;
+    if(decodeSummary(mapData, summary, 4)) {
+        _pDecodeTable->setItem(summary, FieldDecodeTable::ServiceKey, service);
+        _pDecodeTable->setItem(summary, FieldDecodeTable::RicKey, ric);
+        _pDecodeTable->setItem(summary, FieldDecodeTable::MTypeKey, mtype);
+        _pDecodeTable->setItem(summary, FieldDecodeTable::ActionKey, FieldDecodeTable::SummaryValue);
+        out.append(summary);
+    }
+    if(!(mapData.getIndicationMask() & rfa::data::Map::EntriesFlag))
+        return;
+
+    rfa::data::MapReadIterator mri;
+    for(mri.start(mapData); !mri.off(); mri.forth()) {
+        const rfa::data::MapEntry & entry = mri.value();
+        const rfa::data::DataBuffer* keyBuffer = orderKey(entry);
+        if(!keyBuffer)
+            continue;
+        const rfa::data::FieldList* entryFieldList = orderFields(entry);
+        if(!entryFieldList && entry.getAction() != rfa::data::MapEntry::Delete)
+            continue;
+
+        dict d = entryFieldList ? FieldDecodeTable::newDict(*entryFieldList, 5) : FieldDecodeTable::newDict(5);
+        _pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, service);
+        _pDecodeTable->setItem(d, FieldDecodeTable::RicKey, ric);
+        _pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, mtype);
+        _pDecodeTable->setItem(d, FieldDecodeTable::ActionKey, orderAction(entry));
+        _pDecodeTable->setItem(d, FieldDecodeTable::KeyKey, keyBuffer->getAsString().c_str());
+        if(entryFieldList) {
+            FieldDecodeTable::DictSink sink(*_pDecodeTable, d, &_fieldFilter);
+            _pDecodeTable->decodeFieldList(*entryFieldList, sink);
+        }
+        out.append(d);
+    }
+}
+
+/*
+* The whole message as one record, ACTION and KEY tuples with one item per order and
+* FIELDS a list per field, None for the orders without it. SUMMARY holds the summary fields.
+*/
+void MarketByOrderHandler::decodeMarketByOrderBatch(const rfa::data::Map& mapData, boost::python::list& out, const object &ric, const object &service, FieldDecodeTable::FixedKey mtype) {
+    dict batch = FieldDecodeTable::newDict(7);
+    _pDecodeTable->setItem(batch, FieldDecodeTable::ServiceKey, service);
+    _pDecodeTable->setItem(batch, FieldDecodeTable::RicKey, ric);
+    _pDecodeTable->setItem(batch, FieldDecodeTable::MTypeKey, mtype);
+
+    // the fields of every order in one vector, with the order each belongs to
+    boost::python::list actions;
+    boost::python::list keys;
+    std::vector<FieldValue> values;
+    std::vector<Py_ssize_t> rows;
+    Py_ssize_t orders = 0;
     if(mapData.getIndicationMask() & rfa::data::Map::EntriesFlag) {
+        FieldDecodeTable::ValueSink sink(values, &_fieldFilter);
         rfa::data::MapReadIterator mri;
-        mri.start(mapData);
-        const rfa::data::MapEntry & entryInit = mri.value();
-        const rfa::common::Data & valueDataInit = entryInit.getData();
-        const rfa::data::FieldList & EntryFieldList = static_cast<const rfa::data::FieldList &>(valueDataInit);
         for(mri.start(mapData); !mri.off(); mri.forth()) {
             const rfa::data::MapEntry & entry = mri.value();
-            const rfa::common::Data & keyData = entry.getKeyData();
-            const rfa::common::Data & valueData = entry.getData();
-            if (keyData.getDataType() != rfa::data::DataBufferEnum) {
-                cout << "[MarketByOrderHandler::decodeMarketByOrder] Expected key datatype of DataBuffer" << endl;
-                return;
+            const rfa::data::DataBuffer* keyBuffer = orderKey(entry);
+            if(!keyBuffer)
+                continue;
+            const rfa::data::FieldList* entryFieldList = orderFields(entry);
+            if(!entryFieldList && entry.getAction() != rfa::data::MapEntry::Delete)
+                continue;
+
+            actions.append(object(handle<>(borrowed(_pDecodeTable->getKey(orderAction(entry))))));
+            keys.append(keyBuffer->getAsString().c_str());
+            if(entryFieldList) {
+                _pDecodeTable->decodeFieldList(*entryFieldList, sink);
+                rows.resize(values.size(), orders);
             }
-            const rfa::data::DataBuffer & keyBuffer = static_cast<const rfa::data::DataBuffer &>(keyData);
-            if (keyBuffer.getDataBufferType() != rfa::data::DataBuffer::BufferEnum){
-                cout << "[MarketByOrderHandler::decodeMarketByOrder] Expected key buffer data buffer type of Buffer" << endl;
-                return;
-            }
-
-            rfa::data::FieldListReadIterator flri;
-            switch (entry.getAction()) {
-                case rfa::data::MapEntry::Add:
-                    d["SERVICE"] = serviceName.c_str();
-                    d["RIC"] = itemName.c_str();
-                    d["MTYPE"]= mtype.c_str();
-                    d["ACTION"] = "ADD";
-                    d["KEY"] = static_cast<const rfa::data::DataBuffer&> (keyData).getAsString().c_str();
-
-                    for(flri.start(EntryFieldList); !flri.off(); flri.forth()) {
-                        const rfa::data::FieldEntry& field = flri.value();
-                        const rfa::common::Int16 fieldID = field.getFieldID();
-                        const RDMFieldDef* fieldDef = _pDict->getFieldDef(fieldID);
-                        rfa::common::RFA_String fieldValue;
-                        // if field name does not exist, use the field ID instead
-                        // if no field definition then no dict then no dataType
-                        if(!fieldDef) {
-                            const rfa::common::UInt8 dataType = (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
-                            const rfa::common::Data& fieldData = field.getData(dataType);
-                            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-                            rfa::common::RFA_String fieldValue;
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                            d[fieldID] = fieldValue.trimWhitespace().c_str();
-
-                        } else {
-                            // convert to DataBuffer
-                            const rfa::common::UInt8 dataType = fieldDef->getDataType();
-                            const rfa::common::Data& fieldData = field.getData(dataType);
-                            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-                            const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
-                            const RDMEnumDef* enumDef = 0;
-
-                            //Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
-                            //check and decode according to data buffer type
-                            switch(dataBufferType) {
-                                case rfa::data::DataBuffer::EnumerationEnum:
-                                    enumDef = fieldDef->getEnumDef();
-                                    fieldValue = RDMUtils::dataBufferToString(dataBuffer,enumDef).c_str();
-                                    d[fieldDef->getName().c_str()] = fieldValue.c_str();
-                                    break;
-                                case rfa::data::DataBuffer::FloatEnum:
-                                case rfa::data::DataBuffer::DoubleEnum:
-                                case rfa::data::DataBuffer::Real32Enum:
-                                case rfa::data::DataBuffer::Real64Enum:
-                                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                                    if(fieldValue.empty()) {
-                                        //d[fieldDef->getName().c_str()] = boost::python::object();
-                                        d[fieldDef->getName().c_str()] = "";
-                                    } else {
-                                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToDouble(dataBuffer);
-                                    }
-                                    break;
-                                case rfa::data::DataBuffer::Int32Enum:
-                                case rfa::data::DataBuffer::UInt32Enum:
-                                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                                    if(fieldValue.empty()) {
-                                        d[fieldDef->getName().c_str()] = "";
-                                    } else {
-                                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToInt(dataBuffer);
-                                    }
-                                    break;
-                                case rfa::data::DataBuffer::Int64Enum:
-                                case rfa::data::DataBuffer::UInt64Enum:
-                                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                                    if(fieldValue.empty()) {
-                                        d[fieldDef->getName().c_str()] = "";
-                                    } else {
-                                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToLong(dataBuffer);
-                                    }
-                                    break;
-                                default:
-                                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                                    d[fieldDef->getName().c_str()] = fieldValue.trimWhitespace().c_str();
-                                    break;
-                            }
-                        }
-                    }
-                    break;
-
-                case rfa::data::MapEntry::Update:
-                    if (valueData.getDataType() != rfa::data::FieldListEnum) {
-                        cout << "[MarketByOrderHandler::decodeMarketByOrder] Expected data datatype of FieldList" << endl;
-                        return;
-                    }
-                    d["SERVICE"] = serviceName.c_str();
-                    d["RIC"] = itemName.c_str();
-                    d["MTYPE"]= mtype.c_str();
-                    d["ACTION"] = "UPDATE";
-                    d["KEY"] = static_cast<const rfa::data::DataBuffer&> (keyData).getAsString().c_str();
-                    for(flri.start(EntryFieldList); !flri.off(); flri.forth()) {
-                        const rfa::data::FieldEntry& field = flri.value();
-                        const rfa::common::Int16 fieldID = field.getFieldID();
-                        const RDMFieldDef* fieldDef = _pDict->getFieldDef(fieldID);
-                        rfa::common::RFA_String fieldValue;
-
-                        // if field name does not exist, use the field ID instead
-                        // if no field definition then no dict then no dataType
-                        if(!fieldDef) {
-                            const rfa::common::UInt8 dataType = (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
-                            const rfa::common::Data& fieldData = field.getData(dataType);
-                            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-                            rfa::common::RFA_String fieldValue;
-                            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                            d[fieldID] = fieldValue.trimWhitespace().c_str();
-
-                        } else {
-                        // convert to DataBuffer
-                        const rfa::common::UInt8 dataType = fieldDef->getDataType();
-                        const rfa::common::Data& fieldData = field.getData(dataType);
-                        const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-                        const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
-                        const RDMEnumDef* enumDef = 0;
-
-                        //Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
-                        //check and decode according to data buffer type
-                        switch(dataBufferType) {
-                            case rfa::data::DataBuffer::EnumerationEnum:
-                                enumDef = fieldDef->getEnumDef();
-                                fieldValue = RDMUtils::dataBufferToString(dataBuffer,enumDef).c_str();
-                                d[fieldDef->getName().c_str()] = fieldValue.c_str();
-                                break;
-                            case rfa::data::DataBuffer::FloatEnum:
-                            case rfa::data::DataBuffer::DoubleEnum:
-                            case rfa::data::DataBuffer::Real32Enum:
-                            case rfa::data::DataBuffer::Real64Enum:
-                                d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToDouble(dataBuffer);
-                                break;
-                            case rfa::data::DataBuffer::Int32Enum:
-                            case rfa::data::DataBuffer::UInt32Enum:
-                                d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToInt(dataBuffer);
-                                break;
-                            case rfa::data::DataBuffer::Int64Enum:
-                            case rfa::data::DataBuffer::UInt64Enum:
-                                d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToLong(dataBuffer);
-                            break;
-                            default:
-                                fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                                d[fieldDef->getName().c_str()] = fieldValue.trimWhitespace().c_str();
-                                break;
-                            }
-
-                        }
-                    }
+            orders++;
+        }
+    }
 
-                    break;
+    // pivot into one list per field
+    boost::unordered_map<rfa::common::Int16, boost::python::list> columns;
+    for(size_t i = 0; i < values.size(); i++) {
+        boost::unordered_map<rfa::common::Int16, boost::python::list>::iterator it = columns.find(values[i].fieldId);
+        if(it == columns.end())
+            it = columns.insert(std::make_pair(values[i].fieldId, FieldDecodeTable::newList(orders))).first;
+        if(PyList_SetItem(it->second.ptr(), rows[i], incref(_pDecodeTable->toPython(values[i]).ptr())) < 0)
+            throw_error_already_set();
+    }
+    dict fields = FieldDecodeTable::newDict((Py_ssize_t)columns.size());
+    for(boost::unordered_map<rfa::common::Int16, boost::python::list>::iterator it = columns.begin(); it != columns.end(); ++it)
+        fields[_pDecodeTable->getFieldKey(it->first)] = it->second;
+
+    _pDecodeTable->setItem(batch, FieldDecodeTable::ActionKey, tuple(actions));
+    _pDecodeTable->setItem(batch, FieldDecodeTable::KeyKey, tuple(keys));
+    batch["FIELDS"] = fields;
+    dict summary;
+    if(decodeSummary(mapData, summary, 0))
+        _pDecodeTable->setItem(batch, FieldDecodeTable::SummaryValue, summary);
+    out.append(batch);
+}
 
-                case rfa::data::MapEntry::Delete:
-                    d["SERVICE"] = serviceName.c_str();
-                    d["RIC"] = itemName.c_str();
-                    d["MTYPE"]= mtype.c_str();
-                    d["ACTION"] = "DELETE";
-                    d["KEY"] = static_cast<const rfa::data::DataBuffer&> (keyData).getAsString().c_str();
-                    break;
-            }
-            out += boost::python::make_tuple(d);
-            d = dict();
+/*
+* Apply the orders of a map to the book of its item.
+*/
+void MarketByOrderHandler::updateBook(const rfa::common::Data& data, OrderBook& book) {
+    const rfa::data::Map& mapData = static_cast<const rfa::data::Map&>(data);
+    if(!(mapData.getIndicationMask() & rfa::data::Map::EntriesFlag))
+        return;
+
+    rfa::data::MapReadIterator mri;
+    for(mri.start(mapData); !mri.off(); mri.forth()) {
+        const rfa::data::MapEntry & entry = mri.value();
+        const rfa::data::DataBuffer* keyBuffer = orderKey(entry);
+        if(!keyBuffer)
+            continue;
+        const std::string key = keyBuffer->getAsString().c_str();
+        if(entry.getAction() == rfa::data::MapEntry::Delete) {
+            book.removeOrder(key);
+            continue;
         }
+        const rfa::data::FieldList* entryFieldList = orderFields(entry);
+        if(!entryFieldList)
+            continue;
+        OrderBook::Change change;
+        OrderBook::Sink sink(_bookFields, change);
+        _pDecodeTable->decodeFieldList(*entryFieldList, sink);
+        book.setOrder(key, change);
     }
 }
 
+/*
+* Deliver the top levels of a book as a BOOK record when they changed since the last one.
+*/
+void MarketByOrderHandler::publishBook(ItemBook& itemBook, boost::python::list& out, const std::string &itemName, const std::string &serviceName, bool force) {
+    OrderBook::Depth bids;
+    OrderBook::Depth asks;
+    itemBook.book->getDepth(OrderBook::Bid, _bookDepth, bids);
+    itemBook.book->getDepth(OrderBook::Ask, _bookDepth, asks);
+    if(!force && bids == itemBook.bids && asks == itemBook.asks)
+        return;
+    itemBook.bids.swap(bids);
+    itemBook.asks.swap(asks);
+
+    dict d;
+    d["RIC"] = itemName;
+    d["SERVICE"] = serviceName;
+    d["MTYPE"] = "BOOK";
+    d["BID"] = OrderBook::toPython(itemBook.bids);
+    d["ASK"] = OrderBook::toPython(itemBook.asks);
+    d["ORDERS"] = itemBook.book->orders();
+    out.append(d);
+}
+
+/*
+* Keep a native book per item and deliver its top depth levels as BOOK records
+* instead of a record per order, 0 turns the books off.
+* Items need a refresh after the books are turned on.
+*/
+void MarketByOrderHandler::setBookDepth(size_t depth) {
+    _bookDepth = depth;
+    if(_bookDepth == 0)
+        _books.clear();
+}
+
+/*
+* The depth best levels of the book of an item, all for 0. False if it has no book.
+*/
+bool MarketByOrderHandler::getBook(const std::string &itemName, size_t depth, dict &book) {
+    boost::unordered_map<rfa::common::Handle*, ItemBook>::const_iterator it = _books.find(getHandle(itemName));
+    if(it == _books.end())
+        return false;
+
+    OrderBook::Depth levels;
+    book["RIC"] = itemName;
+    book["SERVICE"] = getItemServiceName(it->first);
+    book["MTYPE"] = "BOOK";
+    it->second.book->getDepth(OrderBook::Bid, depth, levels);
+    book["BID"] = OrderBook::toPython(levels);
+    it->second.book->getDepth(OrderBook::Ask, depth, levels);
+    book["ASK"] = OrderBook::toPython(levels);
+    book["ORDERS"] = it->second.book->orders();
+    return true;
+}
+
+/*
+* Deliver each refresh or update message as one columnar record instead of a dict per order.
+*/
+void MarketByOrderHandler::setBatchMode(bool batch) {
+    _batchMode = batch;
+}
+
+/*
+* Decode only the given FIDs of the entries, none decodes every field.
+*/
+void MarketByOrderHandler::setFieldFilter(const std::vector<rfa::common::Int16> &fieldIds) {
+    _fieldFilter.set(fieldIds);
+}
+
 void MarketByOrderHandler::setDebugMode(const bool &debug) {
     _debug = debug;
 }
 
 std::string MarketByOrderHandler::getItemName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        if (strs.size() > 2) {
-            std::vector<std::string>::iterator strsit = strs.begin();
-            itemName = *strsit;
-            strsit++;
-            for (std::vector<std::string>::size_type i=1; i < strs.size()-1; i++) {
-                itemName = itemName + "." + *strsit;
-                strsit++;
-            }
-        } else {
-            itemName = strs[0];
-        }
-    }
-    return itemName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->itemName : "";
 }
 
 std::string MarketByOrderHandler::getItemServiceName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemServiceName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        itemServiceName = strs.back();
-    }
-    return itemServiceName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->serviceName : "";
 }
 
 rfa::common::Handle* MarketByOrderHandler::getHandle(const std::string &itemName) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    for(it = _watchList.begin(); it != _watchList.end(); it++) {
-        if(it->second == itemName+"."+_serviceName) {
-            return it->first;
-        }
-    }
-    return NULL;
+    return _watchList.findHandle(itemName, _serviceName);
 }
 
-std::map<rfa::common::Handle*,std::string> &MarketByOrderHandler::getWatchList() {
+ItemRegistry &MarketByOrderHandler::getWatchList() {
     return _watchList;
 }
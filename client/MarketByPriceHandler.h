@@ -2,7 +2,14 @@
 #define MARKETBYPRICEHANDLER_H
 
 #include "StdAfx.h"
+#include "common/ItemRegistry.h"
+#include "common/RequestScheduler.h"
+#include "common/FieldFilter.h"
+#include "common/FieldDecodeTable.h"
+#include "common/PriceBook.h"
 #include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 class RDMFieldDict;
 
@@ -16,20 +23,44 @@ public:
                     rfa::common::Client& client,
                     const std::string& serviceName,
                     const RDMFieldDict* dict,
+                    const FieldDecodeTable* decodeTable,
                     rfa::logger::ComponentLogger& componentLogger);
     ~MarketByPriceHandler(void);
     void                                        sendRequest(const std::string &itemName, const rfa::common::UInt8 &interactionType);
+    void                                        queueRequest(const std::string &itemName, const rfa::common::UInt8 &interactionType, int priority);
+    void                                        sendBatchRequest(const std::vector<std::string> &itemNames, const rfa::common::UInt8 &interactionType);
     void                                        closeRequest(const std::string &itemName);
     void                                        closeAllRequest();
-    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out);
     std::string                                 getItemName(rfa::common::Handle* handle);
     std::string                                 getItemServiceName(rfa::common::Handle* handle);
     rfa::common::Handle*                        getHandle(const std::string &itemName);
     void                                        setDebugMode(const bool &debugLevel);
-    std::map<rfa::common::Handle*,std::string>  &getWatchList();
+    ItemRegistry                                &getWatchList();
+    void                                        setRequestWindow(size_t window, long timeout);
+    const RequestScheduler                      &getScheduler() const;
+    void                                        setFieldFilter(const std::vector<rfa::common::Int16> &fieldIds);
+    void                                        setBookDepth(size_t depth);
+    bool                                        getDepth(const std::string &itemName, size_t depth, dict &book);
 
 private:
-    void                                        decodeMarketByPrice(const rfa::common::Data& data, boost::python::tuple &out, const std::string &itemName, const std::string &serviceName, const std::string &mtype);
+    // native book of an item and the levels last delivered
+    struct ItemBook
+    {
+        boost::shared_ptr<PriceBook>            book;
+        OrderBook::Depth                        bids;
+        OrderBook::Depth                        asks;
+        // a refresh of the item is in progress, its first part clears the book
+        bool                                    refreshing;
+
+        ItemBook() : refreshing(false) {}
+    };
+
+    void                                        pumpRequests();
+    void                                        updateBook(const rfa::common::Data& data, PriceBook& book);
+    void                                        publishBook(ItemBook& itemBook, boost::python::list& out, const std::string &itemName, const std::string &serviceName, bool force);
+    bool                                        adoptItem(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle);
+    void                                        decodeMarketByPrice(const rfa::common::Data& data, boost::python::list& out, const std::string &itemName, const std::string &serviceName, FieldDecodeTable::FixedKey mtype);
     rfa::sessionLayer::OMMConsumer              *_pOMMConsumer;
     rfa::logger::ComponentLogger                &_componentLogger;
     rfa::common::EventQueue                     &_eventQueue;
@@ -37,10 +68,16 @@ private:
     const std::string                           &_serviceName;
     rfa::common::Handle                         *_pHandle;
     const RDMFieldDict*                         _pDict;
+    const FieldDecodeTable*                     _pDecodeTable;
     bool                                        _debug;
-    std::map<rfa::common::Handle*,std::string>  _watchList;
+    size_t                                      _bookDepth;
+    OrderBook::FieldIds                         _bookFields;
+    boost::unordered_map<rfa::common::Handle*, ItemBook> _books;
+    ItemRegistry                                _watchList;
+    RequestScheduler                            _scheduler;
+    FieldFilter                                 _fieldFilter;
     int                                        _refreshCount;
-    void                                        prettyPrint(boost::python::tuple& inputTuple);
+    void                                        prettyPrint(boost::python::list& inputList);
     rfa::common::RFA_String                     _log;
 };
 #endif
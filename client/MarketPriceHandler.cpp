@@ -1,8 +1,11 @@
 #include "common/RDMUtils.h"
 #include "common/RDMDict.h"
+#include "common/FieldDecodeTable.h"
+#include "common/LazyUpdate.h"
 
 #include "MarketPriceHandler.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/shared_ptr.hpp>
 
 using namespace rfa::data;
 
@@ -10,7 +13,8 @@ MarketPriceHandler::MarketPriceHandler(rfa::sessionLayer::OMMConsumer* pOMMConsu
                                        rfa::common::EventQueue& eventQueue,
                                        rfa::common::Client& client,
                                        const std::string& serviceName,
-                                       const RDMFieldDict* dict,
+                                       const boost::shared_ptr<const RDMFieldDict>& dict,
+                                       const boost::shared_ptr<const FieldDecodeTable>& decodeTable,
                                        rfa::logger::ComponentLogger& componentLogger):
 _pOMMConsumer(pOMMConsumer),
 _componentLogger(componentLogger),
@@ -18,8 +22,12 @@ _eventQueue(eventQueue),
 _client(client),
 _serviceName(serviceName),
 _pDict(dict),
+_pDecodeTable(decodeTable),
 _debug(false),
-_refreshCount(0),
+_pCompletions(0),
+_cacheImages(false),
+_mergeUpdates(false),
+_lazyDecode(false),
 _log("")
 {
 }
@@ -44,86 +52,27 @@ void MarketPriceHandler::sendRequest(const std::string &itemName, const std::str
     reqMsg.setInteractionType(interactionType);
 
     //Set a view
-    vector<string> viewFIDList;
-    boost::split(viewFIDList, viewFIDs, boost::is_any_of(","));
-    rfa::common::RFA_String fieldName;
-	rfa::data::ElementList elementList;
-
-    const rfa::common::RFA_String n="ABCDEFDGHIJKLMNOPQRSTUVWXYZ_%#/*\xDE\xFE";
-    bool isFieldName=false;
-    rfa::common::Int32 fieldID;
-
+    rfa::data::ElementList elementList;
     if(!viewFIDs.empty()) {
-		reqMsg.setIndicationMask(reqMsg.getIndicationMask() | rfa::message::ReqMsg::ViewFlag);
-
-		rfa::data::ElementEntry element;
-		rfa::data::ElementListWriteIterator elwiter;
-		rfa::data::DataBuffer dataBuffer;
-		elwiter.start(elementList);
-
-		//Encode a ViewType
-		element.setName(rfa::rdm::ENAME_VIEW_TYPE);
-		dataBuffer.setUInt32(rfa::rdm::VT_FIELD_ID_LIST, DataBuffer::UInt32Enum);
-		element.setData(static_cast<const Data&>(dataBuffer));
-		elwiter.bind(element);
-
-		rfa::data::ArrayWriteIterator arrWIt;
-		rfa::data::Array elementData;
-		rfa::data::ArrayEntry arrayEntry;
-		element.clear();
-		arrWIt.start(elementData);
-
-        for(size_t i = 0; i < viewFIDList.size(); i++) {
-            if(viewFIDList[i].empty())
-                continue;
-            dataBuffer.clear();
-            arrayEntry.clear();
-            // check if given field is in fieldID or fieldName format (number or string)
-            fieldName = viewFIDList[i].c_str();
-            isFieldName = false;
-            for(unsigned int ii = 0; ii <= n.size(); ++ii) {
-                if(fieldName.toUpper().find(n.substr(ii,1)) >= 0) {
-                    isFieldName = true;
-                    break;
-                }
-            }
-            const RDMFieldDef* fieldDef = NULL;
-            if(isFieldName) {
-                fieldDef = _pDict->getFieldDef(fieldName.trimWhitespace().toUpper());
-                if(!fieldDef) {
-                    continue;
-                }
-                fieldID = fieldDef->getFieldId();
-                dataBuffer.setInt32(fieldID);
-            } else {
-                dataBuffer.setFromString(fieldName.trimWhitespace(), DataBuffer::Int32Enum);
-            }
-			arrayEntry.setData(dataBuffer);
-			arrWIt.bind(arrayEntry);
-		}
-		arrWIt.complete();
-
-		element.setName(rfa::rdm::ENAME_VIEW_DATA);
-		element.setData(static_cast<const Data&>(elementData));
-		elwiter.bind(element);
-		elwiter.complete();
-		reqMsg.setPayload(elementList);
-	}
+        reqMsg.setIndicationMask(reqMsg.getIndicationMask() | rfa::message::ReqMsg::ViewFlag);
+
+        rfa::data::ElementListWriteIterator elwiter;
+        elwiter.start(elementList);
+        encodeView(viewFIDs, elwiter);
+        elwiter.complete();
+        reqMsg.setPayload(elementList);
+    }
 
     rfa::sessionLayer::OMMItemIntSpec intSpec;
     intSpec.setMsg( &reqMsg );
 
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    std::pair<map<rfa::common::Handle*,std::string>::iterator,bool> ret;
-
-    it = _watchList.find(getHandle(itemName));
+    rfa::common::Handle* handle = getHandle(itemName);
 
     // If item already exists, re-issue the request
-    if(it == _watchList.end()) {
+    if(!handle) {
         _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
         if(interactionType == (rfa::message::ReqMsg::InitialImageFlag | rfa::message::ReqMsg::InterestAfterRefreshFlag)) {
-            ret = _watchList.insert(  pair<rfa::common::Handle*,std::string>(_pHandle,itemName+"."+_serviceName) );
-            if(ret.second) {
+            if(_watchList.add(_pHandle, itemName, _serviceName)) {
                 if(_debug) {
                     _log = "[MarketPriceHandler::sendRequest] Add item subscription for: ";
                     _log.append((itemName+"."+_serviceName).c_str());
@@ -147,69 +96,307 @@ void MarketPriceHandler::sendRequest(const std::string &itemName, const std::str
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
-        _pOMMConsumer->reissueClient(it->first, &intSpec);
+        _pOMMConsumer->reissueClient(handle, &intSpec);
+    }
+}
+
+/*
+* Request an item through the scheduler, or at once when pacing is off.
+* Items already open are re-issued at once.
+*/
+void MarketPriceHandler::queueRequest(const std::string &itemName, const std::string &viewFIDs, const rfa::common::UInt8 &interactionType, int priority){
+    // release the names of removed items, some are dropped by the dispatch thread
+    _watchList.collect();
+    if(!_scheduler.isEnabled() || getHandle(itemName)) {
+        sendRequest(itemName, viewFIDs, interactionType);
+        return;
+    }
+
+    RequestScheduler::Request request;
+    request.itemName = itemName;
+    request.viewFIDs = viewFIDs;
+    request.interactionType = interactionType;
+    if(!_scheduler.enqueue(request, priority) && _debug) {
+        _log = "[MarketPriceHandler::queueRequest] Request is already queued or outstanding for: ";
+        _log.append((itemName+"."+_serviceName).c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+    pumpRequests();
+}
+
+/*
+* Send the queued requests the window lets through.
+*/
+void MarketPriceHandler::pumpRequests(){
+    RequestScheduler::Request request;
+    while(_scheduler.next(request))
+        sendRequest(request.itemName, request.viewFIDs, request.interactionType);
+}
+
+void MarketPriceHandler::setRequestWindow(size_t window, long timeout){
+    _scheduler.setWindow(window);
+    _scheduler.setTimeout(timeout);
+    pumpRequests();
+}
+
+const RequestScheduler &MarketPriceHandler::getScheduler() const{
+    return _scheduler;
+}
+
+/*
+* Request many items in one batch request message.
+* Items already in the watchlist are re-issued one by one, the rest are listed in :ItemList.
+* RFA hands over each item handle with its first response, see adoptItem.
+*/
+void MarketPriceHandler::sendBatchRequest(const std::vector<std::string> &itemNames, const std::string &viewFIDs, const rfa::common::UInt8 &interactionType){
+    const bool streaming = interactionType == (rfa::message::ReqMsg::InitialImageFlag | rfa::message::ReqMsg::InterestAfterRefreshFlag);
+    _watchList.collect();
+    std::vector<std::string> batchItems;
+    for(size_t i = 0; i < itemNames.size(); i++) {
+        if(getHandle(itemNames[i]))
+            sendRequest(itemNames[i], viewFIDs, interactionType);
+        else if(!_watchList.isPending(itemNames[i], _serviceName))
+            batchItems.push_back(itemNames[i]);
+    }
+    if(batchItems.empty())
+        return;
+
+    rfa::message::ReqMsg reqMsg;
+    rfa::message::AttribInfo attribInfo(true) ;
+
+    attribInfo.setNameType(rfa::rdm::INSTRUMENT_NAME_RIC);
+    attribInfo.setServiceName(_serviceName.c_str());
+    reqMsg.setAttribInfo(attribInfo);
+
+    reqMsg.setMsgModelType(rfa::rdm::MMT_MARKET_PRICE);
+    reqMsg.setInteractionType(interactionType);
+
+    rfa::data::ElementList elementList;
+    rfa::data::ElementListWriteIterator elwiter;
+    elwiter.start(elementList);
+    RDMUtils::encodeBatchItemList(batchItems, elwiter);
+    if(!viewFIDs.empty()) {
+        reqMsg.setIndicationMask(reqMsg.getIndicationMask() | rfa::message::ReqMsg::ViewFlag);
+        encodeView(viewFIDs, elwiter);
+    }
+    elwiter.complete();
+    reqMsg.setPayload(elementList);
+
+    rfa::sessionLayer::OMMItemIntSpec intSpec;
+    intSpec.setMsg( &reqMsg );
+
+    _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
+    _watchList.addBatch(_pHandle);
+    if(streaming) {
+        for(size_t i = 0; i < batchItems.size(); i++)
+            _watchList.addPending(batchItems[i], _serviceName);
+    }
+    if(_debug) {
+        _log = "[MarketPriceHandler::sendBatchRequest] Batch request for ";
+        _log.append((int)batchItems.size());
+        _log += " items from ";
+        _log.append(_serviceName.c_str());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+}
+
+/*
+* Register a batch requested item under the handle of its first response.
+* Return true if the response is to be dropped: it belongs to the batch request itself
+* or to an item closed while it was pending.
+*/
+bool MarketPriceHandler::adoptItem(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle){
+    if(_watchList.isBatch(handle)) {
+        if((respMsg.getHintMask() & rfa::message::RespMsg::RespStatusFlag) &&
+                respMsg.getRespStatus().getStreamState() == rfa::common::RespStatus::ClosedEnum)
+            _watchList.removeBatch(handle);
+        if(_debug) {
+            _log = "[MarketPriceHandler::processResponse] Batch request status: " + respMsg.getRespStatus().getStatusText();
+            _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+        }
+        return true;
+    }
+    bool cancelled = false;
+    if(!_watchList.find(handle) && (respMsg.getHintMask() & rfa::message::RespMsg::AttribInfoFlag))
+        _watchList.adopt(handle, respMsg.getAttribInfo().getName().c_str(), _serviceName, cancelled);
+    if(cancelled)
+        _pOMMConsumer->unregisterClient(handle);
+    return cancelled;
+}
+
+/*
+* Encode the ViewType and ViewData elements of a view on fields given by name or ID.
+*/
+void MarketPriceHandler::encodeView(const std::string &viewFIDs, rfa::data::ElementListWriteIterator &elwiter){
+    vector<string> viewFIDList;
+    boost::split(viewFIDList, viewFIDs, boost::is_any_of(","));
+    rfa::common::RFA_String fieldName;
+
+    const rfa::common::RFA_String n="ABCDEFDGHIJKLMNOPQRSTUVWXYZ_%#/*\xDE\xFE";
+    bool isFieldName=false;
+    rfa::common::Int32 fieldID;
+
+    rfa::data::ElementEntry element;
+    rfa::data::DataBuffer dataBuffer;
+
+    //Encode a ViewType
+    element.setName(rfa::rdm::ENAME_VIEW_TYPE);
+    dataBuffer.setUInt32(rfa::rdm::VT_FIELD_ID_LIST, DataBuffer::UInt32Enum);
+    element.setData(static_cast<const Data&>(dataBuffer));
+    elwiter.bind(element);
+
+    rfa::data::ArrayWriteIterator arrWIt;
+    rfa::data::Array elementData;
+    rfa::data::ArrayEntry arrayEntry;
+    element.clear();
+    arrWIt.start(elementData);
+
+    for(size_t i = 0; i < viewFIDList.size(); i++) {
+        if(viewFIDList[i].empty())
+            continue;
+        dataBuffer.clear();
+        arrayEntry.clear();
+        // check if given field is in fieldID or fieldName format (number or string)
+        fieldName = viewFIDList[i].c_str();
+        isFieldName = false;
+        for(unsigned int ii = 0; ii <= n.size(); ++ii) {
+            if(fieldName.toUpper().find(n.substr(ii,1)) >= 0) {
+                isFieldName = true;
+                break;
+            }
+        }
+        const RDMFieldDef* fieldDef = NULL;
+        if(isFieldName) {
+            fieldDef = _pDict->getFieldDef(fieldName.trimWhitespace().toUpper());
+            if(!fieldDef) {
+                continue;
+            }
+            fieldID = fieldDef->getFieldId();
+            dataBuffer.setInt32(fieldID);
+        } else {
+            dataBuffer.setFromString(fieldName.trimWhitespace(), DataBuffer::Int32Enum);
+        }
+        arrayEntry.setData(dataBuffer);
+        arrWIt.bind(arrayEntry);
     }
+    arrWIt.complete();
+
+    element.setName(rfa::rdm::ENAME_VIEW_DATA);
+    element.setData(static_cast<const Data&>(elementData));
+    elwiter.bind(element);
 }
 
 void MarketPriceHandler::closeRequest(const std::string &itemName){
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(getHandle(itemName));
-    if(it != _watchList.end()) {
+    // a batch requested item still waiting for its handle is closed with its first response
+    _watchList.cancelPending(itemName, _serviceName);
+    _scheduler.cancel(itemName);
+    rfa::common::Handle* handle = getHandle(itemName);
+    _conflator.removeItem(itemName, handle);
+    if(handle) {
         if(_debug) {
             _log = "[MarketPriceHandler::closeRequest] Close item subscription for: ";
-            _log.append(it->second.c_str());
+            _log.append(_watchList.find(handle)->watchName.c_str());
         }
-        _pOMMConsumer->unregisterClient(it->first);
-        _watchList.erase(it);
+        _pOMMConsumer->unregisterClient(handle);
+        _watchList.remove(handle);
+        _imageCache.remove(handle);
+        _refreshing.erase(handle);
         if(_debug) {
             _log += ". Watchlist size: ";
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
     }
+    // nobody gets the refresh of a closed item
+    if(_pCompletions)
+        _pCompletions->complete(CompletionRegistry::MarketPrice, itemName, false);
+    pumpRequests();
 }
 
 void MarketPriceHandler::closeAllRequest(){
     _pOMMConsumer->unregisterClient();
     _watchList.clear();
+    _scheduler.clear();
+    _imageCache.clear();
+    _conflator.clear();
+    _refreshing.clear();
+    if(_pCompletions)
+        _pCompletions->failAll(CompletionRegistry::MarketPrice);
     if(_debug) {
         _log = "[MarketPriceHandler::closeAllRequest] Close all item subscription.";
         _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
     }
 }
 
-void MarketPriceHandler::processResponse( const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out){
+void MarketPriceHandler::processResponse( const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out){
+    if(adoptItem(respMsg, handle))
+        return;
+
     dict d;
     std::string itemName = "";
     std::string itemServiceName = "";
-    itemName = getItemName(handle);
-    if (itemName.empty()) {
+    object ric;
+    object service;
+    const ItemInfo* item = _watchList.find(handle);
+    if (item) {
+        itemName = item->itemName;
+        itemServiceName = item->serviceName;
+        ric = item->getPyItemName();
+        service = item->getPyServiceName();
+    } else {
         itemName = respMsg.getAttribInfo().getName().c_str();
-    }
-    itemServiceName = getItemServiceName(handle);
-    if (itemServiceName.empty()) {
         itemServiceName = _serviceName;
+        ric = object(itemName);
+        service = object(itemServiceName);
     }
+    // columnar mode, images and updates of subscribed items go to the column buffer
+    const bool columnar = item && _columns.isEnabled();
+    // lazy mode, fields are decoded when Python reads them unless the cache or conflation needs them now
+    const bool lazy = _lazyDecode && !columnar && !_cacheImages && !_conflator.isEnabled();
+    object lazyEvent;
+
+    // the first part of a refresh of this item, it resets the image and the columns of the item
+    const bool first = respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && _refreshing.insert(handle).second;
 
     switch (respMsg.getRespType()){
         case rfa::message::RespMsg::RefreshEnum:
             if(_debug)
                 cout << "[MarketPriceHandler::processResponse] MarketPrice Refresh: " << itemName << "." << itemServiceName << endl;
 
+            // a refresh supersedes the updates conflation held back
+            if(item)
+                _conflator.drop(handle);
+
             // Notify that this is a refresh
-            if(_refreshCount == 0) {
+            if(first) {
                 dict preempt;
-                preempt["RIC"] = itemName;
-                preempt["SERVICE"] = itemServiceName;
-                preempt["MTYPE"] = "REFRESH";
-                out += boost::python::make_tuple(preempt);
+                _pDecodeTable->setItem(preempt, FieldDecodeTable::RicKey, ric);
+                _pDecodeTable->setItem(preempt, FieldDecodeTable::ServiceKey, service);
+                _pDecodeTable->setItem(preempt, FieldDecodeTable::MTypeKey, FieldDecodeTable::RefreshValue);
+                out.append(preempt);
             }
 
-            if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeMarketPrice(respMsg.getPayload(), d);
-                d["RIC"] = itemName;
-                d["SERVICE"] = itemServiceName;
-                d["MTYPE"] = "IMAGE";
+            if (columnar && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                appendColumns(respMsg, handle, itemName, first);
+            } else if (lazy && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                lazyEvent = newLazyUpdate(respMsg.getPayload(), ric, service, FieldDecodeTable::ImageValue);
+            } else if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
+                if(_fieldFilter.isEnabled())
+                    d = FieldDecodeTable::newDict(_fieldFilter.size() + 3);
+                else
+                    d = FieldDecodeTable::newDict(static_cast<const rfa::data::FieldList&>(respMsg.getPayload()), 3);
+                if(_cacheImages && item) {
+                    std::vector<FieldValue> fields;
+                    decodeMarketPrice(respMsg.getPayload(), fields);
+                    cacheImage(handle, fields, first);
+                    for(size_t i = 0; i < fields.size(); i++)
+                        _pDecodeTable->setField(d, fields[i]);
+                } else {
+                    decodeMarketPrice(respMsg.getPayload(), d);
+                }
+                _pDecodeTable->setItem(d, FieldDecodeTable::RicKey, ric);
+                _pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, service);
+                _pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, FieldDecodeTable::ImageValue);
             } else {
                 if(_debug) {
                     _log = "[MarketPriceHandler::processResponse] Empty Refresh.";
@@ -223,23 +410,48 @@ void MarketPriceHandler::processResponse( const rfa::message::RespMsg& respMsg,
                     _log = "[MarketPriceHandler::processResponse] Refresh Complete";
                     _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
                 }
-                _refreshCount = 0;
-            } else {
-                _refreshCount++;
+                _refreshing.erase(handle);
+                _scheduler.complete(itemName);
+                pumpRequests();
+                if(_pCompletions)
+                    _pCompletions->complete(CompletionRegistry::MarketPrice, itemName, true);
             }
 
-            out += boost::python::make_tuple(d);
+            if(!lazyEvent.is_none())
+                out.append(lazyEvent);
+            else if(!columnar)
+                out.append(d);
             break;
 
         case rfa::message::RespMsg::UpdateEnum:
             if(_debug)
                 cout << "[MarketPriceHandler::processResponse] MarketPrice Update: " << itemName << "." << itemServiceName << endl;
 
-            if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeMarketPrice(respMsg.getPayload(), d);
-                d["RIC"] = itemName;
-                d["SERVICE"] = itemServiceName;
-                d["MTYPE"] = "UPDATE";
+            if (columnar && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                appendColumns(respMsg, handle, itemName, false);
+            } else if (lazy && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                lazyEvent = newLazyUpdate(respMsg.getPayload(), ric, service, FieldDecodeTable::UpdateValue);
+            } else if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
+                if(_fieldFilter.isEnabled())
+                    d = FieldDecodeTable::newDict(_fieldFilter.size() + 3);
+                else
+                    d = FieldDecodeTable::newDict(static_cast<const rfa::data::FieldList&>(respMsg.getPayload()), 3);
+                if(item && (_cacheImages || _conflator.isEnabled())) {
+                    std::vector<FieldValue> fields;
+                    decodeMarketPrice(respMsg.getPayload(), fields);
+                    if(_cacheImages)
+                        cacheImage(handle, fields, false);
+                    // held back until the conflation interval of the item is over
+                    if(!conflateUpdate(respMsg, handle, itemName, fields))
+                        break;
+                    for(size_t i = 0; i < fields.size(); i++)
+                        _pDecodeTable->setField(d, fields[i]);
+                } else {
+                    decodeMarketPrice(respMsg.getPayload(), d);
+                }
+                _pDecodeTable->setItem(d, FieldDecodeTable::RicKey, ric);
+                _pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, service);
+                _pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, FieldDecodeTable::UpdateValue);
             } else {
                 if(_debug) {
                     _log = "[MarketPriceHandler::processResponse] Empty Update.";
@@ -247,26 +459,209 @@ void MarketPriceHandler::processResponse( const rfa::message::RespMsg& respMsg,
                 }
             }
 
-            out += boost::python::make_tuple(d);
+            if(!lazyEvent.is_none())
+                out.append(lazyEvent);
+            else if(!columnar)
+                out.append(d);
             break;
 
         case rfa::message::RespMsg::StatusEnum:
-            d["RIC"] = itemName;
-            d["SERVICE"] = itemServiceName;
-            d["MTYPE"] = "STATUS";
+            // deliver the updates conflation held back before the status
+            if(item) {
+                EventRecord *held = releaseConflated(handle, itemName, itemServiceName, boost::posix_time::microsec_clock::universal_time());
+                if(held) {
+                    dict u = FieldDecodeTable::newDict(held->fields.size() + 3);
+                    for(size_t i = 0; i < held->fields.size(); i++)
+                        _pDecodeTable->setField(u, held->fields[i]);
+                    _pDecodeTable->setItem(u, FieldDecodeTable::RicKey, ric);
+                    _pDecodeTable->setItem(u, FieldDecodeTable::ServiceKey, service);
+                    _pDecodeTable->setItem(u, FieldDecodeTable::MTypeKey, FieldDecodeTable::UpdateValue);
+                    out.append(u);
+                    delete held;
+                }
+            }
+            _pDecodeTable->setItem(d, FieldDecodeTable::RicKey, ric);
+            _pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, service);
+            _pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, FieldDecodeTable::StatusValue);
             d["TEXT"] = respMsg.getRespStatus().getStatusText().c_str();
             d["DATA_STATE"] = RDMUtils::dataStateToString(respMsg.getRespStatus().getDataState()).c_str();
             d["STREAM_STATE"] = RDMUtils::streamStateToString(respMsg.getRespStatus().getStreamState()).c_str();
             d["STATUS_CODE"] = RDMUtils::statusCodeToString(respMsg.getRespStatus().getStatusCode()).c_str();
-            out += boost::python::make_tuple(d);
+            out.append(d);
+            if(_debug)
+                cout << "[MarketPriceHandler::processResponse] MarketPrice Status: "<< respMsg.getRespStatus().getStatusText().c_str() << endl;
+            _log = "[MarketPriceHandler::processResponse] MarketPrice Status: " + respMsg.getRespStatus().getStatusText();
+            _componentLogger.log(LM_GENERIC_ONE,rfa::common::Warning,_log.c_str());
+            break;
+    }
+
+    // display subscription status
+    processStatus(respMsg, itemName);
+
+    // "out" is constructed to be Python list of dict
+    if(_debug && (len(out) > 0))
+        prettyPrint(out);
+}
+
+/*
+* Same as above but decodes into native records, without touching Python.
+* Used from the native dispatch thread.
+*/
+void MarketPriceHandler::processResponse( const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, std::vector<EventRecord*>& out){
+    if(adoptItem(respMsg, handle))
+        return;
+
+    std::string itemName = "";
+    std::string itemServiceName = "";
+    itemName = getItemName(handle);
+    if (itemName.empty()) {
+        itemName = respMsg.getAttribInfo().getName().c_str();
+    }
+    itemServiceName = getItemServiceName(handle);
+    if (itemServiceName.empty()) {
+        itemServiceName = _serviceName;
+    }
+
+    // columnar mode, images and updates of subscribed items go to the column buffer
+    const bool columnar = _columns.isEnabled() && _watchList.find(handle);
+    // lazy mode, only the encoded field list is copied
+    const bool lazy = _lazyDecode && !columnar && !_cacheImages && !_conflator.isEnabled();
+
+    EventRecord *record = new EventRecord();
+    record->msgModelType = rfa::rdm::MMT_MARKET_PRICE;
+
+    // the first part of a refresh of this item, it resets the image and the columns of the item
+    const bool first = respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && _refreshing.insert(handle).second;
+
+    switch (respMsg.getRespType()){
+        case rfa::message::RespMsg::RefreshEnum:
+            if(_debug)
+                cout << "[MarketPriceHandler::processResponse] MarketPrice Refresh: " << itemName << "." << itemServiceName << endl;
+
+            // a refresh supersedes the updates conflation held back
+            _conflator.drop(handle);
+
+            // Notify that this is a refresh
+            if(first) {
+                EventRecord *preempt = new EventRecord();
+                preempt->msgModelType = rfa::rdm::MMT_MARKET_PRICE;
+                preempt->itemName = itemName;
+                preempt->serviceName = itemServiceName;
+                preempt->mtype = "REFRESH";
+                out.push_back(preempt);
+            }
+
+            if (columnar && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                appendColumns(respMsg, handle, itemName, first);
+            } else if (lazy && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                const rfa::common::Buffer& buffer = respMsg.getPayload().getEncodedBuffer();
+                record->payload.assign(buffer.c_buf(), buffer.c_buf() + buffer.size());
+                record->itemName = itemName;
+                record->serviceName = itemServiceName;
+                record->mtype = "IMAGE";
+            } else if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
+                decodeMarketPrice(respMsg.getPayload(), record->fields);
+                if(_cacheImages && _watchList.find(handle))
+                    cacheImage(handle, record->fields, first);
+                record->itemName = itemName;
+                record->serviceName = itemServiceName;
+                record->mtype = "IMAGE";
+            } else {
+                if(_debug) {
+                    _log = "[MarketPriceHandler::processResponse] Empty Refresh.";
+                    _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+                }
+            }
+
+            // if refresh complete
+            if(respMsg.getIndicationMask() & rfa::message::RespMsg::RefreshCompleteFlag) {
+                if(_debug) {
+                    _log = "[MarketPriceHandler::processResponse] Refresh Complete";
+                    _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+                }
+                _refreshing.erase(handle);
+                _scheduler.complete(itemName);
+                pumpRequests();
+                if(_pCompletions)
+                    _pCompletions->complete(CompletionRegistry::MarketPrice, itemName, true);
+            }
+
+            if(columnar)
+                delete record;
+            else
+                out.push_back(record);
+            break;
+
+        case rfa::message::RespMsg::UpdateEnum:
+            if(_debug)
+                cout << "[MarketPriceHandler::processResponse] MarketPrice Update: " << itemName << "." << itemServiceName << endl;
+
+            if (columnar && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                appendColumns(respMsg, handle, itemName, false);
+            } else if (lazy && (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag)) {
+                const rfa::common::Buffer& buffer = respMsg.getPayload().getEncodedBuffer();
+                record->payload.assign(buffer.c_buf(), buffer.c_buf() + buffer.size());
+                record->itemName = itemName;
+                record->serviceName = itemServiceName;
+                record->mtype = "UPDATE";
+            } else if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
+                decodeMarketPrice(respMsg.getPayload(), record->fields);
+                if(_watchList.find(handle)) {
+                    if(_cacheImages)
+                        cacheImage(handle, record->fields, false);
+                    // held back until the conflation interval of the item is over
+                    if(!conflateUpdate(respMsg, handle, itemName, record->fields)) {
+                        delete record;
+                        break;
+                    }
+                }
+                record->itemName = itemName;
+                record->serviceName = itemServiceName;
+                record->mtype = "UPDATE";
+            } else {
+                if(_debug) {
+                    _log = "[MarketPriceHandler::processResponse] Empty Update.";
+                    _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+                }
+            }
+
+            if(columnar)
+                delete record;
+            else
+                out.push_back(record);
+            break;
+
+        case rfa::message::RespMsg::StatusEnum:
+            // deliver the updates conflation held back before the status
+            {
+                EventRecord *held = releaseConflated(handle, itemName, itemServiceName, boost::posix_time::microsec_clock::universal_time());
+                if(held)
+                    out.push_back(held);
+            }
+            record->itemName = itemName;
+            record->serviceName = itemServiceName;
+            record->mtype = "STATUS";
+            record->text = respMsg.getRespStatus().getStatusText().c_str();
+            record->dataState = RDMUtils::dataStateToString(respMsg.getRespStatus().getDataState());
+            record->streamState = RDMUtils::streamStateToString(respMsg.getRespStatus().getStreamState());
+            record->statusCode = RDMUtils::statusCodeToString(respMsg.getRespStatus().getStatusCode());
+            out.push_back(record);
             if(_debug)
                 cout << "[MarketPriceHandler::processResponse] MarketPrice Status: "<< respMsg.getRespStatus().getStatusText().c_str() << endl;
             _log = "[MarketPriceHandler::processResponse] MarketPrice Status: " + respMsg.getRespStatus().getStatusText();
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Warning,_log.c_str());
             break;
+
+        default:
+            delete record;
+            break;
     }
 
     // display subscription status
+    processStatus(respMsg, itemName);
+}
+
+void MarketPriceHandler::processStatus(const rfa::message::RespMsg& respMsg, const std::string &itemName) {
     if (respMsg.getHintMask() & rfa::message::RespMsg::RespStatusFlag) {
         const rfa::common::RespStatus& status = respMsg.getRespStatus();
 
@@ -283,32 +678,45 @@ void MarketPriceHandler::processResponse( const rfa::message::RespMsg& respMsg,
         _log += status.getStatusText();
         _log += "\"";
 
+        // the request is over in any other stream state, its window slot is free again
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum) {
+            _scheduler.cancel(itemName);
+            pumpRequests();
+        }
+
         // close item if streamState is closed
         if(status.getStreamState() == rfa::common::RespStatus::ClosedEnum) {
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
             closeRequest(itemName);
         }
 
+        // the refresh is not coming in any other stream state, a snapshot refresh aside
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum &&
+                !(respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && status.getStreamState() == rfa::common::RespStatus::NonStreamingEnum)) {
+            if(_pCompletions)
+                _pCompletions->complete(CompletionRegistry::MarketPrice, itemName, false);
+        }
+
         // Unspecified dataState
         if(status.getDataState() == rfa::common::RespStatus::UnspecifiedEnum) {
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
         }
     }
 
-    // "out" is constructed to be Python tuple and dict
-    if(_debug && (out != boost::python::tuple()))
-        prettyPrint(out);
+    // the slots of timed out requests
+    if(_scheduler.queued() > 0)
+        pumpRequests();
 }
 
-void MarketPriceHandler::prettyPrint(boost::python::tuple& inputTuple) {
+void MarketPriceHandler::prettyPrint(boost::python::list& inputList) {
     string out = "";
     out.append("(");
-    for ( int i = 0 ; i < len(inputTuple) ; i++ ) {
-        extract<dict>dictElement(inputTuple[i]);
+    for ( int i = 0 ; i < len(inputList) ; i++ ) {
+        extract<dict>dictElement(inputList[i]);
         //check whether the converted data is python dictionary
         if (dictElement.check()) {
             out.append("{");
-            dict dictElement = extract<dict>(inputTuple[i]);
+            dict dictElement = extract<dict>(inputList[i]);
             boost::python::list keys = (boost::python::list)dictElement.keys();
 
             for (int j = 0; j < len(keys); j++) {
@@ -345,7 +753,7 @@ void MarketPriceHandler::prettyPrint(boost::python::tuple& inputTuple) {
                 }
             }
             out.append("}");
-            if (i != len(inputTuple) - 1) {
+            if (i != len(inputList) - 1) {
                 out.append(",");
             }
         }
@@ -356,130 +764,220 @@ void MarketPriceHandler::prettyPrint(boost::python::tuple& inputTuple) {
 
 void MarketPriceHandler::decodeMarketPrice(const rfa::common::Data& data, dict &d){
 
-    // iterate thru field entries
-    const rfa::data::FieldList& fieldlist = static_cast<const rfa::data::FieldList&>(data);
-
-    rfa::data::FieldListReadIterator flri;
-    for (flri.start(fieldlist); !flri.off(); flri.forth())  {
-
-        const rfa::data::FieldEntry& field = flri.value();
-        const rfa::common::Int16 fieldID = field.getFieldID();
-        const RDMFieldDef* fieldDef = _pDict->getFieldDef(fieldID);
-        rfa::common::RFA_String fieldValue;
-
-        // if field name does not exist, use the field ID instead
-        // if no field definition then no dict then no dataType
-        if(!fieldDef) {
-            const rfa::common::UInt8 dataType = (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
-            const rfa::common::Data& fieldData = field.getData(dataType);
-            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-            d[fieldID] = fieldValue.trimWhitespace().c_str();
-        } else {
-            // convert to DataBuffer
-            const rfa::common::UInt8 dataType = fieldDef->getDataType();
-            const rfa::common::Data& fieldData = field.getData(dataType);
-            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-            const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
-            const RDMEnumDef* enumDef = 0;
-
-            //Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
-            //check and decode according to data buffer type
-            switch(dataBufferType) {
-                case rfa::data::DataBuffer::EnumerationEnum:
-                    enumDef = fieldDef->getEnumDef();
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer,enumDef).c_str();
-                    fieldValue.replace(fieldValue.find("\xde"), 1, "\xe2\x87\xa7");
-                    fieldValue.replace(fieldValue.find("\xfe"), 1, "\xe2\x87\xa9");
-                    d[fieldDef->getName().c_str()] = fieldValue.c_str();
-                    break;
-                case rfa::data::DataBuffer::FloatEnum:
-                case rfa::data::DataBuffer::DoubleEnum:
-                case rfa::data::DataBuffer::Real32Enum:
-                case rfa::data::DataBuffer::Real64Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        //d[fieldDef->getName().c_str()] = boost::python::object();
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToDouble(dataBuffer);
-                    }
-                    break;
-                case rfa::data::DataBuffer::Int32Enum:
-                case rfa::data::DataBuffer::UInt32Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToInt(dataBuffer);
-                    }
-                    break;
-                case rfa::data::DataBuffer::Int64Enum:
-                case rfa::data::DataBuffer::UInt64Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToLong(dataBuffer);
-                    }
-                    break;
-                default:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    d[fieldDef->getName().c_str()] = fieldValue.trimWhitespace().c_str();
-                    break;
-            }
-        }
+    // fields outside the projection are skipped before any conversion
+    FieldDecodeTable::DictSink sink(*_pDecodeTable, d, &_fieldFilter);
+    _pDecodeTable->decodeFieldList(static_cast<const rfa::data::FieldList&>(data), sink);
+}
+
+/*
+* Native twin of the decoder above, values are kept as C++ types
+* and turned into Python only when the record is drained.
+*/
+void MarketPriceHandler::decodeMarketPrice(const rfa::common::Data& data, std::vector<FieldValue> &fields, bool typedDateTime){
+
+    FieldDecodeTable::ValueSink sink(fields, &_fieldFilter, typedDateTime);
+    _pDecodeTable->decodeFieldList(static_cast<const rfa::data::FieldList&>(data), sink);
+}
+
+/*
+* Lazy mode: an image or an update as a LazyUpdate, the encoded field list is copied once.
+*/
+object MarketPriceHandler::newLazyUpdate(const rfa::common::Data& data, const object &ric, const object &service, FieldDecodeTable::FixedKey mtype){
+    const rfa::common::Buffer& buffer = data.getEncodedBuffer();
+    boost::shared_ptr<LazyUpdate> update(new LazyUpdate(buffer.c_buf(), buffer.size(), _pDict, _pDecodeTable, ric, service, mtype));
+    return object(update);
+}
+
+/*
+* Columnar mode: decode an image or an update of a subscribed item into a row of the column buffer.
+* Only the fields of the column set are decoded, unless the image cache or conflation needs them all.
+* Date and time fields are decoded to nanoseconds whatever the date/time mode.
+*/
+void MarketPriceHandler::appendColumns(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, const std::string &itemName, bool reset){
+    const bool update = respMsg.getRespType() == rfa::message::RespMsg::UpdateEnum;
+    const ColumnBuffer::RowType rowType = update ? ColumnBuffer::UpdateRow : ColumnBuffer::ImageRow;
+    if(_cacheImages || (update && _conflator.isEnabled())) {
+        std::vector<FieldValue> fields;
+        decodeMarketPrice(respMsg.getPayload(), fields, true);
+        if(_cacheImages)
+            cacheImage(handle, fields, reset);
+        if(update && !conflateUpdate(respMsg, handle, itemName, fields))
+            return;
+        _columns.append(itemName, rowType, fields);
+        return;
+    }
+
+    _columns.beginRow(itemName, rowType);
+    ColumnBuffer::Sink sink(_columns);
+    _pDecodeTable->decodeFieldList(static_cast<const rfa::data::FieldList&>(respMsg.getPayload()), sink);
+}
+
+/*
+* Merge decoded fields into the image of a subscribed item.
+* With merged updates the fields are replaced by the whole image.
+*/
+void MarketPriceHandler::cacheImage(rfa::common::Handle* handle, std::vector<FieldValue> &fields, bool reset){
+    _imageCache.merge(handle, fields, reset);
+    if(_mergeUpdates)
+        fields = *_imageCache.find(handle);
+}
+
+/*
+* Pass an update of a subscribed item through its conflation.
+* Return true if fields, merged with the updates held back before, are to be delivered now.
+*/
+bool MarketPriceHandler::conflateUpdate(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, const std::string &itemName, std::vector<FieldValue> &fields){
+    if(!_conflator.isEnabled())
+        return true;
+    const bool trade = respMsg.getRespTypeNum() == rfa::rdm::INSTRUMENT_UPDATE_TRADE;
+    return _conflator.update(handle, itemName, fields, trade, boost::posix_time::microsec_clock::universal_time());
+}
+
+/*
+* The updates held back for an item as one conflated update, 0 if there are none.
+*/
+EventRecord* MarketPriceHandler::releaseConflated(rfa::common::Handle* handle, const std::string &itemName, const std::string &serviceName, const boost::posix_time::ptime &now){
+    std::vector<FieldValue> fields;
+    if(!_conflator.release(handle, fields, now))
+        return 0;
+    if(_columns.isEnabled()) {
+        // columnar mode, the conflated update is a row rather than an event
+        _columns.append(itemName, ColumnBuffer::UpdateRow, fields);
+        return 0;
+    }
+    EventRecord *record = new EventRecord();
+    record->msgModelType = rfa::rdm::MMT_MARKET_PRICE;
+    record->itemName = itemName;
+    record->serviceName = serviceName;
+    record->mtype = "UPDATE";
+    record->fields.swap(fields);
+    return record;
+}
+
+/*
+* Conflate the updates of an item, interval in milliseconds, 0 to deliver every update.
+*/
+void MarketPriceHandler::setConflation(const std::string &itemName, long interval, long tradeCount){
+    _conflator.setItem(itemName, getHandle(itemName), interval, tradeCount);
+}
+
+/*
+* Release the conflated updates whose interval is over.
+*/
+void MarketPriceHandler::flushConflated(std::vector<EventRecord*>& out){
+    if(!_conflator.isEnabled())
+        return;
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    std::vector<rfa::common::Handle*> handles;
+    _conflator.due(now, handles);
+    for(size_t i = 0; i < handles.size(); i++) {
+        const ItemInfo* item = _watchList.find(handles[i]);
+        if(!item)
+            continue;
+        EventRecord *record = releaseConflated(handles[i], item->itemName, item->serviceName, now);
+        if(record)
+            out.push_back(record);
     }
 }
 
+const UpdateConflator &MarketPriceHandler::getConflator() const{
+    return _conflator;
+}
+
+/*
+* Decode the images and updates of subscribed items into columns of fields, no fields disables it.
+*/
+void MarketPriceHandler::setColumns(const std::vector<ColumnBuffer::Field> &fields, size_t capacity){
+    _columns.setFields(fields, capacity);
+}
+
+/*
+* Deliver images and updates as LazyUpdate objects, which decode a field when it is read.
+*/
+void MarketPriceHandler::setLazyDecode(bool lazy){
+    _lazyDecode = lazy;
+}
+
+/*
+* Decode only the given FIDs of images and updates, none decodes every field.
+*/
+void MarketPriceHandler::setFieldFilter(const std::vector<rfa::common::Int16> &fieldIds){
+    _fieldFilter.set(fieldIds);
+}
+
+/*
+* Move the rows decoded since the last call to rows, see ColumnBuffer::moveRows.
+* rows.take() then hands them to Python without the lock.
+*/
+void MarketPriceHandler::takeColumns(ColumnBuffer &rows){
+    _columns.moveRows(rows);
+}
+
 void MarketPriceHandler::setDebugMode(const bool &debug) {
     _debug = debug;
 }
 
-std::string MarketPriceHandler::getItemName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        if (strs.size() > 2) {
-            std::vector<std::string>::iterator strsit = strs.begin();
-            itemName = *strsit;
-            strsit++;
-            for (std::vector<std::string>::size_type i=1; i < strs.size()-1; i++) {
-                itemName = itemName + "." + *strsit;
-                strsit++;
-            }
-        } else {
-            itemName = strs[0];
+void MarketPriceHandler::setCompletions(CompletionRegistry *completions) {
+    _pCompletions = completions;
+}
+
+void MarketPriceHandler::setImageCache(bool enable, bool mergeUpdates) {
+    _cacheImages = enable;
+    _mergeUpdates = enable && mergeUpdates;
+    if(!enable)
+        _imageCache.clear();
+}
+
+/*
+* Copy of the cached image of a subscribed item, all fields or only the given FIDs.
+* Native, called with the market price lock held. false if the item has no image.
+*/
+bool MarketPriceHandler::getImage(const std::string &itemName, const std::vector<rfa::common::Int16> &fieldIds, LastValueCache::Image &fields, std::string &serviceName) {
+    rfa::common::Handle* handle = getHandle(itemName);
+    const LastValueCache::Image* image = handle ? _imageCache.find(handle) : 0;
+    if(!image)
+        return false;
+
+    if(fieldIds.empty()) {
+        fields = *image;
+    } else {
+        for(size_t i = 0; i < fieldIds.size(); i++) {
+            const FieldValue* value = LastValueCache::findField(*image, fieldIds[i]);
+            if(value)
+                fields.push_back(*value);
         }
     }
-    return itemName;
+    serviceName = _watchList.find(handle)->serviceName;
+    return true;
+}
+
+/*
+* An image copied by getImage() as a dict, without the lock.
+*/
+dict MarketPriceHandler::imageToDict(const std::string &itemName, const std::string &serviceName, const LastValueCache::Image &fields) const {
+    dict d = FieldDecodeTable::newDict(fields.size() + 3);
+    for(size_t i = 0; i < fields.size(); i++)
+        _pDecodeTable->setField(d, fields[i]);
+    _pDecodeTable->setItem(d, FieldDecodeTable::RicKey, itemName);
+    _pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, serviceName);
+    _pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, FieldDecodeTable::ImageValue);
+    return d;
+}
+
+std::string MarketPriceHandler::getItemName(rfa::common::Handle* handle) {
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->itemName : "";
 }
 
 std::string MarketPriceHandler::getItemServiceName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemServiceName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        itemServiceName = strs.back();
-    }
-    return itemServiceName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->serviceName : "";
 }
 
 rfa::common::Handle* MarketPriceHandler::getHandle(const std::string &itemName) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    for(it = _watchList.begin(); it != _watchList.end(); it++) {
-        if(it->second == itemName+"."+_serviceName) {
-            return it->first;
-        }
-    }
-    return NULL;
+    return _watchList.findHandle(itemName, _serviceName);
 }
 
-std::map<rfa::common::Handle*,std::string> &MarketPriceHandler::getWatchList() {
+ItemRegistry &MarketPriceHandler::getWatchList() {
     return _watchList;
 }
@@ -2,7 +2,18 @@
 #define MARKETPRICEHANDLER_H
 
 #include "StdAfx.h"
+#include "common/ItemRegistry.h"
+#include "common/Completion.h"
+#include "common/RequestScheduler.h"
+#include "common/EventRecord.h"
+#include "common/LastValueCache.h"
+#include "common/UpdateConflator.h"
+#include "common/ColumnBuffer.h"
+#include "common/FieldFilter.h"
+#include "common/FieldDecodeTable.h"
 #include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_set.hpp>
 
 class RDMFieldDict;
 
@@ -15,32 +26,71 @@ public:
                     rfa::common::EventQueue& eventQueue,
                     rfa::common::Client& client,
                     const std::string& serviceName,
-                    const RDMFieldDict* dict,
+                    const boost::shared_ptr<const RDMFieldDict>& dict,
+                    const boost::shared_ptr<const FieldDecodeTable>& decodeTable,
                     rfa::logger::ComponentLogger& componentLogger);
     ~MarketPriceHandler(void);
     void                                        sendRequest(const std::string &itemName, const std::string &viewFIDs, const rfa::common::UInt8 &interactionType);
+    void                                        queueRequest(const std::string &itemName, const std::string &viewFIDs, const rfa::common::UInt8 &interactionType, int priority);
+    void                                        sendBatchRequest(const std::vector<std::string> &itemNames, const std::string &viewFIDs, const rfa::common::UInt8 &interactionType);
     void                                        closeRequest(const std::string &itemName);
     void                                        closeAllRequest();
-    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, std::vector<EventRecord*>& out);
     std::string                                 getItemName(rfa::common::Handle* handle);
     std::string                                 getItemServiceName(rfa::common::Handle* handle);
     rfa::common::Handle*                        getHandle(const std::string &itemName);
     void                                        setDebugMode(const bool &debugLevel);
-    std::map<rfa::common::Handle*,std::string>  &getWatchList();
-    void                                        prettyPrint(boost::python::tuple& inputTuple);
+    // the completions waiting for refreshes of this handler
+    void                                        setCompletions(CompletionRegistry *completions);
+    ItemRegistry                                &getWatchList();
+    void                                        setRequestWindow(size_t window, long timeout);
+    const RequestScheduler                      &getScheduler() const;
+    void                                        setImageCache(bool enable, bool mergeUpdates);
+    bool                                        getImage(const std::string &itemName, const std::vector<rfa::common::Int16> &fieldIds, LastValueCache::Image &fields, std::string &serviceName);
+    dict                                        imageToDict(const std::string &itemName, const std::string &serviceName, const LastValueCache::Image &fields) const;
+    void                                        setConflation(const std::string &itemName, long interval, long tradeCount);
+    void                                        flushConflated(std::vector<EventRecord*>& out);
+    const UpdateConflator                       &getConflator() const;
+    void                                        setColumns(const std::vector<ColumnBuffer::Field> &fields, size_t capacity);
+    void                                        takeColumns(ColumnBuffer &rows);
+    void                                        setFieldFilter(const std::vector<rfa::common::Int16> &fieldIds);
+    void                                        setLazyDecode(bool lazy);
+    void                                        prettyPrint(boost::python::list& inputList);
 
 private:
+    void                                        encodeView(const std::string &viewFIDs, rfa::data::ElementListWriteIterator &elwiter);
+    void                                        pumpRequests();
+    bool                                        adoptItem(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle);
     void                                        decodeMarketPrice(const rfa::common::Data& data, dict &d);
+    void                                        decodeMarketPrice(const rfa::common::Data& data, std::vector<FieldValue> &fields, bool typedDateTime = false);
+    object                                      newLazyUpdate(const rfa::common::Data& data, const object &ric, const object &service, FieldDecodeTable::FixedKey mtype);
+    void                                        appendColumns(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, const std::string &itemName, bool reset);
+    void                                        cacheImage(rfa::common::Handle* handle, std::vector<FieldValue> &fields, bool reset);
+    bool                                        conflateUpdate(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, const std::string &itemName, std::vector<FieldValue> &fields);
+    EventRecord*                                releaseConflated(rfa::common::Handle* handle, const std::string &itemName, const std::string &serviceName, const boost::posix_time::ptime &now);
+    void                                        processStatus(const rfa::message::RespMsg& respMsg, const std::string &itemName);
     rfa::sessionLayer::OMMConsumer              *_pOMMConsumer;
     rfa::logger::ComponentLogger                &_componentLogger;
     rfa::common::EventQueue                     &_eventQueue;
     rfa::common::Client                         &_client;
     const std::string                           &_serviceName;
     rfa::common::Handle                         *_pHandle;
-    const RDMFieldDict*                         _pDict;
+    boost::shared_ptr<const RDMFieldDict>       _pDict;
+    boost::shared_ptr<const FieldDecodeTable>   _pDecodeTable;
     bool                                        _debug;
-    std::map<rfa::common::Handle*,std::string>  _watchList;
-    int                                         _refreshCount;
+    CompletionRegistry                          *_pCompletions;
+    ItemRegistry                                _watchList;
+    RequestScheduler                            _scheduler;
+    LastValueCache                              _imageCache;
+    bool                                        _cacheImages;
+    bool                                        _mergeUpdates;
+    UpdateConflator                             _conflator;
+    ColumnBuffer                                _columns;
+    FieldFilter                                 _fieldFilter;
+    bool                                        _lazyDecode;
+    // handles whose refresh is in progress, the first part of a refresh is not in here yet
+    boost::unordered_set<rfa::common::Handle*>  _refreshing;
     rfa::common::RFA_String                     _log;
 };
 #endif
@@ -213,7 +213,7 @@ void OMMInteractiveProvider::submitPostedData(RespMsg& respMsg,
 	}
 }
 
-void OMMInteractiveProvider::processReqMsg(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out) {
+void OMMInteractiveProvider::processReqMsg(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out) {
     const rfa::message::ReqMsg& msg = static_cast<const rfa::message::ReqMsg&>(event.getMsg());
 	if(!(msg.getInteractionType() & rfa::message::ReqMsg::InitialImageFlag) && !(msg.getInteractionType() & rfa::message::ReqMsg::InterestAfterRefreshFlag)) {
 		_log = "[OMMInteractiveProvider::processReqMsg] Received close item request (";
@@ -263,7 +263,7 @@ void OMMInteractiveProvider::processReqMsg(const rfa::sessionLayer::OMMSolicited
 
 //This application may choose to deny a login request by sending a Status RespMsg with the RespState.StreamState of Closed.
 //This application may force a logoff at any time by sending a Status RespMsg with a Closed StreamState.
-void OMMInteractiveProvider::processLoginReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out) {
+void OMMInteractiveProvider::processLoginReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out) {
     dict d;
     const rfa::message::ReqMsg& reqMsg = static_cast<const rfa::message::ReqMsg&>(event.getMsg());
 	_pLoginToken = &event.getRequestToken();
@@ -322,7 +322,7 @@ void OMMInteractiveProvider::processLoginReq(const rfa::sessionLayer::OMMSolicit
     d["USERNAME"] = reqAI.getName().c_str();
     d["SERVICE"] = _serviceName.c_str();
     d["SESSIONID"] = boost::lexical_cast<std::string>(reinterpret_cast<unsigned long>(pCSH));
-    out += boost::python::make_tuple(d);
+    out.append(d);
 }
 
 void OMMInteractiveProvider::processDirectoryReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event) {
@@ -459,7 +459,7 @@ void OMMInteractiveProvider::processDictionaryReq(const rfa::sessionLayer::OMMSo
 	}
 }
 
-void OMMInteractiveProvider::processMarketPriceReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out) {
+void OMMInteractiveProvider::processMarketPriceReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out) {
     dict d;
     const rfa::message::ReqMsg& reqMsg = static_cast<const rfa::message::ReqMsg&>(event.getMsg());
 	rfa::sessionLayer::RequestToken& rToken = event.getRequestToken();
@@ -513,7 +513,7 @@ void OMMInteractiveProvider::processMarketPriceReq(const rfa::sessionLayer::OMMS
         d["USERNAME"] = cwl->first()->attribInfo.getName().c_str();
         d["SERVICE"] = _serviceName.c_str();
         d["SESSIONID"] = boost::lexical_cast<std::string>(reinterpret_cast<unsigned long>(pCSH));
-        out += boost::python::make_tuple(d);
+        out.append(d);
 	}
 	else if ( reqMsg.getInteractionType() & ReqMsg::InitialImageFlag )
 	{
@@ -538,7 +538,7 @@ void OMMInteractiveProvider::processMarketPriceReq(const rfa::sessionLayer::OMMS
 	}
 }
 
-void OMMInteractiveProvider::processCloseReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out) {
+void OMMInteractiveProvider::processCloseReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out) {
     dict d;
 	rfa::sessionLayer::RequestToken& rToken = event.getRequestToken();
 	rfa::common::Handle* pCSH = event.getHandle();
@@ -561,7 +561,7 @@ void OMMInteractiveProvider::processCloseReq(const rfa::sessionLayer::OMMSolicit
         d["USERNAME"] = cwl->first()->attribInfo.getName().c_str();
         d["SERVICE"] = _serviceName.c_str();
         d["SESSIONID"] = boost::lexical_cast<std::string>(reinterpret_cast<unsigned long>(pCSH));
-        out += boost::python::make_tuple(d);
+        out.append(d);
 		cwl->removeToken( &rToken );
 	}
 	else
@@ -1076,7 +1076,7 @@ bool OMMInteractiveProvider::addClientWatchList(const rfa::common::Handle* pCSH)
     return result;
 }
 
-bool OMMInteractiveProvider::removeClientWatchList(const rfa::common::Handle* pCSH, boost::python::tuple& out) {
+bool OMMInteractiveProvider::removeClientWatchList(const rfa::common::Handle* pCSH, boost::python::list& out) {
     dict d;
     bool result = false;
     _providerWatchListLock.lock();
@@ -1088,7 +1088,7 @@ bool OMMInteractiveProvider::removeClientWatchList(const rfa::common::Handle* pC
     d["USERNAME"] = cwl->first()->attribInfo.getName().c_str();
     d["SERVICE"] = _serviceName.c_str();
     d["SESSIONID"] = boost::lexical_cast<std::string>(reinterpret_cast<unsigned long>(pCSH));
-    out += boost::python::make_tuple(d);
+    out.append(d);
     cwl->cleanup();
     
     result = _providerWatchList.removeClientWatchList(pCSH);
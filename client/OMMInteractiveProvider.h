@@ -100,7 +100,7 @@ public:
                            const RDMFieldDict* dict,
                            rfa::logger::ComponentLogger& componentLogger);
     ~OMMInteractiveProvider();
-    void    processReqMsg(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out);
+    void    processReqMsg(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out);
     void    processPostMsg(const rfa::sessionLayer::OMMSolicitedItemEvent& event);
     void    submitPostedData(rfa::message::RespMsg&,
                              const rfa::common::PrincipalIdentity&,
@@ -117,11 +117,11 @@ public:
                          rfa::message::AckMsg::NackCode nackcode,
                          const rfa::common::RFA_String& text,
                          rfa::common::UInt8 msgModelType);
-    void    processLoginReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out);
+    void    processLoginReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out);
     void    processDirectoryReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event);
     void    processDictionaryReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event);
-    void    processMarketPriceReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out);
-    void    processCloseReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::tuple& out);
+    void    processMarketPriceReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out);
+    void    processCloseReq(const rfa::sessionLayer::OMMSolicitedItemEvent& event, boost::python::list& out);
     
     void    submitData(const rfa::common::RFA_String& item, const rfa::common::RFA_Vector<rfa::common::RFA_String>& fieldList, int mType, const std::string& msgType, rfa::common::RFA_String& serviceName, const std::string& session="", const std::string& mapAction="", const std::string& mapKey="");
     void    directorySubmit(const UInt8 &mType, rfa::common::RFA_String& serviceName);
@@ -139,7 +139,7 @@ public:
     void    cleanup();
     
     bool    addClientWatchList(const rfa::common::Handle* pCSH);
-    bool    removeClientWatchList(const rfa::common::Handle* pCSH, boost::python::tuple& out);
+    bool    removeClientWatchList(const rfa::common::Handle* pCSH, boost::python::list& out);
     
     void    printClientWatchlists();
     std::string    getClientSessions();
@@ -9,6 +9,7 @@ SymbolListHandler::SymbolListHandler(rfa::sessionLayer::OMMConsumer* pOMMConsume
                                      rfa::common::Client& client,
                                      const std::string& serviceName,
                                      const RDMFieldDict* dict,
+                                     const FieldDecodeTable* decodeTable,
                                      rfa::logger::ComponentLogger& componentLogger):
 _pOMMConsumer(pOMMConsumer),
 _eventQueue(eventQueue),
@@ -16,12 +17,12 @@ _client(client),
 _pHandle(0),
 _serviceName(serviceName),
 _pDict(dict),
+_pDecodeTable(decodeTable),
 _isSymbolListRefreshComplete(true),
-_symbolList(0),
 _debug(false),
+_pCompletions(0),
 _log(""),
-_componentLogger(componentLogger),
-_refreshCount(0)
+_componentLogger(componentLogger)
 {
 }
 
@@ -29,7 +30,12 @@ _refreshCount(0)
 SymbolListHandler::~SymbolListHandler(void){}
 
 
-void SymbolListHandler::sendRequest(const std::string &itemName){
+/*
+* Subscribe to a symbol list. With members the list delivers the members added and
+* removed instead of a record per entry, with subscribe the members are queued for
+* subscription, see takeSubscriptions().
+*/
+void SymbolListHandler::sendRequest(const std::string &itemName, bool members, bool subscribe){
     rfa::message::ReqMsg reqMsg;
     rfa::message::AttribInfo attribInfo(true) ;
 
@@ -44,16 +50,12 @@ void SymbolListHandler::sendRequest(const std::string &itemName){
     rfa::sessionLayer::OMMItemIntSpec intSpec;
     intSpec.setMsg( &reqMsg );
 
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    std::pair<map<rfa::common::Handle*,std::string>::iterator,bool> ret;
-
-    it = _watchList.find(getHandle(itemName));
+    rfa::common::Handle* handle = getHandle(itemName);
 
     // If item already exists, re-issue the request
-    if(it == _watchList.end()) {
+    if(!handle) {
         _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
-        ret = _watchList.insert(  pair<rfa::common::Handle*,std::string>(_pHandle,itemName+"."+_serviceName) );
-        if(ret.second) {
+        if(_watchList.add(_pHandle, itemName, _serviceName)) {
             if(_debug) {
                 _log = "[SymbolListHandler::sendRequest] Add item subscription for: ";
                 _log.append((itemName+"."+_serviceName).c_str());
@@ -76,42 +78,71 @@ void SymbolListHandler::sendRequest(const std::string &itemName){
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
-        _pOMMConsumer->reissueClient(it->first, &intSpec);
+        _pOMMConsumer->reissueClient(handle, &intSpec);
     }
     _isSymbolListRefreshComplete = false;
-    // cache is clear when request is resent
-    _symbolList.clear();
+    // the members are kept, the refresh of a reissue is compared with them
+    SymbolList &symbolList = _symbolLists[itemName];
+    symbolList.members = members;
+    symbolList.subscribe = subscribe;
 }
 
 void SymbolListHandler::closeRequest(const std::string &itemName){
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(getHandle(itemName));
-    if(it != _watchList.end()) {
+    rfa::common::Handle* handle = getHandle(itemName);
+    if(handle) {
         if(_debug) {
             _log = "[SymbolListHandler::closeRequest] Close symbolList subscription for: ";
-            _log.append(it->second.c_str());
+            _log.append(_watchList.find(handle)->watchName.c_str());
+        }
+        _pOMMConsumer->unregisterClient(handle);
+        _watchList.remove(handle);
+        SymbolListIndex::iterator it = _symbolLists.find(itemName);
+        if(it != _symbolLists.end()) {
+            if(it->second.subscribe)
+                releaseMembers(it->second);
+            _symbolLists.erase(it);
         }
-        _pOMMConsumer->unregisterClient(it->first);
-        _watchList.erase(it);
         if(_debug) {
             _log += ". Watchlist size: ";
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
     }
+    // nobody gets the refresh of a closed item
+    if(_pCompletions)
+        _pCompletions->complete(CompletionRegistry::SymbolList, itemName, false);
     _isSymbolListRefreshComplete = true;
 }
 
+/*
+* Give up the members of an auto-subscribed list, those a refresh in progress
+* has not repeated yet too.
+*/
+void SymbolListHandler::releaseMembers(const SymbolList &symbolList){
+    _removed.insert(_removed.end(), symbolList.symbols.begin(), symbolList.symbols.end());
+    for(boost::unordered_set<std::string>::const_iterator it = symbolList.previous.begin(); it != symbolList.previous.end(); ++it) {
+        if(symbolList.symbols.find(*it) == symbolList.symbols.end())
+            _removed.push_back(*it);
+    }
+}
+
 void SymbolListHandler::closeAllRequest(){
     _pOMMConsumer->unregisterClient();
     _watchList.clear();
+    for(SymbolListIndex::const_iterator it = _symbolLists.begin(); it != _symbolLists.end(); ++it) {
+        if(it->second.subscribe)
+            releaseMembers(it->second);
+    }
+    _symbolLists.clear();
+    if(_pCompletions)
+        _pCompletions->failAll(CompletionRegistry::SymbolList);
     if(_debug) {
         _log = "[SymbolListHandler::closeAllRequest] Close all symbolList subscription.";
         _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
     }
 }
 
-void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out){
+void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out){
     std::string itemName = "";
     std::string itemServiceName = "";
     itemName = getItemName(handle);
@@ -122,6 +153,9 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
     if (itemServiceName.empty()) {
         itemServiceName = _serviceName;
     }
+    SymbolList &symbolList = _symbolLists[itemName];
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
 
     switch (respMsg.getRespType()){
         case rfa::message::RespMsg::RefreshEnum:
@@ -129,16 +163,19 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
                 cout << "[SymbolListHandler::processResponse] SymbolList Refresh: " << itemName << "." << itemServiceName << endl;
 
             // Notify that this is a refresh
-            if(_refreshCount == 0) {
+            if(!symbolList.refreshing) {
                 dict preempt;
                 preempt["RIC"] = itemName;
                 preempt["SERVICE"] = itemServiceName;
                 preempt["MTYPE"] = "REFRESH";
-                out += boost::python::make_tuple(preempt);
+                out.append(preempt);
+                symbolList.previous.swap(symbolList.symbols);
+                symbolList.symbols.clear();
+                symbolList.refreshing = true;
             }
 
             if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeSymbolList(respMsg.getPayload(), out, itemName, itemServiceName, "IMAGE");
+                decodeSymbolList(respMsg.getPayload(), out, itemName, itemServiceName, "IMAGE", symbolList, added, removed);
             } else {
                 if(_debug) {
                     _log = "[SymbolListHandler::processResponse] Empty Refresh.";
@@ -151,14 +188,21 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
                 if(_debug) {
                     _log = "[SymbolListHandler::processResponse] Refresh Complete \n";
                     _log += "[SymbolListHandler::processResponse] Total symbols in list: ";
-                    _log.append((int)_symbolList.size());
+                    _log.append((int)symbolList.symbols.size());
                     _log += "\n";
                     _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
                 }
-                _refreshCount = 0;
+                // members the refresh no longer has
+                for(boost::unordered_set<std::string>::const_iterator it = symbolList.previous.begin(); it != symbolList.previous.end(); ++it) {
+                    if(symbolList.symbols.find(*it) == symbolList.symbols.end())
+                        removed.push_back(*it);
+                }
+                symbolList.previous.clear();
+                symbolList.refreshing = false;
+                symbolList.received = true;
                 _isSymbolListRefreshComplete = true;
-            } else {
-                _refreshCount++;
+                if(_pCompletions)
+                    _pCompletions->complete(CompletionRegistry::SymbolList, itemName, true);
             }
             break;
 
@@ -167,7 +211,7 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
                 cout << "[SymbolListHandler::processResponse] SymbolList Update: " << itemName << "." << itemServiceName << endl;
 
             if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
-                decodeSymbolList(respMsg.getPayload(), out, itemName, itemServiceName, "UPDATE");
+                decodeSymbolList(respMsg.getPayload(), out, itemName, itemServiceName, "UPDATE", symbolList, added, removed);
             } else {
                 if(_debug) {
                     _log = "[SymbolListHandler::processResponse] Empty Update.";
@@ -185,7 +229,7 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
             d["DATA_STATE"] = RDMUtils::dataStateToString(respMsg.getRespStatus().getDataState()).c_str();
             d["STREAM_STATE"] = RDMUtils::streamStateToString(respMsg.getRespStatus().getStreamState()).c_str();
             d["STATUS_CODE"] = RDMUtils::statusCodeToString(respMsg.getRespStatus().getStatusCode()).c_str();
-            out += boost::python::make_tuple(d);
+            out.append(d);
             if(_debug)
                 cout << "[SymbolListHandler::processResponse] SymbolList Status: "<< respMsg.getRespStatus().getStatusText().c_str() << endl;
             _log = "[SymbolListHandler::processResponse] SymbolList Status: " + respMsg.getRespStatus().getStatusText();
@@ -193,6 +237,13 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
             break;
     }
 
+    if(symbolList.members && (!added.empty() || !removed.empty()))
+        publishMembers(out, itemName, itemServiceName, added, removed);
+    if(symbolList.subscribe) {
+        _added.insert(_added.end(), added.begin(), added.end());
+        _removed.insert(_removed.end(), removed.begin(), removed.end());
+    }
+
     // display subscription status
     if (respMsg.getHintMask() & rfa::message::RespMsg::RespStatusFlag) {
         const rfa::common::RespStatus& status = respMsg.getRespStatus();
@@ -216,26 +267,33 @@ void SymbolListHandler::processResponse(const rfa::message::RespMsg& respMsg, rf
             closeRequest(itemName);
         }
 
+        // the refresh is not coming in any other stream state, a snapshot refresh aside
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum &&
+                !(respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && status.getStreamState() == rfa::common::RespStatus::NonStreamingEnum)) {
+            if(_pCompletions)
+                _pCompletions->complete(CompletionRegistry::SymbolList, itemName, false);
+        }
+
         // Unspecified dataState
-        if(status.getDataState() != rfa::common::RespStatus::OkEnum) {
+        // a Suspect list keeps its members, the provider recovers the stream
+        if(status.getDataState() == rfa::common::RespStatus::UnspecifiedEnum) {
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
-            closeRequest(itemName);
         }
     }
 
-    if(_debug && (out != boost::python::tuple()))
+    if(_debug && (len(out) > 0))
         prettyPrint(out);
 }
 
-void SymbolListHandler::prettyPrint(boost::python::tuple& inputTuple) {
+void SymbolListHandler::prettyPrint(boost::python::list& inputList) {
     string out = "";
     out.append("(");
-    for ( int i = 0 ; i < len(inputTuple) ; i++ ) {
-        extract<dict>dictElement(inputTuple[i]);
+    for ( int i = 0 ; i < len(inputList) ; i++ ) {
+        extract<dict>dictElement(inputList[i]);
         //check whether the converted data is python dictionary
         if (dictElement.check()) {
             out.append("{");
-            dict dictElement = extract<dict>(inputTuple[i]);
+            dict dictElement = extract<dict>(inputList[i]);
             boost::python::list keys = (boost::python::list)dictElement.keys();
 
             for (int j = 0; j < len(keys); j++) {
@@ -272,7 +330,7 @@ void SymbolListHandler::prettyPrint(boost::python::tuple& inputTuple) {
                 }
             }
             out.append("}");
-            if (i != len(inputTuple) - 1) {
+            if (i != len(inputList) - 1) {
                 out.append(",");
             }
         }
@@ -281,15 +339,14 @@ void SymbolListHandler::prettyPrint(boost::python::tuple& inputTuple) {
     cout << out << endl;
 }
 
-void SymbolListHandler::decodeSymbolList(const rfa::common::Data& data, boost::python::tuple &out, const std::string &itemName, const std::string &serviceName, const std::string &mtype) {
+void SymbolListHandler::decodeSymbolList(const rfa::common::Data& data, boost::python::list& out, const std::string &itemName, const std::string &serviceName, const std::string &mtype, SymbolList &symbolList, std::vector<std::string> &added, std::vector<std::string> &removed) {
     dict d;
+    FieldDecodeTable::DictSink sink(*_pDecodeTable, d);
     std::string key = "";
     const rfa::data::Map& mapData = static_cast<const rfa::data::Map&>(data);
     // data is RFA update message
     if(mapData.getIndicationMask() & rfa::data::Map::EntriesFlag) {
         rfa::data::MapReadIterator mri;
-        const rfa::data::MapEntry & mapEntry = mri.value();
-        const rfa::common::Data & mapEntryData = mapEntry.getData();
         for(mri.start(mapData); !mri.off(); mri.forth()) {
             const rfa::data::MapEntry & entry = mri.value();
             const rfa::common::Data & keyData = entry.getKeyData();
@@ -326,16 +383,33 @@ void SymbolListHandler::decodeSymbolList(const rfa::common::Data& data, boost::p
                 continue;
             }
 
+            // a member is new or gone unless the refresh only repeats the members before it
+            switch (entry.getAction()) {
+                case rfa::data::MapEntry::Add:
+                    if(symbolList.symbols.insert(key).second &&
+                            (!symbolList.refreshing || symbolList.previous.find(key) == symbolList.previous.end()))
+                        added.push_back(key);
+                    break;
+                case rfa::data::MapEntry::Delete:
+                    if(symbolList.symbols.erase(key) &&
+                            (!symbolList.refreshing || symbolList.previous.find(key) == symbolList.previous.end()))
+                        removed.push_back(key);
+                    break;
+                default:
+                    break;
+            }
+            if(symbolList.members)
+                continue;
+
             switch (entry.getAction()) {
                 case rfa::data::MapEntry::Add:
-                    _symbolList.push_back(keyBuffer.getAsString().c_str());
                     d["SERVICE"] = serviceName.c_str();
                     d["RIC"] = itemName.c_str();
                     d["MTYPE"]= mtype.c_str();
                     d["ACTION"] = "ADD";
                     d["KEY"] = key;
-                    if(mapEntryData.getDataType() == rfa::data::FieldListEnum && !mapEntryData.isBlank())
-                        decodeFieldList(static_cast<const rfa::data::FieldList &>(mapEntryData), d);
+                    if(valueData.getDataType() == rfa::data::FieldListEnum && !valueData.isBlank())
+                        _pDecodeTable->decodeFieldList(static_cast<const rfa::data::FieldList &>(valueData), sink);
                     break;
                 case rfa::data::MapEntry::Update:
                     if(valueData.getDataType() != rfa::data::FieldListEnum) {
@@ -347,11 +421,10 @@ void SymbolListHandler::decodeSymbolList(const rfa::common::Data& data, boost::p
                     d["MTYPE"]= mtype.c_str();
                     d["ACTION"] = "UPDATE";
                     d["KEY"] = key;
-                    if(mapEntryData.getDataType() == rfa::data::FieldListEnum && !mapEntryData.isBlank())
-                        decodeFieldList(static_cast<const rfa::data::FieldList &>(mapEntryData), d);
+                    if(!valueData.isBlank())
+                        _pDecodeTable->decodeFieldList(static_cast<const rfa::data::FieldList &>(valueData), sink);
                     break;
                 case rfa::data::MapEntry::Delete:
-                    _symbolList.remove(keyBuffer.getAsString().c_str());
                     d["SERVICE"] = serviceName.c_str();
                     d["RIC"] = itemName.c_str();
                     d["MTYPE"]= mtype.c_str();
@@ -359,81 +432,29 @@ void SymbolListHandler::decodeSymbolList(const rfa::common::Data& data, boost::p
                     d["KEY"] = key;
                     break;
             }
-            out += boost::python::make_tuple(d);
+            out.append(d);
             d = dict();
         }
     }
 }
 
-void SymbolListHandler::decodeFieldList(const rfa::data::FieldList& fieldList, dict& d) {
-    rfa::data::FieldListReadIterator flri;
-    for(flri.start(fieldList); !flri.off(); flri.forth()) {
-        const rfa::data::FieldEntry& field = flri.value();
-        const rfa::common::Int16 fieldID = field.getFieldID();
-        const RDMFieldDef* fieldDef = _pDict->getFieldDef(fieldID);
-        rfa::common::RFA_String fieldValue;
-        // if field name does not exist, use the field ID instead
-        // if no field definition then no dict then no dataType
-        if(!fieldDef) {
-            const rfa::common::UInt8 dataType = (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
-            const rfa::common::Data& fieldData = field.getData(dataType);
-            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-            rfa::common::RFA_String fieldValue;
-            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-            d[fieldID] = fieldValue.trimWhitespace().c_str();
-
-        } else {
-            // convert to DataBuffer
-            const rfa::common::UInt8 dataType = fieldDef->getDataType();
-            const rfa::common::Data& fieldData = field.getData(dataType);
-            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-            const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
-            const RDMEnumDef* enumDef = 0;
-
-            //Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
-            //check and decode according to data buffer type
-            switch(dataBufferType) {
-                case rfa::data::DataBuffer::EnumerationEnum:
-                    enumDef = fieldDef->getEnumDef();
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer,enumDef).c_str();
-                    d[fieldDef->getName().c_str()] = fieldValue.c_str();
-                    break;
-                case rfa::data::DataBuffer::FloatEnum:
-                case rfa::data::DataBuffer::DoubleEnum:
-                case rfa::data::DataBuffer::Real32Enum:
-                case rfa::data::DataBuffer::Real64Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToDouble(dataBuffer);
-                    }
-                    break;
-                case rfa::data::DataBuffer::Int32Enum:
-                case rfa::data::DataBuffer::UInt32Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToInt(dataBuffer);
-                    }
-                    break;
-                case rfa::data::DataBuffer::Int64Enum:
-                case rfa::data::DataBuffer::UInt64Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToLong(dataBuffer);
-                    }
-                    break;
-                default:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    d[fieldDef->getName().c_str()] = fieldValue.trimWhitespace().c_str();
-                    break;
-            }
-        }
-    }
+/*
+* One MEMBERS record with the members a message added and removed.
+*/
+void SymbolListHandler::publishMembers(boost::python::list& out, const std::string &itemName, const std::string &serviceName, const std::vector<std::string> &added, const std::vector<std::string> &removed) {
+    boost::python::list addedList;
+    for(size_t i = 0; i < added.size(); i++)
+        addedList.append(added[i]);
+    boost::python::list removedList;
+    for(size_t i = 0; i < removed.size(); i++)
+        removedList.append(removed[i]);
+    dict d;
+    d["SERVICE"] = serviceName.c_str();
+    d["RIC"] = itemName.c_str();
+    d["MTYPE"] = "MEMBERS";
+    d["ADD"] = tuple(addedList);
+    d["DELETE"] = tuple(removedList);
+    out.append(d);
 }
 
 bool SymbolListHandler::isSymbolListRefreshComplete() const {
@@ -444,54 +465,41 @@ void SymbolListHandler::setDebugMode(const bool &debug) {
     _debug = debug;
 }
 
-const std::list<std::string>* SymbolListHandler::getSymbolList() const {
-    return &_symbolList;
+void SymbolListHandler::setCompletions(CompletionRegistry *completions) {
+    _pCompletions = completions;
+}
+
+const boost::unordered_set<std::string>* SymbolListHandler::getSymbolList(const std::string &itemName) const {
+    SymbolListIndex::const_iterator it = _symbolLists.find(itemName);
+    return it != _symbolLists.end() ? &it->second.symbols : 0;
+}
+
+bool SymbolListHandler::isRefreshComplete(const std::string &itemName) const {
+    SymbolListIndex::const_iterator it = _symbolLists.find(itemName);
+    return it != _symbolLists.end() && it->second.received;
+}
+
+void SymbolListHandler::takeSubscriptions(std::vector<std::string> &added, std::vector<std::string> &removed) {
+    added.swap(_added);
+    removed.swap(_removed);
+    _added.clear();
+    _removed.clear();
 }
 
 std::string SymbolListHandler::getItemName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        if (strs.size() > 2) {
-            std::vector<std::string>::iterator strsit = strs.begin();
-            itemName = *strsit;
-            strsit++;
-            for (std::vector<std::string>::size_type i=1; i < strs.size()-1; i++) {
-                itemName = itemName + "." + *strsit;
-                strsit++;
-            }
-        } else {
-            itemName = strs[0];
-        }
-    }
-    return itemName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->itemName : "";
 }
 
 std::string SymbolListHandler::getItemServiceName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemServiceName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        itemServiceName = strs.back();
-    }
-    return itemServiceName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->serviceName : "";
 }
 
 rfa::common::Handle* SymbolListHandler::getHandle(const std::string &itemName) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    for(it = _watchList.begin(); it != _watchList.end(); it++) {
-        if(it->second == itemName+"."+_serviceName) {
-            return it->first;
-        }
-    }
-    return NULL;
+    return _watchList.findHandle(itemName, _serviceName);
 }
 
-std::map<rfa::common::Handle*,std::string> &SymbolListHandler::getWatchList() {
+ItemRegistry &SymbolListHandler::getWatchList() {
     return _watchList;
 }
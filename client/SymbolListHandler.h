@@ -2,12 +2,25 @@
 #define SYMBOLLISTHANDLER_H
 
 #include "StdAfx.h"
+#include "common/ItemRegistry.h"
+#include "common/Completion.h"
+#include "common/FieldDecodeTable.h"
 #include <boost/python.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <string>
+#include <vector>
 
 class RDMFieldDict;
 
 using namespace boost::python;
 
+/*
+* Symbol list subscriptions. The members of every list are kept in a hash set, map
+* ADD and DELETE entries are applied as they come and a refresh is compared with the
+* members before it. In members mode a list delivers the members added and removed
+* instead of a record per entry.
+*/
 class SymbolListHandler
 {
 public:
@@ -16,36 +29,62 @@ public:
                     rfa::common::Client& client,
                     const std::string& serviceName, 
                     const RDMFieldDict* dict,
+                    const FieldDecodeTable* decodeTable,
                     rfa::logger::ComponentLogger& componentLogger);
     ~SymbolListHandler(void);
-    void                                        sendRequest(const std::string &itemName);
+    void                                        sendRequest(const std::string &itemName, bool members, bool subscribe);
     void                                        closeRequest(const std::string &itemName);
     void                                        closeAllRequest();
-    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out);
     std::string                                 getItemName(rfa::common::Handle* handle);
     std::string                                 getItemServiceName(rfa::common::Handle* handle);
     bool                                        isSymbolListRefreshComplete() const;
     rfa::common::Handle*                        getHandle(const std::string &itemName);
     void                                        setDebugMode(const bool &debugLevel);
-    const std::list<std::string>*               getSymbolList() const;
-    void                                        prettyPrint(boost::python::tuple& inputTuple);
-    std::map<rfa::common::Handle*,std::string>  &getWatchList();
+    // the completions waiting for refreshes of this handler
+    void                                        setCompletions(CompletionRegistry *completions);
+    // 0 if the list is not requested
+    const boost::unordered_set<std::string>*    getSymbolList(const std::string &itemName) const;
+    // a complete refresh of the list came
+    bool                                        isRefreshComplete(const std::string &itemName) const;
+    // members of the auto-subscribed lists added and removed since the last call
+    void                                        takeSubscriptions(std::vector<std::string> &added, std::vector<std::string> &removed);
+    void                                        prettyPrint(boost::python::list& inputList);
+    ItemRegistry                                &getWatchList();
 
 private:
-    void                                        decodeSymbolList(const rfa::common::Data& data, boost::python::tuple &out, const std::string &itemName, const std::string &serviceName, const std::string &mtype);
-    void                                        decodeFieldList(const rfa::data::FieldList& fieldList, dict& d);
+    struct SymbolList
+    {
+        SymbolList() : members(false), subscribe(false), refreshing(false), received(false) {}
+
+        bool                                    members;
+        bool                                    subscribe;
+        bool                                    refreshing;     // previous holds the members before the refresh
+        bool                                    received;       // a complete refresh came
+        boost::unordered_set<std::string>       symbols;
+        boost::unordered_set<std::string>       previous;
+    };
+
+    typedef boost::unordered_map<std::string, SymbolList>   SymbolListIndex;
+
+    void                                        decodeSymbolList(const rfa::common::Data& data, boost::python::list& out, const std::string &itemName, const std::string &serviceName, const std::string &mtype, SymbolList &symbolList, std::vector<std::string> &added, std::vector<std::string> &removed);
+    void                                        releaseMembers(const SymbolList &symbolList);
+    void                                        publishMembers(boost::python::list& out, const std::string &itemName, const std::string &serviceName, const std::vector<std::string> &added, const std::vector<std::string> &removed);
     rfa::sessionLayer::OMMConsumer              *_pOMMConsumer;
     rfa::common::EventQueue                     &_eventQueue;
     rfa::common::Client                         &_client;
     rfa::common::Handle                         *_pHandle;
     const std::string                           &_serviceName;
     const RDMFieldDict                          *_pDict;
+    const FieldDecodeTable                      *_pDecodeTable;
     bool                                        _isSymbolListRefreshComplete;
-    std::list<std::string>                      _symbolList; // cache symbolList response in _symbolList
+    SymbolListIndex                             _symbolLists;
     bool                                        _debug;
+    CompletionRegistry                          *_pCompletions;
     rfa::common::RFA_String                     _log;
     rfa::logger::ComponentLogger                &_componentLogger;
-    std::map<rfa::common::Handle*,std::string>  _watchList;
-    int                                         _refreshCount;
+    ItemRegistry                                _watchList;
+    std::vector<std::string>                    _added;
+    std::vector<std::string>                    _removed;
 };
 #endif
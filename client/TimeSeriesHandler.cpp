@@ -1,8 +1,13 @@
 #include "common/RDMUtils.h"
 #include "common/RDMDict.h"
+#include "common/FieldDecodeTable.h"
 
 #include "TimeSeriesHandler.h"
+#include "common/ColumnBuffer.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <cstring>
+#include <limits>
 
 using namespace rfa::data;
 
@@ -11,6 +16,7 @@ TimeSeriesHandler::TimeSeriesHandler(rfa::sessionLayer::OMMConsumer* pOMMConsume
                                        rfa::common::Client& client,
                                        const std::string& serviceName,
                                        const RDMFieldDict* dict,
+                                       const FieldDecodeTable* decodeTable,
                                        rfa::logger::ComponentLogger& componentLogger,
                                        rfa::ts1::TS1DefDb& TS1DictDb):
 _pOMMConsumer(pOMMConsumer),
@@ -19,20 +25,77 @@ _eventQueue(eventQueue),
 _client(client),
 _serviceName(serviceName),
 _pDict(dict),
+_pDecodeTable(decodeTable),
 _debug(false),
+_pCompletions(0),
 _TS1DictDb(TS1DictDb),
-_pTimeSeries(0),
-_timeSeries(0),
+_definitionRequested(false),
 _numberOfDictParsed(0),
-_numberOfTimeSeriesRefreshParsed(0),
-_isTimeSeriesParseComplete(true),
 _log("")
 {
 }
 
 
-TimeSeriesHandler::~TimeSeriesHandler(void){}
+TimeSeriesHandler::~TimeSeriesHandler(void){
+    for(SeriesIndex::iterator it = _series.begin(); it != _series.end(); ++it)
+        destroySeries(it->second);
+}
+
+/*
+* Queue the series of an item. The TS1 database RICs are requested with the first series,
+* a series already requested starts over.
+*/
+void TimeSeriesHandler::requestSeries(const std::string &itemName, rfa::ts1::TS1Series::Period period){
+    if(!_definitionRequested) {
+        _definitionRequested = true;
+        for(int i=0; i < _TS1DictDb.getNumberDbRics(); ++i)
+            sendRequest(_TS1DictDb.getTs1DbRics(i));
+    }
+
+    if(_series.find(itemName) != _series.end())
+        closeSeries(itemName);
+    Series &series = _series[itemName];
+    series.pSeries = rfa::ts1::TS1Series::createSeries(itemName.c_str(), period);
+
+    RequestScheduler::Request request;
+    request.itemName = itemName;
+    request.interactionType = rfa::message::ReqMsg::InitialImageFlag;
+    _scheduler.enqueue(request, 0);
+    pumpRequests();
+}
+
+/*
+* Start the queued series the concurrency limit lets through.
+*/
+void TimeSeriesHandler::pumpRequests(){
+    RequestScheduler::Request request;
+    while(_scheduler.next(request)) {
+        SeriesIndex::iterator it = _series.find(request.itemName);
+        if(it != _series.end())
+            startSeries(it->first, it->second);
+        else
+            _scheduler.complete(request.itemName);
+    }
+}
+
+void TimeSeriesHandler::startSeries(const std::string &itemName, Series &series){
+    if(_debug) {
+        _log = "[TimeSeriesHandler::startSeries] Request series of: ";
+        _log.append(itemName.c_str());
+        _log += ". Series outstanding: ";
+        _log.append((int)_scheduler.outstanding());
+        _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
+    }
+    requestRic(itemName, series, series.pSeries->getPrimaryRic());
+}
 
+void TimeSeriesHandler::requestRic(const std::string &itemName, Series &series, const std::string &ric){
+    _itemOfRic[ric] = itemName;
+    series.rics.push_back(ric);
+    sendRequest(ric);
+    if(!getHandle(ric))
+        completeSeries(itemName, series, false);
+}
 
 void TimeSeriesHandler::sendRequest(const std::string &itemName){
     rfa::message::ReqMsg reqMsg;
@@ -52,16 +115,14 @@ void TimeSeriesHandler::sendRequest(const std::string &itemName){
     rfa::sessionLayer::OMMItemIntSpec intSpec;
     intSpec.setMsg( &reqMsg );
 
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    std::pair<map<rfa::common::Handle*,std::string>::iterator,bool> ret;
-
-    it = _watchList.find(getHandle(itemName));
+    rfa::common::Handle* handle = getHandle(itemName);
 
     // If item already exists, re-issue the request
-    if(it == _watchList.end()) {
+    if(!handle) {
         _pHandle = _pOMMConsumer->registerClient(&_eventQueue, &intSpec, _client);
-        ret = _watchList.insert(  pair<rfa::common::Handle*,std::string>(_pHandle,itemName+"."+_serviceName) );
-        if(ret.second) {
+        if(_watchList.add(_pHandle, itemName, _serviceName)) {
+            CMutex::CGuard guard(_handleMutex);
+            _handles.insert(_pHandle);
             if(_debug) {
                 _log = "[TimeSeriesHandler::sendRequest] Add item subscription for: ";
                 _log.append((itemName+"."+_serviceName).c_str());
@@ -69,7 +130,7 @@ void TimeSeriesHandler::sendRequest(const std::string &itemName){
         } else {
             _log = "[TimeSeriesHandler::sendRequest] Watchlist insertion failed.";
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
-            _isTimeSeriesParseComplete = true;
+            _pOMMConsumer->unregisterClient(_pHandle);
             return;
         }
         if(_debug) {
@@ -85,42 +146,115 @@ void TimeSeriesHandler::sendRequest(const std::string &itemName){
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
-        _pOMMConsumer->reissueClient(it->first, &intSpec);
+        _pOMMConsumer->reissueClient(handle, &intSpec);
     }
 }
 
 void TimeSeriesHandler::closeRequest(const std::string &itemName){
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(getHandle(itemName));
-    if(it != _watchList.end()) {
+    rfa::common::Handle* handle = getHandle(itemName);
+    if(handle) {
         if(_debug) {
             _log = "[TimeSeriesHandler::closeRequest] Close item subscription for: ";
-            _log.append(it->second.c_str());
+            _log.append(_watchList.find(handle)->watchName.c_str());
+        }
+        _pOMMConsumer->unregisterClient(handle);
+        _watchList.remove(handle);
+        {
+            CMutex::CGuard guard(_handleMutex);
+            _handles.erase(handle);
         }
-        _pOMMConsumer->unregisterClient(it->first);
-        _watchList.erase(it);
         if(_debug) {
             _log += ". Watchlist size: ";
             _log.append((int)_watchList.size());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
         }
     }
-    _isTimeSeriesParseComplete = true;
-    _numberOfTimeSeriesRefreshParsed = 0;
+}
+
+/*
+* Close the series of an item and drop its records. A series still outstanding fails.
+*/
+void TimeSeriesHandler::closeSeries(const std::string &itemName){
+    SeriesIndex::iterator it = _series.find(itemName);
+    if(it == _series.end())
+        return;
+
+    Series &series = it->second;
+    for(size_t i = 0; i < series.rics.size(); i++) {
+        closeRequest(series.rics[i]);
+        _itemOfRic.erase(series.rics[i]);
+    }
+    if(!series.complete && _pCompletions)
+        _pCompletions->complete(CompletionRegistry::TimeSeries, itemName, false);
+    destroySeries(series);
+    _scheduler.cancel(itemName);
+    _series.erase(it);
+    pumpRequests();
 }
 
 void TimeSeriesHandler::closeAllRequest(){
-    _pOMMConsumer->unregisterClient();
-    _watchList.clear();
+    // the TS1 database RICs stay cached
+    std::vector<std::string> items;
+    for(SeriesIndex::const_iterator it = _series.begin(); it != _series.end(); ++it)
+        items.push_back(it->first);
+    for(size_t i = 0; i < items.size(); i++)
+        closeSeries(items[i]);
     if(_debug) {
         _log = "[TimeSeriesHandler::closeAllRequest] Close all item subscription.";
         _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
     }
-    _isTimeSeriesParseComplete = true;
-    _numberOfTimeSeriesRefreshParsed = 0;
 }
 
-void TimeSeriesHandler::processResponse( const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out){
+void TimeSeriesHandler::destroySeries(Series &series){
+    if(series.pSeries) {
+        series.pSeries->destroy();
+        series.pSeries = 0;
+    }
+}
+
+/*
+* A series is complete once all its TS1 RICs are parsed and the TS1 database is.
+*/
+void TimeSeriesHandler::checkComplete(const std::string &itemName, Series &series){
+    if(!series.complete && (series.parsed > 0) && (series.parsed >= series.pSeries->getRicCounts()) && isDefinitionComplete())
+        completeSeries(itemName, series, true);
+}
+
+void TimeSeriesHandler::completeSeries(const std::string &itemName, Series &series, bool ok){
+    if(series.complete)
+        return;
+    series.complete = true;
+    series.ok = ok;
+
+    // the TS1 RICs are snapshots, their streams are done
+    for(size_t i = 0; i < series.rics.size(); i++) {
+        closeRequest(series.rics[i]);
+        _itemOfRic.erase(series.rics[i]);
+    }
+    series.rics.clear();
+
+    if(_pCompletions)
+        _pCompletions->complete(CompletionRegistry::TimeSeries, itemName, ok);
+    _scheduler.complete(itemName);
+    pumpRequests();
+}
+
+/*
+* A TS1 database page is parsed, the series parsed meanwhile were waiting for the definitions.
+*/
+void TimeSeriesHandler::definitionParsed(){
+    _numberOfDictParsed++;
+    if(!isDefinitionComplete())
+        return;
+    for(SeriesIndex::iterator it = _series.begin(); it != _series.end(); ++it)
+        checkComplete(it->first, it->second);
+}
+
+bool TimeSeriesHandler::isDefinitionComplete() const {
+    return _definitionRequested && (_numberOfDictParsed >= _TS1DictDb.getNumberDbRics());
+}
+
+void TimeSeriesHandler::processResponse( const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out){
     dict d;
     std::string itemName = "";
     std::string itemServiceName = "";
@@ -133,6 +267,17 @@ void TimeSeriesHandler::processResponse( const rfa::message::RespMsg& respMsg, r
         itemServiceName = _serviceName;
     }
 
+    // series of the TS1 RIC, none for the TS1 database RICs
+    std::string seriesName;
+    Series *pSeries = 0;
+    boost::unordered_map<std::string, std::string>::const_iterator owner = _itemOfRic.find(itemName);
+    if(owner != _itemOfRic.end()) {
+        seriesName = owner->second;
+        SeriesIndex::iterator it = _series.find(seriesName);
+        if(it != _series.end())
+            pSeries = &it->second;
+    }
+
     switch (respMsg.getRespType()){
         case rfa::message::RespMsg::RefreshEnum:
             if(_debug)
@@ -141,19 +286,23 @@ void TimeSeriesHandler::processResponse( const rfa::message::RespMsg& respMsg, r
             if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
                 if (_TS1DictDb.hasTS1DbRics(respMsg.getAttribInfo().getName().c_str())) {
                     decodeMarketPrice(respMsg.getPayload(), d);
-                    _numberOfDictParsed++;
-
-                } else {
-                    decodeTimeSeries(respMsg, d);
-                    _numberOfTimeSeriesRefreshParsed++;
+                    definitionParsed();
+                } else if(pSeries && !pSeries->complete) {
+                    if(decodeTimeSeries(respMsg, seriesName, *pSeries, d)) {
+                        pSeries->parsed++;
+                        checkComplete(seriesName, *pSeries);
+                    } else {
+                        completeSeries(seriesName, *pSeries, false);
+                    }
                 }
-                out += boost::python::make_tuple(respMsg.getAttribInfo().getServiceName().c_str(), respMsg.getAttribInfo().getName().c_str(), boost::python::make_tuple(d));
+                out.extend(boost::python::make_tuple(respMsg.getAttribInfo().getServiceName().c_str(), respMsg.getAttribInfo().getName().c_str(), boost::python::make_tuple(d)));
             } else {
                 if(_debug) {
                     _log = "[TimeSeriesHandler::processResponse] Empty Refresh.";
                     _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
                 }
-                _isTimeSeriesParseComplete = true;
+                if(pSeries)
+                    completeSeries(seriesName, *pSeries, false);
             }
             break;
 
@@ -164,17 +313,17 @@ void TimeSeriesHandler::processResponse( const rfa::message::RespMsg& respMsg, r
             if (respMsg.getHintMask() & rfa::message::RespMsg::PayloadFlag) {
                 if (_TS1DictDb.hasTS1DbRics(respMsg.getAttribInfo().getName().c_str())) {
                     decodeMarketPrice(respMsg.getPayload(), d);
-                } else {
-                    decodeTimeSeries(respMsg, d);
+                } else if(pSeries && !pSeries->complete) {
+                    if(!decodeTimeSeries(respMsg, seriesName, *pSeries, d))
+                        completeSeries(seriesName, *pSeries, false);
                 }
             } else {
                 if(_debug) {
                     _log = "[TimeSeriesHandler::processResponse] Empty Update.";
                     _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
                 }
-                _isTimeSeriesParseComplete = true;
             }
-            out += boost::python::make_tuple(respMsg.getAttribInfo().getServiceName().c_str(),respMsg.getAttribInfo().getName().c_str(), boost::python::make_tuple(d));
+            out.extend(boost::python::make_tuple(respMsg.getAttribInfo().getServiceName().c_str(),respMsg.getAttribInfo().getName().c_str(), boost::python::make_tuple(d)));
             break;
 
         case rfa::message::RespMsg::StatusEnum:
@@ -208,30 +357,41 @@ void TimeSeriesHandler::processResponse( const rfa::message::RespMsg& respMsg, r
             closeRequest(itemName);
         }
 
+        // the refresh is not coming in any other stream state, a snapshot refresh aside
+        if(status.getStreamState() != rfa::common::RespStatus::OpenEnum &&
+                !(respMsg.getRespType() == rfa::message::RespMsg::RefreshEnum && status.getStreamState() == rfa::common::RespStatus::NonStreamingEnum)) {
+            if(pSeries) {
+                completeSeries(seriesName, *pSeries, false);
+            } else if(_TS1DictDb.hasTS1DbRics(itemName.c_str()) && !isDefinitionComplete()) {
+                // the series do without the definitions of this page
+                definitionParsed();
+            }
+        }
+
         // Unspecified dataState
         if(status.getDataState() == rfa::common::RespStatus::UnspecifiedEnum) {
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
         }
     }
 
-    if(_debug && (out != boost::python::tuple()))
+    if(_debug && (len(out) > 0))
         prettyPrint(out);
 }
 
-void TimeSeriesHandler::prettyPrint(boost::python::tuple& inputTuple) {
+void TimeSeriesHandler::prettyPrint(boost::python::list& inputList) {
     bool _isFirstElement = true;
     string out = "";
     out.append("(");
-    for ( int i = 0 ; i < len(inputTuple) ; i++ ) {
+    for ( int i = 0 ; i < len(inputList) ; i++ ) {
         //cout << "out = " << out;
         if (_isFirstElement) {
             out.append("(");
             _isFirstElement = false;
         }
-        extract<string>strElement(inputTuple[i]);
+        extract<string>strElement(inputList[i]);
 
         if (!strElement.check()) {
-            boost::python::tuple tupElement = extract<boost::python::tuple>(inputTuple[i]);
+            boost::python::tuple tupElement = extract<boost::python::tuple>(inputList[i]);
             out.append("(");
 
             for ( int ii = 0 ; ii < len(tupElement) ; ii++ ) {
@@ -297,7 +457,7 @@ void TimeSeriesHandler::prettyPrint(boost::python::tuple& inputTuple) {
         }
         //check whether the converted data is python dictionary
 
-        if (i != len(inputTuple) - 1) {
+        if (i != len(inputList) - 1) {
             out.append(",");
         }
     }
@@ -310,82 +470,21 @@ void TimeSeriesHandler::decodeMarketPrice(const rfa::common::Data& data, dict &d
     // iterate thru field entries
     const rfa::data::FieldList& fieldlist = static_cast<const rfa::data::FieldList&>(data);
 
+    FieldDecodeTable::DictSink sink(*_pDecodeTable, d);
     rfa::data::FieldListReadIterator flri;
     for (flri.start(fieldlist); !flri.off(); flri.forth())  {
 
         const rfa::data::FieldEntry& field = flri.value();
         const rfa::common::Int16 fieldID = field.getFieldID();
-        const RDMFieldDef* fieldDef = _pDict->getFieldDef(fieldID);
-        rfa::common::RFA_String fieldValue;
-
-        // if no field definition then no dict then no dataType
-        if(!fieldDef) {
-            const rfa::common::UInt8 dataType = (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
-            const rfa::common::Data& fieldData = field.getData(dataType);
-            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-            fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-            d[fieldID] = fieldValue.trimWhitespace().c_str();
-        } else {
-            // convert to DataBuffer
-            const rfa::common::UInt8 dataType = fieldDef->getDataType();
-            const rfa::common::Data& fieldData = field.getData(dataType);
-            const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(fieldData);
-            const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
-            const RDMEnumDef* enumDef = 0;
-
-            //Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
-            //check and decode according to data buffer type
-            switch(dataBufferType) {
-                case rfa::data::DataBuffer::EnumerationEnum:
-                    enumDef = fieldDef->getEnumDef();
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer,enumDef).c_str();
-                    d[fieldDef->getName().c_str()] = fieldValue.c_str();
-                    break;
-                case rfa::data::DataBuffer::FloatEnum:
-                case rfa::data::DataBuffer::DoubleEnum:
-                case rfa::data::DataBuffer::Real32Enum:
-                case rfa::data::DataBuffer::Real64Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        //d[fieldDef->getName().c_str()] = boost::python::object();
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToDouble(dataBuffer);
-                    }
-                    break;
-                case rfa::data::DataBuffer::Int32Enum:
-                case rfa::data::DataBuffer::UInt32Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToInt(dataBuffer);
-                    }
-                    break;
-                case rfa::data::DataBuffer::Int64Enum:
-                case rfa::data::DataBuffer::UInt64Enum:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    if(fieldValue.empty()) {
-                        d[fieldDef->getName().c_str()] = "";
-                    } else {
-                        d[fieldDef->getName().c_str()] = RDMUtils::dataBufferToLong(dataBuffer);
-                    }
-                    break;
-                default:
-                    fieldValue = RDMUtils::dataBufferToString(dataBuffer).c_str();
-                    d[fieldDef->getName().c_str()] = fieldValue.trimWhitespace().c_str();
-                    break;
-            }
-        }
-
+        _pDecodeTable->decodeField(field, sink);
 
             // The "_decoder" stores 14 pages of data, out of which 2 thru 10 indexes
             // correspond to ROW64_3 thru ROW64_11 each defining a TS1Def.
             // or get 'ROW64_12' that has next page code that needs to be requested:
             if( fieldID >= (_pDict->getFieldDef(RFA_String("ROW64_3", 0, false)))->getFieldId() &&  fieldID <= (_pDict->getFieldDef(RFA_String("ROW64_11", 0, false)))->getFieldId() ) {
-                _TS1DictDb.add(fieldValue.c_str());
+                _TS1DictDb.add(fieldToString(field).c_str());
             } else if( fieldID == (_pDict->getFieldDef(RFA_String("ROW64_12", 0, false)))->getFieldId() ) {
-                RFA_String nextStr = fieldValue;
+                RFA_String nextStr = fieldToString(field);
                 const char *next = nextStr.c_str();
                 int len = nextStr.length();
                 char nextRic[65];
@@ -418,7 +517,21 @@ void TimeSeriesHandler::decodeMarketPrice(const rfa::common::Data& data, dict &d
 
 }
 
-void TimeSeriesHandler::decodeTimeSeries(const rfa::message::RespMsg& respMsg, dict &d) {
+// text value of a TS1 page field
+rfa::common::RFA_String TimeSeriesHandler::fieldToString(const rfa::data::FieldEntry& field) {
+    const FieldDecodeTable::Entry* entry = _pDecodeTable->getEntry(field.getFieldID());
+    const rfa::common::UInt8 dataType = entry ? entry->dataType : (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
+    const rfa::data::DataBuffer& dataBuffer = static_cast<const rfa::data::DataBuffer&>(field.getData(dataType));
+    rfa::common::RFA_String fieldValue(RDMUtils::dataBufferToString(dataBuffer).c_str());
+    fieldValue.trimWhitespace();
+    return fieldValue;
+}
+
+/*
+* Decode a TS1 RIC into its series. The primary RIC names the secondary ones, which are requested then.
+* return false if decoding failed.
+*/
+bool TimeSeriesHandler::decodeTimeSeries(const rfa::message::RespMsg& respMsg, const std::string &itemName, Series &series, dict &d) {
     rfa::common::RFA_String timeSeriesData("", 0, false);
 
     // iterate thru field entries
@@ -468,88 +581,81 @@ void TimeSeriesHandler::decodeTimeSeries(const rfa::message::RespMsg& respMsg, d
     }
 
     if(!timeSeriesData.empty()) {
-        if (_pTimeSeries->decode(respMsg.getAttribInfo().getName().c_str(),timeSeriesData.c_str()) == false) {
+        if (series.pSeries->decode(respMsg.getAttribInfo().getName().c_str(),timeSeriesData.c_str()) == false) {
             _log = "[TimeSeriesHandler::decodeTimeSeries] Timeseries decoding failed for ";
             _log.append(respMsg.getAttribInfo().getName().c_str());
             _componentLogger.log(LM_GENERIC_ONE,rfa::common::Error,_log.c_str());
-            _isTimeSeriesParseComplete = true;
-            return;
+            return false;
         }
 
         // subscribe to secondary RICs e.g. dC.Nd1, dC.Nd2,...
         // 0 = primary
         // 1...N = secondary where N is from getRicCounts
-        if(respMsg.getAttribInfo().getName() == _pTimeSeries->getPrimaryRic()) {
-            for(int i=1; i < _pTimeSeries->getRicCounts(); ++i) {
-                sendRequest(RFA_String(_pTimeSeries->getRicName(i), 0, false).c_str());
+        if(respMsg.getAttribInfo().getName() == series.pSeries->getPrimaryRic()) {
+            for(int i=1; i < series.pSeries->getRicCounts(); ++i) {
+                requestRic(itemName, series, RFA_String(series.pSeries->getRicName(i), 0, false).c_str());
             }
         }
     }
+    return true;
+}
+
+bool TimeSeriesHandler::isSeriesComplete(const std::string &itemName) const {
+    SeriesIndex::const_iterator it = _series.find(itemName);
+    return (it == _series.end()) || it->second.complete;
 }
 
 bool TimeSeriesHandler::isTimeSeriesParseComplete() {
     // determine if all TS1 data is parsed completely
-    if( _numberOfDictParsed == _TS1DictDb.getNumberDbRics() && _numberOfTimeSeriesRefreshParsed == _pTimeSeries->getRicCounts() && _numberOfTimeSeriesRefreshParsed > 0 ) {
-        _isTimeSeriesParseComplete = true;
+    for(SeriesIndex::const_iterator it = _series.begin(); it != _series.end(); ++it) {
+        if(!it->second.complete)
+            return false;
     }
-    return _isTimeSeriesParseComplete;
+    return true;
+}
+
+bool TimeSeriesHandler::isTimeSeriesItem(rfa::common::Handle* handle) {
+    CMutex::CGuard guard(_handleMutex);
+    return _handles.find(handle) != _handles.end();
 }
 
 void TimeSeriesHandler::setDebugMode(const bool &debug) {
     _debug = debug;
 }
 
-std::string TimeSeriesHandler::getItemName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        if (strs.size() > 2) {
-            std::vector<std::string>::iterator strsit = strs.begin();
-            itemName = *strsit;
-            strsit++;
-            for (std::vector<std::string>::size_type i=1; i < strs.size()-1; i++) {
-                itemName = itemName + "." + *strsit;
-                strsit++;
-            }
-        } else {
-            itemName = strs[0];
-        }
-    }
-    return itemName;
+void TimeSeriesHandler::setCompletions(CompletionRegistry *completions) {
+    _pCompletions = completions;
+}
 
+void TimeSeriesHandler::setConcurrency(size_t concurrency) {
+    _scheduler.setWindow(concurrency);
+    pumpRequests();
+}
+
+std::string TimeSeriesHandler::getItemName(rfa::common::Handle* handle) {
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->itemName : "";
 }
 
 std::string TimeSeriesHandler::getItemServiceName(rfa::common::Handle* handle) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    it = _watchList.find(handle);
-    std::string itemServiceName = "";
-    if(it != _watchList.end()) {
-        std::vector<std::string> strs;
-        boost::split(strs, it->second, boost::is_any_of("."));
-        itemServiceName = strs.back();
-    }
-    return itemServiceName;
+    const ItemInfo* item = _watchList.find(handle);
+    return item ? item->serviceName : "";
 }
 
 
 rfa::common::Handle* TimeSeriesHandler::getHandle(const std::string &itemName) {
-    std::map<rfa::common::Handle*,std::string>::iterator it;
-    for(it = _watchList.begin(); it != _watchList.end(); it++) {
-        if(it->second == itemName+"."+_serviceName) {
-            return it->first;
-        }
-    }
-    return NULL;
+    return _watchList.findHandle(itemName, _serviceName);
 }
 
-std::map<rfa::common::Handle*,std::string> &TimeSeriesHandler::getWatchList() {
+ItemRegistry &TimeSeriesHandler::getWatchList() {
     return _watchList;
 }
 
-const std::list<std::string>* TimeSeriesHandler::getTimeSeries(const int &maxRecords) {
+bool TimeSeriesHandler::getTimeSeries(const std::string &itemName, const int &maxRecords, std::list<std::string> &records) {
+    SeriesIndex::const_iterator it = _series.find(itemName);
+    if((it == _series.end()) || !it->second.complete || !it->second.pSeries)
+        return false;
+    rfa::ts1::TS1Series *pSeries = it->second.pSeries;
     rfa::common::RFA_String timeSeriesRecord;
     rfa::ts1::TS1SampleIterator iterator;
 
@@ -559,13 +665,13 @@ const std::list<std::string>* TimeSeriesHandler::getTimeSeries(const int &maxRec
         _log.append(_TS1DictDb.getNumberDbRics());
         _log += "\n";
         _log += "Number Of RICs parsed = ";
-        _log.append(_pTimeSeries->getRicCounts());
+        _log.append(pSeries->getRicCounts());
         _log += "\n";
         _log += "Number Of FIDs = ";
-        _log.append(_pTimeSeries->getFactCount());
+        _log.append(pSeries->getFactCount());
         _log += "\n";
         _log += "Number Of Samples parsed = ";
-        _log.append(_pTimeSeries->getNumberOfSamples());
+        _log.append(pSeries->getNumberOfSamples());
         _log += "\n";
         _componentLogger.log(LM_GENERIC_ONE,rfa::common::Information,_log.c_str());
     }
@@ -575,16 +681,16 @@ const std::list<std::string>* TimeSeriesHandler::getTimeSeries(const int &maxRec
     char time_str[256];
 
     // Header record consists of FID definition
-    if(_pTimeSeries->getNumberOfSamples() > 0) {
+    if(pSeries->getNumberOfSamples() > 0) {
         timeSeriesRecord = "DATE";
-        for (int i=0; i < _pTimeSeries->getFactCount(); i++) {
+        for (int i=0; i < pSeries->getFactCount(); i++) {
             timeSeriesRecord += ",";
-            timeSeriesRecord.append( _TS1DictDb.getDefByFid(_pTimeSeries->getFact(i))->getLongName() );
+            timeSeriesRecord.append( factName(pSeries->getFact(i)) );
         }
-        _timeSeries.push_back(timeSeriesRecord.c_str());
+        records.push_back(timeSeriesRecord.c_str());
 
         // Timeseries records
-        for (iterator.start(_pTimeSeries); (!iterator.off() && (count++ < maxRecords)); iterator.forth()) {
+        for (iterator.start(pSeries); (!iterator.off() && (count++ < maxRecords)); iterator.forth()) {
             const rfa::ts1::TS1Sample* sample = iterator.getSample();
 
             time_t time = sample->getDate();
@@ -626,15 +732,104 @@ const std::list<std::string>* TimeSeriesHandler::getTimeSeries(const int &maxRec
                     }
                 }
             }
-            _timeSeries.push_back(timeSeriesRecord.c_str());
+            records.push_back(timeSeriesRecord.c_str());
         }
     }
-    return &_timeSeries;
+    return true;
+}
+
+// long name of a fact, FIDn if its TS1 database page was not received
+rfa::common::RFA_String TimeSeriesHandler::factName(int fid) {
+    const rfa::ts1::TS1Def* def = _TS1DictDb.getDefByFid(fid);
+    if(def)
+        return rfa::common::RFA_String(def->getLongName());
+    rfa::common::RFA_String name("FID");
+    name.append(fid);
+    return name;
 }
 
-void TimeSeriesHandler::initTimeSeries(rfa::ts1::TS1Series* pTimeSeries) {
-    _pTimeSeries = pTimeSeries;
-    _isTimeSeriesParseComplete = false;
-    _numberOfTimeSeriesRefreshParsed = 0;
-    _timeSeries.clear();
+/*
+* Columns of a complete series, no text is formatted. DATE holds int64 days since 1970-01-01
+* of the sample dates, or the sample times in seconds since the epoch. Every fact has a
+* float64 column, int64 if all its points are integers, and a mask of the valid points.
+* return false for an unknown item.
+*/
+bool TimeSeriesHandler::getTimeSeriesColumns(const std::string &itemName, const int &maxRecords, bool seconds, dict &columns) {
+    SeriesIndex::const_iterator it = _series.find(itemName);
+    if((it == _series.end()) || !it->second.complete || !it->second.pSeries)
+        return false;
+    rfa::ts1::TS1Series *pSeries = it->second.pSeries;
+    const int factCount = pSeries->getFactCount();
+    rfa::ts1::TS1SampleIterator iterator;
+
+    // first pass, the rows and whether a fact is integer
+    size_t rows = 0;
+    std::vector<bool> integer(factCount, true);
+    for (iterator.start(pSeries); (!iterator.off() && ((int)rows < maxRecords)); iterator.forth()) {
+        const rfa::ts1::TS1Sample* sample = iterator.getSample();
+        rows++;
+        if (!sample->isValid())
+            continue;
+        for (int i=0; (i < sample->getNumberOfPoints()) && (i < factCount); i++) {
+            const rfa::ts1::TS1Point* point = (*sample)[i];
+            if (point->isValid() && (point->getDataType() != rfa::ts1::TS1Point::Integer))
+                integer[i] = false;
+        }
+    }
+
+    static const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<char> dates(rows * sizeof(rfa::common::Int64));
+    std::vector<std::vector<char> > values(factCount);
+    std::vector<std::vector<char> > valid(factCount);
+    for (int i=0; i < factCount; i++) {
+        values[i].resize(rows * (integer[i] ? sizeof(rfa::common::Int64) : sizeof(double)));
+        valid[i].resize(rows, 0);
+    }
+
+    // second pass, the values
+    static const boost::gregorian::date epoch(1970, 1, 1);
+    size_t row = 0;
+    for (iterator.start(pSeries); (!iterator.off() && (row < rows)); iterator.forth(), row++) {
+        const rfa::ts1::TS1Sample* sample = iterator.getSample();
+
+        time_t time = sample->getDate();
+        rfa::common::Int64 date = (rfa::common::Int64)time;
+        if (!seconds) {
+            // the calendar date of the records, not the UTC day of the time
+            const struct tm *time_tm = localtime(&time);
+            date = (boost::gregorian::date(1900+time_tm->tm_year, time_tm->tm_mon+1, time_tm->tm_mday) - epoch).days();
+        }
+        std::memcpy(&dates[row * sizeof(rfa::common::Int64)], &date, sizeof(rfa::common::Int64));
+
+        for (int i=0; i < factCount; i++) {
+            const rfa::ts1::TS1Point* point = (sample->isValid() && (i < sample->getNumberOfPoints())) ? (*sample)[i] : 0;
+            const bool isValid = point && point->isValid() && (point->getDataType() != rfa::ts1::TS1Point::String);
+            if (integer[i]) {
+                const rfa::common::Int64 v = isValid ? (rfa::common::Int64)point->toInt() : 0;
+                std::memcpy(&values[i][row * sizeof(rfa::common::Int64)], &v, sizeof(rfa::common::Int64));
+            } else {
+                double v = nan;
+                if (isValid)
+                    v = (point->getDataType() == rfa::ts1::TS1Point::Double) ? point->toDouble() : (double)point->toInt();
+                std::memcpy(&values[i][row * sizeof(double)], &v, sizeof(double));
+            }
+            valid[i][row] = isValid ? 1 : 0;
+        }
+    }
+
+    columns["ROWS"] = rows;
+    columns["DATE"] = object(handle<>(ColumnBuffer::newColumn('q', sizeof(rfa::common::Int64), dates, rows)));
+    boost::python::list facts;
+    dict factValues;
+    dict factValid;
+    for (int i=0; i < factCount; i++) {
+        const std::string name = factName(pSeries->getFact(i)).c_str();
+        facts.append(name);
+        factValues[name] = object(handle<>(ColumnBuffer::newColumn(integer[i] ? 'q' : 'd', integer[i] ? sizeof(rfa::common::Int64) : sizeof(double), values[i], rows)));
+        factValid[name] = object(handle<>(ColumnBuffer::newColumn('?', sizeof(rfa::common::UInt8), valid[i], rows)));
+    }
+    columns["FACTS"] = boost::python::tuple(facts);
+    columns["FIELDS"] = factValues;
+    columns["VALID"] = factValid;
+    return true;
 }
@@ -2,15 +2,30 @@
 #define TIMESERIESHANDLER_H
 
 #include "StdAfx.h"
+#include "common/ItemRegistry.h"
+#include "common/Completion.h"
+#include "common/Mutex.h"
+#include "common/RequestScheduler.h"
 #include <boost/python.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <list>
+#include <string>
+#include <vector>
 
 class RDMFieldDict;
+class FieldDecodeTable;
 class TS1DefDb;
 class TS1Series;
 class TS1SampleIterator;
 
 using namespace boost::python;
 
+/*
+* Retrieves TS1 time series, many items at once. Every item has its own TS1Series
+* and completion state, the TS1 database RICs defining the facts are requested once
+* and shared by all of them.
+*/
 class TimeSeriesHandler
 {
 public:
@@ -19,25 +34,62 @@ public:
                     rfa::common::Client& client,
                     const std::string& serviceName,
                     const RDMFieldDict* dict,
+                    const FieldDecodeTable* decodeTable,
                     rfa::logger::ComponentLogger& componentLogger,
                     rfa::ts1::TS1DefDb& TS1DictDb);
     ~TimeSeriesHandler(void);
-    void                                        sendRequest(const std::string &itemName);
-    void                                        closeRequest(const std::string &itemName);
+    // queue the series of an item, at most the concurrency limit are retrieved at once
+    void                                        requestSeries(const std::string &itemName, rfa::ts1::TS1Series::Period period);
+    void                                        closeSeries(const std::string &itemName);
     void                                        closeAllRequest();
-    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::tuple& out);
+    void                                        processResponse(const rfa::message::RespMsg& respMsg, rfa::common::Handle* handle, boost::python::list& out);
+    // safe without the GIL
+    bool                                        isTimeSeriesItem(rfa::common::Handle* handle);
     std::string                                 getItemName(rfa::common::Handle* handle);
     std::string                                 getItemServiceName(rfa::common::Handle* handle);
     rfa::common::Handle*                        getHandle(const std::string &itemName);
-    const std::list<std::string>*               getTimeSeries(const int &maxRecords);
+    // records of a complete series, header first, false for an unknown item
+    bool                                        getTimeSeries(const std::string &itemName, const int &maxRecords, std::list<std::string> &records);
+    // the same as typed columns, DATE in epoch days or seconds
+    bool                                        getTimeSeriesColumns(const std::string &itemName, const int &maxRecords, bool seconds, dict &columns);
     void                                        setDebugMode(const bool &debugLevel);
-    void                                        initTimeSeries(rfa::ts1::TS1Series* pTimeSeries);
-    std::map<rfa::common::Handle*,std::string>  &getWatchList();
+    // the completions waiting for refreshes of this handler
+    void                                        setCompletions(CompletionRegistry *completions);
+    // series retrieved at once, 0 for no limit
+    void                                        setConcurrency(size_t concurrency);
+    ItemRegistry                                &getWatchList();
+    // the series of an item parsed or failed, unknown items are complete
+    bool                                        isSeriesComplete(const std::string &itemName) const;
     bool                                        isTimeSeriesParseComplete();
 
 private:
+    // retrieval of the series of one item
+    struct Series
+    {
+        Series() : pSeries(0), parsed(0), complete(false), ok(false) {}
+
+        rfa::ts1::TS1Series                     *pSeries;
+        int                                     parsed;     // refreshes of the TS1 RICs
+        bool                                    complete;
+        bool                                    ok;
+        std::vector<std::string>                rics;       // TS1 RICs requested so far
+    };
+    typedef boost::unordered_map<std::string, Series>   SeriesIndex;
+
+    void                                        sendRequest(const std::string &itemName);
+    void                                        closeRequest(const std::string &itemName);
+    void                                        pumpRequests();
+    void                                        startSeries(const std::string &itemName, Series &series);
+    void                                        requestRic(const std::string &itemName, Series &series, const std::string &ric);
+    void                                        checkComplete(const std::string &itemName, Series &series);
+    void                                        completeSeries(const std::string &itemName, Series &series, bool ok);
+    void                                        destroySeries(Series &series);
+    void                                        definitionParsed();
+    bool                                        isDefinitionComplete() const;
     void                                        decodeMarketPrice(const rfa::common::Data& data, dict &d);
-    void                                        decodeTimeSeries(const rfa::message::RespMsg& respMsg, dict &d);
+    bool                                        decodeTimeSeries(const rfa::message::RespMsg& respMsg, const std::string &itemName, Series &series, dict &d);
+    rfa::common::RFA_String                     fieldToString(const rfa::data::FieldEntry& field);
+    rfa::common::RFA_String                     factName(int fid);
     rfa::sessionLayer::OMMConsumer              *_pOMMConsumer;
     rfa::logger::ComponentLogger                &_componentLogger;
     rfa::common::EventQueue                     &_eventQueue;
@@ -45,15 +97,22 @@ private:
     const std::string                           &_serviceName;
     rfa::common::Handle                         *_pHandle;
     const RDMFieldDict*                         _pDict;
+    const FieldDecodeTable*                     _pDecodeTable;
     bool                                        _debug;
-    std::map<rfa::common::Handle*,std::string>  _watchList;
+    CompletionRegistry                          *_pCompletions;
+    ItemRegistry                                _watchList;
+    // the dispatch thread asks for time series items without the GIL
+    boost::unordered_set<rfa::common::Handle*>  _handles;
+    CMutex                                      _handleMutex;
+    // TS1 database RICs, requested once and shared by every series
     rfa::ts1::TS1DefDb                          &_TS1DictDb;
-    rfa::ts1::TS1Series                         *_pTimeSeries;
-    std::list<std::string>                      _timeSeries; // cached timeseries
+    bool                                        _definitionRequested;
     int                                         _numberOfDictParsed;
-    int                                         _numberOfTimeSeriesRefreshParsed;
-    bool                                        _isTimeSeriesParseComplete;
-    void                                        prettyPrint(boost::python::tuple& inputTuple);
+    SeriesIndex                                 _series;
+    // item of each TS1 RIC requested
+    boost::unordered_map<std::string, std::string> _itemOfRic;
+    RequestScheduler                            _scheduler;
+    void                                        prettyPrint(boost::python::list& inputList);
     rfa::common::RFA_String                     _log;
 };
 #endif
@@ -0,0 +1,335 @@
+#include "ColumnBuffer.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cstring>
+#include <limits>
+
+using namespace boost::python;
+
+enum { ItemColumn, TimeColumn, MTypeColumn, FixedColumnCount };
+
+// the buffer protocol of pyrfa.Column needs Python 2.6
+#if PY_VERSION_HEX >= 0x02060000
+// pyrfa.Column, a one dimensional typed array owning the storage of one column
+struct PyColumn
+{
+	PyObject_HEAD
+	std::vector<char>	*data;
+	char				format[2];
+	Py_ssize_t			itemSize;
+	Py_ssize_t			length;
+};
+
+static void columnDealloc( PyObject *obj )
+{
+	delete ( (PyColumn*)obj )->data;
+	PyObject_Del( obj );
+}
+
+static Py_ssize_t columnLength( PyObject *obj )
+{
+	return ( (PyColumn*)obj )->length;
+}
+
+static void* columnData( PyColumn *column )
+{
+	// an empty column still points somewhere, some consumers reject a null buffer
+	static char empty = 0;
+	return column->data->empty() ? &empty : &( *column->data )[0];
+}
+
+static int columnGetBuffer( PyObject *obj, Py_buffer *view, int flags )
+{
+	PyColumn *column = (PyColumn*)obj;
+	view->obj = obj;
+	Py_INCREF( obj );
+	view->buf = columnData( column );
+	view->len = column->length * column->itemSize;
+	view->readonly = 0;
+	view->itemsize = column->itemSize;
+	view->format = ( flags & PyBUF_FORMAT ) ? column->format : 0;
+	view->ndim = 1;
+	view->shape = ( flags & PyBUF_ND ) ? &column->length : 0;
+	view->strides = ( ( flags & PyBUF_STRIDES ) == PyBUF_STRIDES ) ? &column->itemSize : 0;
+	view->suboffsets = 0;
+	view->internal = 0;
+	return 0;
+}
+
+#if PY_MAJOR_VERSION < 3
+// old buffer protocol, numpy.frombuffer still uses it on Python 2
+static Py_ssize_t columnReadBuffer( PyObject *obj, Py_ssize_t segment, void **ptr )
+{
+	if ( segment != 0 )
+	{
+		PyErr_SetString( PyExc_SystemError, "pyrfa.Column has a single segment" );
+		return -1;
+	}
+	PyColumn *column = (PyColumn*)obj;
+	*ptr = columnData( column );
+	return column->length * column->itemSize;
+}
+
+static Py_ssize_t columnSegCount( PyObject *obj, Py_ssize_t *len )
+{
+	if ( len )
+		*len = ( (PyColumn*)obj )->length * ( (PyColumn*)obj )->itemSize;
+	return 1;
+}
+#endif
+
+static PySequenceMethods columnSequence;
+static PyBufferProcs columnBuffer;
+static PyTypeObject columnType =
+{
+	PyVarObject_HEAD_INIT( 0, 0 )
+	"pyrfa.Column",
+	sizeof( PyColumn ),
+	0
+};
+
+static PyTypeObject* getColumnType()
+{
+	static bool ready = false;
+	if ( !ready )
+	{
+		columnSequence.sq_length = columnLength;
+		columnBuffer.bf_getbuffer = columnGetBuffer;
+#if PY_MAJOR_VERSION < 3
+		columnBuffer.bf_getreadbuffer = columnReadBuffer;
+		columnBuffer.bf_getwritebuffer = columnReadBuffer;
+		columnBuffer.bf_getsegcount = columnSegCount;
+		columnType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+#else
+		columnType.tp_flags = Py_TPFLAGS_DEFAULT;
+#endif
+		columnType.tp_dealloc = columnDealloc;
+		columnType.tp_as_sequence = &columnSequence;
+		columnType.tp_as_buffer = &columnBuffer;
+		columnType.tp_doc = "Column of decoded fields, wrap it with numpy.asarray()";
+		if ( PyType_Ready( &columnType ) < 0 )
+			throw_error_already_set();
+		ready = true;
+	}
+	return &columnType;
+}
+#endif
+
+ColumnBuffer::ColumnBuffer() :
+ _rows( 0 ),
+ _capacity( 0 )
+{
+}
+
+void ColumnBuffer::setFields( const std::vector<Field> &fields, size_t capacity )
+{
+	_fields = fields;
+	_capacity = capacity;
+	_columnOf.clear();
+	_columns.clear();
+	_itemIds.clear();
+	_itemNames.clear();
+	_rows = 0;
+	if ( _fields.empty() )
+		return;
+
+	addColumn( 'i', sizeof( rfa::common::Int32 ) );
+	addColumn( 'd', sizeof( double ) );
+	addColumn( 'B', sizeof( rfa::common::UInt8 ) );
+	for ( size_t i = 0; i < _fields.size(); i++ )
+	{
+		_columnOf[_fields[i].fieldId] = (int)i;
+		addColumn( _fields[i].format, _fields[i].format == 'd' ? sizeof( double ) : sizeof( rfa::common::Int64 ) );
+		addColumn( '?', sizeof( rfa::common::UInt8 ) );
+	}
+	reserve();
+}
+
+void ColumnBuffer::addColumn( char format, size_t itemSize )
+{
+	Column column;
+	column.format = format;
+	column.itemSize = itemSize;
+	_columns.push_back( column );
+}
+
+void ColumnBuffer::reserve()
+{
+	for ( size_t i = 0; i < _columns.size(); i++ )
+		_columns[i].data.reserve( _capacity * _columns[i].itemSize );
+}
+
+void ColumnBuffer::clear()
+{
+	for ( size_t i = 0; i < _columns.size(); i++ )
+		_columns[i].data.clear();
+	_rows = 0;
+}
+
+void ColumnBuffer::moveRows( ColumnBuffer &rows )
+{
+	rows._fields = _fields;
+	rows._columns.resize( _columns.size() );
+	for ( size_t i = 0; i < _columns.size(); i++ )
+	{
+		rows._columns[i].format = _columns[i].format;
+		rows._columns[i].itemSize = _columns[i].itemSize;
+		rows._columns[i].data.clear();
+		rows._columns[i].data.swap( _columns[i].data );
+	}
+	// item ids stay the same across takes
+	rows._itemNames = _itemNames;
+	rows._rows = _rows;
+	rows._capacity = 0;
+	_rows = 0;
+	reserve();
+}
+
+void ColumnBuffer::beginRow( const std::string &itemName, RowType type )
+{
+	static const boost::posix_time::ptime epoch( boost::gregorian::date( 1970, 1, 1 ) );
+	static const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	boost::unordered_map<std::string, rfa::common::Int32>::iterator it = _itemIds.find( itemName );
+	if ( it == _itemIds.end() )
+	{
+		it = _itemIds.insert( std::make_pair( itemName, (rfa::common::Int32)_itemNames.size() ) ).first;
+		_itemNames.push_back( itemName );
+	}
+	const double time = ( boost::posix_time::microsec_clock::universal_time() - epoch ).total_microseconds() / 1e6;
+	const rfa::common::UInt8 mtype = (rfa::common::UInt8)type;
+
+	// every column grows by one zeroed value, absent doubles are NaN
+	for ( size_t i = 0; i < _columns.size(); i++ )
+		_columns[i].data.resize( ( _rows + 1 ) * _columns[i].itemSize );
+	std::memcpy( &_columns[ItemColumn].data[_rows * sizeof( rfa::common::Int32 )], &it->second, sizeof( rfa::common::Int32 ) );
+	std::memcpy( &_columns[TimeColumn].data[_rows * sizeof( double )], &time, sizeof( double ) );
+	std::memcpy( &_columns[MTypeColumn].data[_rows], &mtype, sizeof( rfa::common::UInt8 ) );
+	for ( size_t i = 0; i < _fields.size(); i++ )
+	{
+		if ( _fields[i].format == 'd' )
+			std::memcpy( &_columns[FixedColumnCount + 2 * i].data[_rows * sizeof( double )], &nan, sizeof( double ) );
+	}
+	_rows++;
+}
+
+void ColumnBuffer::setValue( int column, const FieldValue &value )
+{
+	switch ( value.type )
+	{
+	case FieldValue::DoubleEnum:
+		setDouble( column, value.doubleValue );
+		break;
+	case FieldValue::RealEnum:
+		setDouble( column, RealValue( value.longValue, value.hint ).toDouble() );
+		break;
+	case FieldValue::IntEnum:
+	case FieldValue::LongEnum:
+	case FieldValue::DateEnum:
+	case FieldValue::TimeEnum:
+	case FieldValue::DateTimeEnum:
+		setLong( column, value.longValue );
+		break;
+	default:
+		break;
+	}
+}
+
+void ColumnBuffer::setDouble( int column, double value )
+{
+	if ( column < 0 || _rows == 0 )
+		return;
+
+	const size_t row = _rows - 1;
+	Column &values = _columns[FixedColumnCount + 2 * column];
+	if ( values.format == 'd' )
+	{
+		std::memcpy( &values.data[row * sizeof( double )], &value, sizeof( double ) );
+	}
+	else
+	{
+		const rfa::common::Int64 v = (rfa::common::Int64)value;
+		std::memcpy( &values.data[row * sizeof( rfa::common::Int64 )], &v, sizeof( rfa::common::Int64 ) );
+	}
+	_columns[FixedColumnCount + 2 * column + 1].data[row] = 1;
+}
+
+void ColumnBuffer::setLong( int column, rfa::common::Int64 value )
+{
+	if ( column < 0 || _rows == 0 )
+		return;
+
+	const size_t row = _rows - 1;
+	Column &values = _columns[FixedColumnCount + 2 * column];
+	if ( values.format == 'd' )
+	{
+		const double v = (double)value;
+		std::memcpy( &values.data[row * sizeof( double )], &v, sizeof( double ) );
+	}
+	else
+	{
+		std::memcpy( &values.data[row * sizeof( rfa::common::Int64 )], &value, sizeof( rfa::common::Int64 ) );
+	}
+	_columns[FixedColumnCount + 2 * column + 1].data[row] = 1;
+}
+
+void ColumnBuffer::append( const std::string &itemName, RowType type, const std::vector<FieldValue> &fields )
+{
+	beginRow( itemName, type );
+	for ( size_t i = 0; i < fields.size(); i++ )
+		setValue( column( fields[i].fieldId ), fields[i] );
+}
+
+PyObject* ColumnBuffer::newColumn( Column &column, size_t rows )
+{
+	return newColumn( column.format, column.itemSize, column.data, rows );
+}
+
+PyObject* ColumnBuffer::newColumn( char format, size_t itemSize, std::vector<char> &data, size_t rows )
+{
+#if PY_VERSION_HEX < 0x02060000
+	PyErr_SetString( PyExc_NotImplementedError, "pyrfa.Column needs Python 2.6 or later" );
+	throw_error_already_set();
+	return 0;
+#else
+	PyColumn *pyColumn = PyObject_New( PyColumn, getColumnType() );
+	if ( !pyColumn )
+		throw_error_already_set();
+	pyColumn->data = new std::vector<char>();
+	pyColumn->data->swap( data );
+	pyColumn->format[0] = format;
+	pyColumn->format[1] = 0;
+	pyColumn->itemSize = (Py_ssize_t)itemSize;
+	pyColumn->length = (Py_ssize_t)rows;
+	return (PyObject*)pyColumn;
+#endif
+}
+
+dict ColumnBuffer::take()
+{
+	dict d;
+	d["ROWS"] = _rows;
+	boost::python::list items;
+	for ( size_t i = 0; i < _itemNames.size(); i++ )
+		items.append( _itemNames[i] );
+	d["ITEMS"] = tuple( items );
+	if ( _columns.empty() )
+		return d;
+
+	d["ITEM"] = object( handle<>( newColumn( _columns[ItemColumn], _rows ) ) );
+	d["TIME"] = object( handle<>( newColumn( _columns[TimeColumn], _rows ) ) );
+	d["MTYPE"] = object( handle<>( newColumn( _columns[MTypeColumn], _rows ) ) );
+	dict values;
+	dict valid;
+	for ( size_t i = 0; i < _fields.size(); i++ )
+	{
+		values[_fields[i].name] = object( handle<>( newColumn( _columns[FixedColumnCount + 2 * i], _rows ) ) );
+		valid[_fields[i].name] = object( handle<>( newColumn( _columns[FixedColumnCount + 2 * i + 1], _rows ) ) );
+	}
+	d["FIELDS"] = values;
+	d["VALID"] = valid;
+
+	_rows = 0;
+	reserve();
+	return d;
+}
@@ -0,0 +1,123 @@
+#ifndef _COLUMN_BUFFER_H_
+#define _COLUMN_BUFFER_H_
+
+#include "Python.h"
+#include "StdAfx.h"
+#include "EventRecord.h"
+#include "FieldDecodeTable.h"
+
+#include <boost/python.hpp>
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <vector>
+
+// decoded market price fields in struct-of-arrays form, one row per image or update.
+// every row has an item id, a receive time and a value and a valid flag per field
+// of the declared set, fields absent from the message are left invalid.
+// columns are contiguous and handed to Python as pyrfa.Column objects, which
+// expose them through the buffer protocol so NumPy can wrap them without a copy.
+// native only but take(), which needs the GIL.
+class ColumnBuffer
+{
+public:
+	enum RowType { ImageRow = 0, UpdateRow = 1 };
+
+	struct Field
+	{
+		rfa::common::Int16	fieldId;
+		std::string			name;
+		char				format;		// 'd' float64 or 'q' int64, nanoseconds for date/time fields
+	};
+
+	ColumnBuffer();
+
+	// an empty field set disables the buffer, rows and item ids are dropped.
+	// capacity rows are reserved up front and again after every take()
+	void			setFields( const std::vector<Field> &fields, size_t capacity );
+	bool			isEnabled() const	{ return !_fields.empty(); }
+
+	// column of a FID, -1 if it is not in the field set
+	int				column( rfa::common::Int16 fieldId ) const
+	{
+		boost::unordered_map<rfa::common::Int16, int>::const_iterator it = _columnOf.find( fieldId );
+		return it != _columnOf.end() ? it->second : -1;
+	}
+
+	// decode sink of the fields of the column set into the current row,
+	// see FieldDecodeTable::decodeFieldList()
+	class Sink
+	{
+	public:
+		Sink( ColumnBuffer &buffer ) : _buffer( buffer ), _column( -1 ) {}
+
+		bool	accepts( rfa::common::Int16 fieldId )	{ _column = _buffer.column( fieldId ); return _column >= 0; }
+		bool	typedDateTime() const					{ return true; }
+
+		void	blank( rfa::common::Int16, const FieldDecodeTable::Entry * ) {}
+		void	string( rfa::common::Int16, const FieldDecodeTable::Entry *, const std::string & ) {}
+		void	number( rfa::common::Int16, const FieldDecodeTable::Entry *, double value )
+		{
+			_buffer.setDouble( _column, value );
+		}
+		void	integer( rfa::common::Int16, const FieldDecodeTable::Entry *, rfa::common::Int64 value, FieldValue::ValueType )
+		{
+			_buffer.setLong( _column, value );
+		}
+		void	real( rfa::common::Int16, const FieldDecodeTable::Entry *, const RealValue &value )
+		{
+			_buffer.setDouble( _column, value.toDouble() );
+		}
+		void	dateTime( rfa::common::Int16, const FieldDecodeTable::Entry *, FieldValue::ValueType, rfa::common::Int64 nanos )
+		{
+			_buffer.setLong( _column, nanos );
+		}
+
+	private:
+		ColumnBuffer	&_buffer;
+		int				_column;
+	};
+
+	// start a row, the fields are then set one by one
+	void			beginRow( const std::string &itemName, RowType type );
+	void			setValue( int column, const FieldValue &value );
+	void			setDouble( int column, double value );
+	void			setLong( int column, rfa::common::Int64 value );
+	// a whole row of decoded fields, the ones outside the field set are skipped
+	void			append( const std::string &itemName, RowType type, const std::vector<FieldValue> &fields );
+
+	size_t			rows() const	{ return _rows; }
+	void			clear();
+
+	// move the rows so far to rows, this buffer then starts over empty. native, so the
+	// decoding thread's lock can be dropped before rows.take() builds the columns
+	void			moveRows( ColumnBuffer &rows );
+	// rows so far as a dict of columns, the buffer then starts over empty. GIL required
+	boost::python::dict	take();
+
+	// pyrfa.Column of rows values of itemSize bytes in a format of the buffer protocol,
+	// it takes the storage of data. GIL required
+	static PyObject*	newColumn( char format, size_t itemSize, std::vector<char> &data, size_t rows );
+
+private:
+	struct Column
+	{
+		char				format;
+		size_t				itemSize;
+		std::vector<char>	data;
+	};
+
+	void			addColumn( char format, size_t itemSize );
+	void			reserve();
+	static PyObject*	newColumn( Column &column, size_t rows );
+
+	std::vector<Field>								_fields;
+	boost::unordered_map<rfa::common::Int16, int>	_columnOf;
+	// ITEM, TIME and MTYPE, then the value and the valid flag of every field
+	std::vector<Column>								_columns;
+	boost::unordered_map<std::string, rfa::common::Int32>	_itemIds;
+	std::vector<std::string>						_itemNames;
+	size_t											_rows;
+	size_t											_capacity;
+};
+
+#endif // _COLUMN_BUFFER_H_
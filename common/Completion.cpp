@@ -0,0 +1,202 @@
+#include "Completion.h"
+
+#ifndef WIN32
+#include <errno.h>
+#include <sys/time.h>
+#endif
+
+using namespace boost::python;
+
+#ifdef WIN32
+Completion::Completion( const std::vector<std::string> &names ) :
+ _pending( names.begin(), names.end() )
+{
+	InitializeCriticalSection( &_cs );
+	_done = CreateEvent( NULL, TRUE, _pending.empty() ? TRUE : FALSE, NULL );
+}
+
+Completion::~Completion()
+{
+	CloseHandle( _done );
+	DeleteCriticalSection( &_cs );
+}
+
+bool Completion::complete( const std::string &name, bool ok )
+{
+	EnterCriticalSection( &_cs );
+	const bool pending = _pending.erase( name ) > 0;
+	if ( pending && !ok )
+		_failed.push_back( name );
+	if ( pending && _pending.empty() )
+		SetEvent( _done );
+	LeaveCriticalSection( &_cs );
+	return pending;
+}
+
+bool Completion::done() const
+{
+	EnterCriticalSection( &_cs );
+	const bool isDone = _pending.empty();
+	LeaveCriticalSection( &_cs );
+	return isDone;
+}
+
+bool Completion::wait( long timeout )
+{
+	return WaitForSingleObject( _done, timeout < 0 ? INFINITE : (DWORD)timeout ) == WAIT_OBJECT_0;
+}
+
+tuple Completion::pending() const
+{
+	EnterCriticalSection( &_cs );
+	const std::vector<std::string> names( _pending.begin(), _pending.end() );
+	LeaveCriticalSection( &_cs );
+	boost::python::list l;
+	for ( size_t i = 0; i < names.size(); i++ )
+		l.append( names[i] );
+	return tuple( l );
+}
+
+tuple Completion::failed() const
+{
+	EnterCriticalSection( &_cs );
+	const std::vector<std::string> names( _failed );
+	LeaveCriticalSection( &_cs );
+	boost::python::list l;
+	for ( size_t i = 0; i < names.size(); i++ )
+		l.append( names[i] );
+	return tuple( l );
+}
+
+#else
+
+Completion::Completion( const std::vector<std::string> &names ) :
+ _pending( names.begin(), names.end() )
+{
+	pthread_mutex_init( &_mutex, NULL );
+	pthread_cond_init( &_cv, NULL );
+}
+
+Completion::~Completion()
+{
+	pthread_cond_destroy( &_cv );
+	pthread_mutex_destroy( &_mutex );
+}
+
+bool Completion::complete( const std::string &name, bool ok )
+{
+	pthread_mutex_lock( &_mutex );
+	const bool pending = _pending.erase( name ) > 0;
+	if ( pending && !ok )
+		_failed.push_back( name );
+	if ( pending && _pending.empty() )
+		pthread_cond_broadcast( &_cv );
+	pthread_mutex_unlock( &_mutex );
+	return pending;
+}
+
+bool Completion::done() const
+{
+	pthread_mutex_lock( &_mutex );
+	const bool isDone = _pending.empty();
+	pthread_mutex_unlock( &_mutex );
+	return isDone;
+}
+
+bool Completion::wait( long timeout )
+{
+	struct timespec deadline;
+	if ( timeout >= 0 )
+	{
+		struct timeval now;
+		gettimeofday( &now, NULL );
+		const long long nanos = (long long)now.tv_usec * 1000 + (long long)( timeout % 1000 ) * 1000000;
+		deadline.tv_sec = now.tv_sec + timeout / 1000 + (time_t)( nanos / 1000000000 );
+		deadline.tv_nsec = (long)( nanos % 1000000000 );
+	}
+
+	pthread_mutex_lock( &_mutex );
+	int result = 0;
+	while ( !_pending.empty() && result != ETIMEDOUT )
+	{
+		if ( timeout < 0 )
+			result = pthread_cond_wait( &_cv, &_mutex );
+		else
+			result = pthread_cond_timedwait( &_cv, &_mutex, &deadline );
+	}
+	const bool isDone = _pending.empty();
+	pthread_mutex_unlock( &_mutex );
+	return isDone;
+}
+
+tuple Completion::pending() const
+{
+	pthread_mutex_lock( &_mutex );
+	const std::vector<std::string> names( _pending.begin(), _pending.end() );
+	pthread_mutex_unlock( &_mutex );
+	boost::python::list l;
+	for ( size_t i = 0; i < names.size(); i++ )
+		l.append( names[i] );
+	return tuple( l );
+}
+
+tuple Completion::failed() const
+{
+	pthread_mutex_lock( &_mutex );
+	const std::vector<std::string> names( _failed );
+	pthread_mutex_unlock( &_mutex );
+	boost::python::list l;
+	for ( size_t i = 0; i < names.size(); i++ )
+		l.append( names[i] );
+	return tuple( l );
+}
+
+#endif
+
+CompletionRegistry::CompletionRegistry() :
+ _size( 0 )
+{
+}
+
+void CompletionRegistry::add( Domain domain, const boost::shared_ptr<Completion> &completion, const std::vector<std::string> &names )
+{
+	CMutex::CGuard guard( _mutex );
+	for ( size_t i = 0; i < names.size(); i++ )
+		_waiting.insert( std::make_pair( Key( domain, names[i] ), completion ) );
+	_size.store( _waiting.size() );
+}
+
+void CompletionRegistry::complete( Domain domain, const std::string &name, bool ok )
+{
+	// most refreshes have nobody waiting
+	if ( _size.load() == 0 )
+		return;
+
+	CMutex::CGuard guard( _mutex );
+	std::pair<Waiting::iterator, Waiting::iterator> range = _waiting.equal_range( Key( domain, name ) );
+	for ( Waiting::iterator it = range.first; it != range.second; ++it )
+		it->second->complete( name, ok );
+	_waiting.erase( range.first, range.second );
+	_size.store( _waiting.size() );
+}
+
+void CompletionRegistry::failAll( Domain domain )
+{
+	if ( _size.load() == 0 )
+		return;
+
+	CMutex::CGuard guard( _mutex );
+	for ( Waiting::iterator it = _waiting.begin(); it != _waiting.end(); )
+	{
+		if ( it->first.first == domain )
+		{
+			it->second->complete( it->first.second, false );
+			it = _waiting.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+	_size.store( _waiting.size() );
+}
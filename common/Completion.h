@@ -0,0 +1,78 @@
+#ifndef _COMPLETION_H_
+#define _COMPLETION_H_
+
+#include "Mutex.h"
+
+#include <boost/atomic.hpp>
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+// completion of a snapshot style request, the refresh of one or more names.
+// the handlers complete the names from their refresh complete paths, on the
+// dispatch thread too, and wait() blocks without spinning until all of them are.
+// no GIL is needed but for pending() and failed().
+class Completion
+{
+public:
+	Completion( const std::vector<std::string> &names );
+	~Completion();
+
+	// false if name is not pending
+	bool			complete( const std::string &name, bool ok );
+	bool			done() const;
+	// true once done, false after timeout milliseconds, no limit for a negative timeout
+	bool			wait( long timeout );
+
+	// names still pending and names which failed, as tuples. GIL required
+	boost::python::tuple	pending() const;
+	boost::python::tuple	failed() const;
+
+private:
+	boost::unordered_set<std::string>	_pending;
+	std::vector<std::string>			_failed;
+#ifdef WIN32
+	mutable CRITICAL_SECTION			_cs;
+	HANDLE								_done;
+#else
+	mutable pthread_mutex_t				_mutex;
+	pthread_cond_t						_cv;
+#endif
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	Completion( const Completion & );
+	Completion & operator=( const Completion & );
+};
+
+// completions waiting for names, by domain
+class CompletionRegistry
+{
+public:
+	enum Domain { MarketPrice = 0, SymbolList = 1, History = 2, TimeSeries = 3, Chain = 4 };
+
+	CompletionRegistry();
+
+	void	add( Domain domain, const boost::shared_ptr<Completion> &completion, const std::vector<std::string> &names );
+	// complete name in every completion of domain waiting for it, cheap when none waits
+	void	complete( Domain domain, const std::string &name, bool ok );
+	// fail every name of domain, its requests are all closed
+	void	failAll( Domain domain );
+
+private:
+	typedef std::pair<int, std::string>	Key;
+	typedef boost::unordered_multimap<Key, boost::shared_ptr<Completion> >	Waiting;
+
+	Waiting					_waiting;
+	boost::atomic<size_t>	_size;
+	CMutex					_mutex;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	CompletionRegistry( const CompletionRegistry & );
+	CompletionRegistry & operator=( const CompletionRegistry & );
+};
+
+#endif // _COMPLETION_H_
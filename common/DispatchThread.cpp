@@ -0,0 +1,21 @@
+#include "DispatchThread.h"
+
+DispatchThread::DispatchThread( rfa::common::EventQueue &eventQueue, long timeout ) :
+ _eventQueue( eventQueue ),
+ _timeout( timeout )
+{
+}
+
+DispatchThread::~DispatchThread()
+{
+}
+
+void DispatchThread::run()
+{
+	while ( !isStopping() )
+	{
+		// the event queue has been deactivated
+		if ( _eventQueue.dispatch( _timeout ) == rfa::common::Dispatchable::NothingDispatchedInActive )
+			break;
+	}
+}
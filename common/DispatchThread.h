@@ -0,0 +1,29 @@
+#ifndef _DISPATCH_THREAD_H_
+#define _DISPATCH_THREAD_H_
+
+#include "StdAfx.h"
+#include "Thread.h"
+
+// dispatch an RFA EventQueue from a native thread.
+// events are handed to the client given at registerClient.
+class DispatchThread : public CThread
+{
+public:
+	DispatchThread( rfa::common::EventQueue &eventQueue, long timeout );
+	virtual ~DispatchThread();
+
+	bool	stopRequested()		{ return isStopping(); }
+
+protected:
+	virtual void run();
+
+private:
+	rfa::common::EventQueue		&_eventQueue;
+	long						_timeout;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	DispatchThread( const DispatchThread & );
+	DispatchThread & operator=( const DispatchThread & );
+};
+
+#endif // _DISPATCH_THREAD_H_
@@ -5,7 +5,9 @@
 #include <new>
 #include <cstdlib>
 #include "Encoder.h"
+#include "RealValue.h"
 #include <boost/lexical_cast.hpp>
+#include <limits>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #define DICT_ID    1
@@ -211,7 +213,6 @@ void Encoder::encodeMarketPriceDataBody(FieldList* pFieldList, RespMsg::RespType
             cout << fieldName.c_str() << "(" << fieldID << ")=";
         }
 
-        int exponentEnum = 14;
         rfa::common::RFA_String fieldValue(fieldList[indx+1]);
 
         // if value is blank
@@ -287,46 +288,42 @@ void Encoder::encodeMarketPriceDataBody(FieldList* pFieldList, RespMsg::RespType
                 }
                 break;
             }
-            // Real32 e.g. 8.424 -> 8424e-2
+            // Real32 e.g. 8.424 -> 8424e-3, also 8424E-3, 13/4 and str() of a pyrfa.Real
             case rfa::data::DataBuffer::Real32Enum:
             {
-                int decimalPosition = fieldValue.find( rfa::common::RFA_String(".") );
-                if ( decimalPosition >= 0 ) {
-                    exponentEnum = exponentEnum - (fieldValue.size() - decimalPosition - 1);
-                }
-                // remove decimal point from string
-                fieldValue.replace(decimalPosition,1,empty);
-                
+                RealValue real;
+                if(!RealValue::fromString(fieldValue.c_str(), real)
+                    || real.getMantissa() > std::numeric_limits<rfa::common::Int32>::max()
+                    || real.getMantissa() < std::numeric_limits<rfa::common::Int32>::min())
+                    throw boost::bad_lexical_cast();
+
                 rfa::data::Real32 real32;
-                real32.setMagnitudeType(exponentEnum);
-                real32.setValue(boost::lexical_cast<rfa::common::Int32>(fieldValue.c_str()));
+                real32.setMagnitudeType(real.getHint());
+                real32.setValue((rfa::common::Int32)real.getMantissa());
                 field.setFieldID(fieldID);
                 dataBuffer.setReal32(real32);
                 field.setData(dataBuffer);
                 fieldListWIt.bind(field);
                 if(_debug)
-                    cout << fieldValue.c_str() << "e-" << (14-exponentEnum) << endl;
+                    cout << real.getMantissa() << "(hint " << (int)real.getHint() << ")" << endl;
                 break;
             }
             // Real64
             case rfa::data::DataBuffer::Real64Enum:
             {
-                int decimalPosition = fieldValue.find( rfa::common::RFA_String(".") );
-                if ( decimalPosition >= 0 ) {
-                    exponentEnum = exponentEnum - (fieldValue.size() - decimalPosition - 1);
-                }
-                // remove decimal point from string
-                fieldValue.replace(decimalPosition,1,empty);
-                
+                RealValue real;
+                if(!RealValue::fromString(fieldValue.c_str(), real))
+                    throw boost::bad_lexical_cast();
+
                 rfa::data::Real64 real64;
-                real64.setMagnitudeType(exponentEnum);
-                real64.setValue(boost::lexical_cast<rfa::common::Int64>(fieldValue.c_str()));
+                real64.setMagnitudeType(real.getHint());
+                real64.setValue(real.getMantissa());
                 field.setFieldID(fieldID);
                 dataBuffer.setReal64(real64);
                 field.setData(dataBuffer);
                 fieldListWIt.bind(field);
                 if(_debug)
-                    cout << fieldValue.c_str() << "e-" << (14-exponentEnum) << endl;
+                    cout << real.getMantissa() << "(hint " << (int)real.getHint() << ")" << endl;
                 break;
             }
             // Time
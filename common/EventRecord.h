@@ -0,0 +1,50 @@
+#ifndef _EVENT_RECORD_H_
+#define _EVENT_RECORD_H_
+
+#include "Python.h"
+#include "StdAfx.h"
+
+#include <vector>
+
+// a decoded field value kept in native form until it is handed to Python
+struct FieldValue
+{
+	// DateEnum and DateTimeEnum are nanoseconds since the epoch, TimeEnum since midnight.
+	// RealEnum is the exact mantissa and magnitude type (hint) of an RFA Real
+	enum ValueType { BlankEnum, DoubleEnum, IntEnum, LongEnum, StringEnum, DateEnum, TimeEnum, DateTimeEnum, RealEnum };
+
+	FieldValue() : fieldId(0), type(BlankEnum), hint(0), doubleValue(0), longValue(0) {}
+
+	rfa::common::Int16		fieldId;
+	rfa::common::UInt8		type;
+	rfa::common::UInt8		hint;			// RealEnum
+	double					doubleValue;
+	rfa::common::Int64		longValue;		// IntEnum, LongEnum, RealEnum mantissa and the date/time types
+	std::string				stringValue;
+};
+
+// one decoded event, built without the GIL on the dispatch thread.
+// pyObject holds an event already decoded to Python by a handler instead
+// (owned reference, only touched with the GIL held).
+struct EventRecord
+{
+	EventRecord() : msgModelType(0), pyObject(0) {}
+
+	rfa::common::UInt8		msgModelType;
+	std::string				itemName;
+	std::string				serviceName;
+	std::string				mtype;
+	std::vector<FieldValue>	fields;
+	// encoded field list of an image or update delivered as a LazyUpdate, fields are left empty
+	std::vector<unsigned char>	payload;
+
+	// STATUS only
+	std::string				text;
+	std::string				dataState;
+	std::string				streamState;
+	std::string				statusCode;
+
+	PyObject				*pyObject;
+};
+
+#endif // _EVENT_RECORD_H_
@@ -0,0 +1,48 @@
+#include "EventRing.h"
+
+CEventRing::CEventRing( size_t capacity ) :
+ _queue( capacity ),
+ _capacity( capacity ),
+ _depth( 0 ),
+ _highWaterMark( 0 ),
+ _pushCount( 0 ),
+ _fullCount( 0 )
+{
+}
+
+CEventRing::~CEventRing()
+{
+	EventRecord *record;
+	while ( (record = pop()) != 0 )
+	{
+		Py_XDECREF( record->pyObject );
+		delete record;
+	}
+}
+
+bool CEventRing::push( EventRecord *record )
+{
+	// counted before the record is visible, so the consumer never takes the depth below 0
+	size_t depth = ++_depth;
+	if ( !_queue.push( record ) )
+	{
+		_depth--;
+		return false;
+	}
+
+	_pushCount++;
+	// only the producer raises the high-water mark
+	if ( depth > _highWaterMark.load() )
+		_highWaterMark.store( depth );
+	return true;
+}
+
+EventRecord* CEventRing::pop()
+{
+	EventRecord *record = 0;
+	if ( !_queue.pop( record ) )
+		return 0;
+
+	_depth--;
+	return record;
+}
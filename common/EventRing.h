@@ -0,0 +1,44 @@
+#ifndef _C_EVENT_RING_H_
+#define _C_EVENT_RING_H_
+
+#include "EventRecord.h"
+
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+// lock-free single-producer/single-consumer ring of decoded events.
+// the dispatch thread pushes, Python drains while holding the GIL.
+class CEventRing
+{
+public:
+	CEventRing( size_t capacity );
+	// must be destroyed with the GIL held, see EventRecord::pyObject
+	~CEventRing();
+
+	// producer side, false if the ring is full
+	bool			push( EventRecord *record );
+	void			full()			{ _fullCount++; }
+
+	// consumer side, 0 if the ring is empty
+	EventRecord*	pop();
+
+	size_t			depth() const			{ return _depth.load(); }
+	size_t			highWaterMark() const	{ return _highWaterMark.load(); }
+	size_t			capacity() const		{ return _capacity; }
+	unsigned long	pushCount() const		{ return _pushCount.load(); }
+	unsigned long	fullCount() const		{ return _fullCount.load(); }
+
+private:
+	boost::lockfree::spsc_queue<EventRecord*>	_queue;
+	size_t										_capacity;
+	boost::atomic<size_t>						_depth;
+	boost::atomic<size_t>						_highWaterMark;
+	boost::atomic<unsigned long>				_pushCount;
+	boost::atomic<unsigned long>				_fullCount;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	CEventRing( const CEventRing & );
+	CEventRing & operator=( const CEventRing & );
+};
+
+#endif // _C_EVENT_RING_H_
@@ -0,0 +1,340 @@
+#include "FieldDecodeTable.h"
+#include "RDMDict.h"
+#include "RDMUtils.h"
+
+#include "datetime.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <stdexcept>
+
+using namespace boost::python;
+
+static const rfa::common::Int64 NanosPerMicro = 1000;
+static const rfa::common::Int64 NanosPerSecond = 1000000000;
+static const rfa::common::Int64 NanosPerDay = 86400 * NanosPerSecond;
+
+static const char *fixedKeyNames[FieldDecodeTable::FixedKeyCount] =
+{
+	"RIC", "SERVICE", "MTYPE", "ACTION", "KEY",
+	"REFRESH", "IMAGE", "UPDATE", "STATUS", "ADD", "DELETE", "SUMMARY"
+};
+
+FieldDecodeTable::FieldDecodeTable() :
+ _isBuilt( false ),
+ _dateTimeMode( DateTimeString ),
+ _realMode( RealDouble )
+{
+	for ( int i = 0; i < FixedKeyCount; i++ )
+		_fixedKeys[i] = intern( fixedKeyNames[i] );
+
+	// datetime C API of this translation unit
+	PyDateTime_IMPORT;
+	if ( !PyDateTimeAPI )
+		throw_error_already_set();
+}
+
+FieldDecodeTable::~FieldDecodeTable()
+{
+	clear();
+	for ( int i = 0; i < FixedKeyCount; i++ )
+		Py_XDECREF( _fixedKeys[i] );
+}
+
+PyObject* FieldDecodeTable::intern( const char *str )
+{
+#if PY_MAJOR_VERSION >= 3
+	PyObject *key = PyUnicode_InternFromString( str );
+#else
+	PyObject *key = PyString_InternFromString( str );
+#endif
+	if ( !key )
+		throw_error_already_set();
+	return key;
+}
+
+dict FieldDecodeTable::newDict( Py_ssize_t size )
+{
+	// _PyDict_NewPresized is private, 2.7 is the first to have it and 3.13 hides it again
+#if PY_VERSION_HEX >= 0x02070000 && PY_VERSION_HEX < 0x030D0000
+	return dict( (detail::new_reference)_PyDict_NewPresized( size ) );
+#else
+	return dict();
+#endif
+}
+
+dict FieldDecodeTable::newDict( const rfa::data::FieldList &fieldList, Py_ssize_t extra )
+{
+	return newDict( fieldList.getStandardDataCount() + extra );
+}
+
+boost::python::list FieldDecodeTable::newList( Py_ssize_t size )
+{
+	PyObject *l = PyList_New( size );
+	if ( !l )
+		throw_error_already_set();
+	for ( Py_ssize_t i = 0; i < size; i++ )
+	{
+		Py_INCREF( Py_None );
+		PyList_SET_ITEM( l, i, Py_None );
+	}
+	return boost::python::list( (detail::new_reference)l );
+}
+
+void FieldDecodeTable::setItem( dict &d, FixedKey key, FixedKey value ) const
+{
+	if ( PyDict_SetItem( d.ptr(), _fixedKeys[key], _fixedKeys[value] ) < 0 )
+		throw_error_already_set();
+}
+
+void FieldDecodeTable::setItem( dict &d, FixedKey key, const std::string &value ) const
+{
+	setItem( d, key, object( value ) );
+}
+
+void FieldDecodeTable::setItem( dict &d, FixedKey key, const object &value ) const
+{
+	if ( PyDict_SetItem( d.ptr(), _fixedKeys[key], value.ptr() ) < 0 )
+		throw_error_already_set();
+}
+
+void FieldDecodeTable::build( const RDMFieldDict &dict )
+{
+	clear();
+
+	Entry empty = { 0, 0, StringConverter, 0 };
+	_posEntries.resize( dict.maxPositiveFieldId() >= 0 ? dict.maxPositiveFieldId() + 1 : 0, empty );
+	_negEntries.resize( dict.minNegativeFieldId() < 0 ? -dict.minNegativeFieldId() + 1 : 0, empty );
+
+	for ( rfa::common::Int fieldId = dict.minNegativeFieldId(); fieldId <= dict.maxPositiveFieldId(); fieldId++ )
+	{
+		const RDMFieldDef *fieldDef = dict.getFieldDef( fieldId );
+		if ( !fieldDef )
+			continue;
+
+		Entry &entry = fieldId >= 0 ? _posEntries[fieldId] : _negEntries[-fieldId];
+		entry.fieldDef = fieldDef;
+		entry.dataType = (rfa::common::UInt8)fieldDef->getDataType();
+		entry.converter = (rfa::common::UInt8)converterFor( entry.dataType );
+
+		entry.key = intern( fieldDef->getName().c_str() );
+	}
+	_isBuilt = true;
+}
+
+void FieldDecodeTable::clear()
+{
+	for ( size_t i = 0; i < _posEntries.size(); i++ )
+		Py_XDECREF( _posEntries[i].key );
+	for ( size_t i = 0; i < _negEntries.size(); i++ )
+		Py_XDECREF( _negEntries[i].key );
+	_posEntries.clear();
+	_negEntries.clear();
+	_isBuilt = false;
+}
+
+void FieldDecodeTable::swap( FieldDecodeTable &table )
+{
+	_posEntries.swap( table._posEntries );
+	_negEntries.swap( table._negEntries );
+	std::swap( _isBuilt, table._isBuilt );
+}
+
+FieldDecodeTable::Converter FieldDecodeTable::converterFor( rfa::common::UInt8 dataBufferType )
+{
+	switch ( dataBufferType )
+	{
+	case rfa::data::DataBuffer::EnumerationEnum:
+		return EnumConverter;
+	case rfa::data::DataBuffer::FloatEnum:
+	case rfa::data::DataBuffer::DoubleEnum:
+	case rfa::data::DataBuffer::Real32Enum:
+	case rfa::data::DataBuffer::Real64Enum:
+		return DoubleConverter;
+	case rfa::data::DataBuffer::Int32Enum:
+	case rfa::data::DataBuffer::UInt32Enum:
+		return IntConverter;
+	case rfa::data::DataBuffer::Int64Enum:
+	case rfa::data::DataBuffer::UInt64Enum:
+		return LongConverter;
+	case rfa::data::DataBuffer::DateEnum:
+		return DateConverter;
+	case rfa::data::DataBuffer::TimeEnum:
+		return TimeConverter;
+	case rfa::data::DataBuffer::DateTimeEnum:
+		return DateTimeConverter;
+	default:
+		return StringConverter;
+	}
+}
+
+const rfa::data::DataBuffer& FieldDecodeTable::getDataBuffer( const rfa::data::FieldEntry &field, const Entry *entry, Converter &converter ) const
+{
+	// if no field definition then no dataType
+	const rfa::common::UInt8 dataType = entry ? entry->dataType : (rfa::common::UInt8)rfa::data::DataBuffer::UnknownDataBufferEnum;
+	const rfa::data::DataBuffer &dataBuffer = static_cast<const rfa::data::DataBuffer&>( field.getData( dataType ) );
+
+	//Note: somehow RDNDISPLAY has dataType=2 but dataBufferType=4
+	//the buffer type wins whenever it differs from the dictionary
+	const rfa::common::UInt8 dataBufferType = dataBuffer.getDataBufferType();
+	if ( entry && dataBufferType == entry->dataType )
+		converter = (Converter)entry->converter;
+	else
+		converter = converterFor( dataBufferType );
+	return dataBuffer;
+}
+
+FieldValue::ValueType FieldDecodeTable::dateTimeType( Converter converter )
+{
+	switch ( converter )
+	{
+	case DateConverter:
+		return FieldValue::DateEnum;
+	case TimeConverter:
+		return FieldValue::TimeEnum;
+	default:
+		return FieldValue::DateTimeEnum;
+	}
+}
+
+bool FieldDecodeTable::dateTimeToNanos( const rfa::data::DataBuffer &dataBuffer, Converter converter, rfa::common::Int64 &nanos )
+{
+	if ( dataBuffer.isBlank() )
+		return false;
+
+	nanos = 0;
+	if ( converter != TimeConverter )
+	{
+		static const boost::gregorian::date epoch( 1970, 1, 1 );
+		const rfa::data::Date &date = converter == DateConverter ? dataBuffer.getDate() : dataBuffer.getDateTime().getDate();
+		if ( date.getYear() == 0 )
+			return false;
+		try
+		{
+			boost::gregorian::date day( date.getYear(), date.getMonth(), date.getDay() );
+			nanos = (rfa::common::Int64)( day - epoch ).days() * NanosPerDay;
+		}
+		catch ( std::out_of_range & )
+		{
+			return false;
+		}
+	}
+	if ( converter != DateConverter )
+	{
+		const rfa::data::Time &time = converter == TimeConverter ? dataBuffer.getTime() : dataBuffer.getDateTime().getTime();
+		nanos += ( ( time.getHour() * 60 + time.getMinute() ) * 60 + time.getSecond() ) * NanosPerSecond
+			+ time.getMillisecond() * 1000 * NanosPerMicro + time.getMicrosecond() * NanosPerMicro + time.getNanosecond();
+	}
+	return true;
+}
+
+object FieldDecodeTable::dateTimeToPython( FieldValue::ValueType type, rfa::common::Int64 nanos ) const
+{
+	if ( _dateTimeMode == DateTimeEpoch )
+		return object( nanos );
+
+	// floor division, dates before the epoch are negative
+	rfa::common::Int64 days = nanos / NanosPerDay;
+	rfa::common::Int64 dayNanos = nanos % NanosPerDay;
+	if ( dayNanos < 0 )
+	{
+		days--;
+		dayNanos += NanosPerDay;
+	}
+	if ( type == FieldValue::TimeEnum )
+	{
+		days = 0;
+		dayNanos = nanos;
+	}
+	const boost::gregorian::date day = boost::gregorian::date( 1970, 1, 1 ) + boost::gregorian::days( (long)days );
+	const boost::posix_time::time_duration time = boost::posix_time::microseconds( dayNanos / NanosPerMicro );
+
+	// values a string mode table finds in the image cache, decoded before the mode changed
+	if ( _dateTimeMode == DateTimeString )
+	{
+		if ( type == FieldValue::DateEnum )
+			return object( boost::gregorian::to_iso_extended_string( day ) );
+		if ( type == FieldValue::TimeEnum )
+			return object( boost::posix_time::to_simple_string( time ) );
+		return object( boost::posix_time::to_iso_extended_string( boost::posix_time::ptime( day, time ) ) );
+	}
+
+	PyObject *value;
+	const int microsecond = (int)( time.total_microseconds() % 1000000 );
+	if ( type == FieldValue::DateEnum )
+		value = PyDate_FromDate( day.year(), day.month(), day.day() );
+	else if ( type == FieldValue::TimeEnum )
+		value = PyTime_FromTime( (int)time.hours(), (int)time.minutes(), (int)time.seconds(), microsecond );
+	else
+		value = PyDateTime_FromDateAndTime( day.year(), day.month(), day.day(), (int)time.hours(), (int)time.minutes(), (int)time.seconds(), microsecond );
+	if ( !value )
+		throw_error_already_set();
+	return object( handle<>( value ) );
+}
+
+bool FieldDecodeTable::getReal( const rfa::data::DataBuffer &dataBuffer, RealValue &real )
+{
+	switch ( dataBuffer.getDataBufferType() )
+	{
+	case rfa::data::DataBuffer::Real32Enum:
+		real = RealValue( dataBuffer.getReal32().getValue(), dataBuffer.getReal32().getMagnitudeType() );
+		return true;
+	case rfa::data::DataBuffer::Real64Enum:
+		real = RealValue( dataBuffer.getReal().getValue(), dataBuffer.getReal().getMagnitudeType() );
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::string FieldDecodeTable::enumToString( const rfa::data::DataBuffer &dataBuffer, const Entry &entry )
+{
+	std::string value = RDMUtils::dataBufferToString( dataBuffer, entry.fieldDef->getEnumDef() );
+	std::string::size_type pos = value.find( "\xde" );
+	if ( pos != std::string::npos )
+		value.replace( pos, 1, "\xe2\x87\xa7" );
+	pos = value.find( "\xfe" );
+	if ( pos != std::string::npos )
+		value.replace( pos, 1, "\xe2\x87\xa9" );
+	return value;
+}
+
+std::string FieldDecodeTable::trimmedString( const rfa::data::DataBuffer &dataBuffer )
+{
+	rfa::common::RFA_String fieldValue( RDMUtils::dataBufferToString( dataBuffer ).c_str() );
+	return fieldValue.trimWhitespace().c_str();
+}
+
+void FieldDecodeTable::setField( dict &d, const FieldValue &value ) const
+{
+	d[getFieldKey( value.fieldId )] = toPython( value );
+}
+
+object FieldDecodeTable::getFieldKey( rfa::common::Int16 fieldId ) const
+{
+	const Entry *entry = getEntry( fieldId );
+	if ( entry )
+		return object( handle<>( borrowed( entry->key ) ) );
+	return object( fieldId );
+}
+
+object FieldDecodeTable::toPython( const FieldValue &value ) const
+{
+	switch ( value.type )
+	{
+	case FieldValue::DoubleEnum:
+		return object( value.doubleValue );
+	case FieldValue::IntEnum:
+		return object( (int)value.longValue );
+	case FieldValue::LongEnum:
+		return object( value.longValue );
+	case FieldValue::StringEnum:
+		return object( value.stringValue );
+	case FieldValue::DateEnum:
+	case FieldValue::TimeEnum:
+	case FieldValue::DateTimeEnum:
+		return dateTimeToPython( (FieldValue::ValueType)value.type, value.longValue );
+	case FieldValue::RealEnum:
+		return object( RealValue( value.longValue, value.hint ) );
+	default:
+		return object( "" );
+	}
+}
@@ -0,0 +1,334 @@
+#ifndef _FIELD_DECODE_TABLE_H_
+#define _FIELD_DECODE_TABLE_H_
+
+#include "Python.h"
+#include "StdAfx.h"
+#include "EventRecord.h"
+#include "FieldFilter.h"
+#include "RealValue.h"
+#include "RDMUtils.h"
+
+#include <boost/python.hpp>
+#include <vector>
+
+class RDMFieldDict;
+class RDMFieldDef;
+
+// per-FID decode plan, built once when the field dictionary has loaded.
+// every known FID keeps its definition, the data type to ask RFA for,
+// the converter for that type and its name as an interned Python key.
+// the fixed keys and values of every event are interned once with the table.
+//
+// decodeField() and decodeFieldList() are the one field decoder of every handler,
+// instantiated per sink. a sink gets each field already converted:
+//   bool accepts( Int16 fieldId )		projection, asked before any conversion
+//   bool typedDateTime()				date/time fields as nanoseconds whatever the mode
+//   void blank( Int16 fieldId, const Entry *entry )
+//   void string( Int16 fieldId, const Entry *entry, const std::string &value )
+//   void number( Int16 fieldId, const Entry *entry, double value )
+//   void integer( Int16 fieldId, const Entry *entry, Int64 value, FieldValue::ValueType type )
+//   void real( Int16 fieldId, const Entry *entry, const RealValue &value )
+//   void dateTime( Int16 fieldId, const Entry *entry, FieldValue::ValueType type, Int64 nanos )
+// entry is 0 for FIDs missing from the dictionary, those are always strings.
+// DictSink and ValueSink below, ColumnBuffer::Sink for the columns.
+// DictSink needs the GIL, the others run on the dispatch thread.
+class FieldDecodeTable
+{
+public:
+	enum Converter { StringConverter, EnumConverter, DoubleConverter, IntConverter, LongConverter,
+					 DateConverter, TimeConverter, DateTimeConverter };
+
+	// DATE, TIME and DATETIME fields as the strings RFA formats, as int64 nanoseconds
+	// (since the epoch, TIME since midnight) or as datetime.date, time and datetime objects
+	enum DateTimeMode { DateTimeString, DateTimeEpoch, DateTimeNative };
+
+	// REAL32 and REAL64 fields as doubles or as exact pyrfa.Real decimals
+	enum RealMode { RealDouble, RealDecimal };
+
+	enum FixedKey
+	{
+		RicKey, ServiceKey, MTypeKey, ActionKey, KeyKey,
+		RefreshValue, ImageValue, UpdateValue, StatusValue, AddValue, DeleteValue, SummaryValue,
+		FixedKeyCount
+	};
+
+	struct Entry
+	{
+		const RDMFieldDef	*fieldDef;
+		rfa::common::UInt8	dataType;
+		rfa::common::UInt8	converter;
+		PyObject			*key;		// owned reference
+	};
+
+	FieldDecodeTable();
+	// must be destroyed with the GIL held, see Entry::key
+	~FieldDecodeTable();
+
+	void			build( const RDMFieldDict &dict );
+	void			clear();
+	// exchanges the entries with a table built off to the side, the modes and fixed keys stay
+	void			swap( FieldDecodeTable &table );
+	bool			isBuilt() const		{ return _isBuilt; }
+
+	void			setDateTimeMode( DateTimeMode mode )	{ _dateTimeMode = mode; }
+	DateTimeMode	getDateTimeMode() const					{ return _dateTimeMode; }
+	void			setRealMode( RealMode mode )			{ _realMode = mode; }
+	RealMode		getRealMode() const						{ return _realMode; }
+
+	// 0 if the FID is not in the dictionary
+	const Entry*	getEntry( rfa::common::Int16 fieldId ) const
+	{
+		const Entry *entry;
+		if ( fieldId >= 0 )
+		{
+			if ( fieldId >= (rfa::common::Int)_posEntries.size() )
+				return 0;
+			entry = &_posEntries[fieldId];
+		}
+		else
+		{
+			if ( -fieldId >= (rfa::common::Int)_negEntries.size() )
+				return 0;
+			entry = &_negEntries[-fieldId];
+		}
+		return entry->fieldDef ? entry : 0;
+	}
+
+	// python dict sink, fields go under their name, or under their FID when unknown.
+	// blank numeric fields become "" as they always have
+	class DictSink
+	{
+	public:
+		DictSink( const FieldDecodeTable &table, boost::python::dict &d, const FieldFilter *filter = 0 ) :
+		 _table( table ), _dict( d ), _filter( filter ) {}
+
+		bool	accepts( rfa::common::Int16 fieldId ) const	{ return !_filter || _filter->accepts( fieldId ); }
+		bool	typedDateTime() const						{ return false; }
+
+		void	blank( rfa::common::Int16 fieldId, const Entry *entry )
+		{
+			set( fieldId, entry, boost::python::object( "" ) );
+		}
+		void	string( rfa::common::Int16 fieldId, const Entry *entry, const std::string &value )
+		{
+			set( fieldId, entry, boost::python::object( value ) );
+		}
+		void	number( rfa::common::Int16 fieldId, const Entry *entry, double value )
+		{
+			set( fieldId, entry, boost::python::object( value ) );
+		}
+		void	integer( rfa::common::Int16 fieldId, const Entry *entry, rfa::common::Int64 value, FieldValue::ValueType type )
+		{
+			set( fieldId, entry, type == FieldValue::IntEnum ? boost::python::object( (int)value ) : boost::python::object( (long)value ) );
+		}
+		void	real( rfa::common::Int16 fieldId, const Entry *entry, const RealValue &value )
+		{
+			set( fieldId, entry, boost::python::object( value ) );
+		}
+		void	dateTime( rfa::common::Int16 fieldId, const Entry *entry, FieldValue::ValueType type, rfa::common::Int64 nanos )
+		{
+			set( fieldId, entry, _table.dateTimeToPython( type, nanos ) );
+		}
+
+	private:
+		void	set( rfa::common::Int16 fieldId, const Entry *entry, const boost::python::object &value )
+		{
+			if ( !entry )
+				_dict[fieldId] = value;
+			else if ( PyDict_SetItem( _dict.ptr(), entry->key, value.ptr() ) < 0 )
+				boost::python::throw_error_already_set();
+		}
+
+		const FieldDecodeTable	&_table;
+		boost::python::dict		&_dict;
+		const FieldFilter		*_filter;
+	};
+
+	// native sink for the dispatch thread, one FieldValue per field, blanks are
+	// left as FieldValue::BlankEnum. date/time fields are strings in DateTimeString
+	// mode, unless typedDateTime asks for nanoseconds
+	class ValueSink
+	{
+	public:
+		ValueSink( std::vector<FieldValue> &fields, const FieldFilter *filter = 0, bool typedDateTime = false ) :
+		 _fields( fields ), _filter( filter ), _typedDateTime( typedDateTime ) {}
+
+		bool	accepts( rfa::common::Int16 fieldId ) const	{ return !_filter || _filter->accepts( fieldId ); }
+		bool	typedDateTime() const						{ return _typedDateTime; }
+
+		void	blank( rfa::common::Int16 fieldId, const Entry * )
+		{
+			push( fieldId );
+		}
+		void	string( rfa::common::Int16 fieldId, const Entry *, const std::string &value )
+		{
+			FieldValue &field = push( fieldId );
+			field.type = FieldValue::StringEnum;
+			field.stringValue = value;
+		}
+		void	number( rfa::common::Int16 fieldId, const Entry *, double value )
+		{
+			FieldValue &field = push( fieldId );
+			field.type = FieldValue::DoubleEnum;
+			field.doubleValue = value;
+		}
+		void	integer( rfa::common::Int16 fieldId, const Entry *, rfa::common::Int64 value, FieldValue::ValueType type )
+		{
+			FieldValue &field = push( fieldId );
+			field.type = type;
+			field.longValue = value;
+		}
+		void	real( rfa::common::Int16 fieldId, const Entry *, const RealValue &value )
+		{
+			FieldValue &field = push( fieldId );
+			field.type = FieldValue::RealEnum;
+			field.longValue = value.getMantissa();
+			field.hint = value.getHint();
+		}
+		void	dateTime( rfa::common::Int16 fieldId, const Entry *, FieldValue::ValueType type, rfa::common::Int64 nanos )
+		{
+			FieldValue &field = push( fieldId );
+			field.type = type;
+			field.longValue = nanos;
+		}
+
+	private:
+		FieldValue&	push( rfa::common::Int16 fieldId )
+		{
+			_fields.push_back( FieldValue() );
+			_fields.back().fieldId = fieldId;
+			return _fields.back();
+		}
+
+		std::vector<FieldValue>	&_fields;
+		const FieldFilter		*_filter;
+		bool					_typedDateTime;
+	};
+
+	// decode one field into sink, whether it accepts the FID is not asked
+	template <class Sink>
+	void			decodeField( const rfa::data::FieldEntry &field, Sink &sink ) const;
+	// every field of fieldList the sink accepts
+	template <class Sink>
+	void			decodeFieldList( const rfa::data::FieldList &fieldList, Sink &sink ) const
+	{
+		rfa::data::FieldListReadIterator flri;
+		for ( flri.start( fieldList ); !flri.off(); flri.forth() )
+		{
+			if ( sink.accepts( flri.value().getFieldID() ) )
+				decodeField( flri.value(), sink );
+		}
+	}
+
+	// put a native field value into d under its name, or under its FID when unknown
+	void			setField( boost::python::dict &d, const FieldValue &value ) const;
+	// the name of a FID, the FID itself when unknown
+	boost::python::object	getFieldKey( rfa::common::Int16 fieldId ) const;
+	// the python object a dict gets for a native field value
+	boost::python::object	toPython( const FieldValue &value ) const;
+
+	static Converter	converterFor( rfa::common::UInt8 dataBufferType );
+	static bool			isDateTime( Converter converter )	{ return converter >= DateConverter; }
+
+	// interned key or value, borrowed reference
+	PyObject*		getKey( FixedKey key ) const	{ return _fixedKeys[key]; }
+	void			setItem( boost::python::dict &d, FixedKey key, FixedKey value ) const;
+	void			setItem( boost::python::dict &d, FixedKey key, const std::string &value ) const;
+	void			setItem( boost::python::dict &d, FixedKey key, const boost::python::object &value ) const;
+
+	// a dict with room for size keys, or for the fields of fieldList plus extra fixed keys
+	static boost::python::dict	newDict( Py_ssize_t size );
+	static boost::python::dict	newDict( const rfa::data::FieldList &fieldList, Py_ssize_t extra );
+	// a list of size Nones
+	static boost::python::list	newList( Py_ssize_t size );
+	static PyObject*			intern( const char *str );
+
+private:
+	const rfa::data::DataBuffer&	getDataBuffer( const rfa::data::FieldEntry &field, const Entry *entry, Converter &converter ) const;
+	// enumeration text, the tick direction glyphs swapped for UTF-8 arrows
+	static std::string				enumToString( const rfa::data::DataBuffer &dataBuffer, const Entry &entry );
+	static std::string				trimmedString( const rfa::data::DataBuffer &dataBuffer );
+	static FieldValue::ValueType	dateTimeType( Converter converter );
+	// nanoseconds of a date/time buffer, false if it is blank
+	static bool						dateTimeToNanos( const rfa::data::DataBuffer &dataBuffer, Converter converter, rfa::common::Int64 &nanos );
+	boost::python::object			dateTimeToPython( FieldValue::ValueType type, rfa::common::Int64 nanos ) const;
+	// false if the buffer is not a REAL32 or REAL64
+	static bool						getReal( const rfa::data::DataBuffer &dataBuffer, RealValue &real );
+
+	std::vector<Entry>	_posEntries;
+	std::vector<Entry>	_negEntries;
+	bool				_isBuilt;
+	DateTimeMode		_dateTimeMode;
+	RealMode			_realMode;
+	PyObject			*_fixedKeys[FixedKeyCount];
+
+	friend class DictSink;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	FieldDecodeTable( const FieldDecodeTable & );
+	FieldDecodeTable & operator=( const FieldDecodeTable & );
+};
+
+template <class Sink>
+void FieldDecodeTable::decodeField( const rfa::data::FieldEntry &field, Sink &sink ) const
+{
+	const rfa::common::Int16 fieldId = field.getFieldID();
+	const Entry *entry = getEntry( fieldId );
+	Converter converter;
+	const rfa::data::DataBuffer &dataBuffer = getDataBuffer( field, entry, converter );
+
+	// if field name does not exist, the string under the FID
+	if ( !entry )
+	{
+		sink.string( fieldId, 0, trimmedString( dataBuffer ) );
+		return;
+	}
+
+	switch ( converter )
+	{
+	case EnumConverter:
+		sink.string( fieldId, entry, enumToString( dataBuffer, *entry ) );
+		break;
+	case DoubleConverter:
+	{
+		RealValue real;
+		if ( dataBuffer.isBlank() )
+			sink.blank( fieldId, entry );
+		else if ( _realMode == RealDecimal && getReal( dataBuffer, real ) )
+			sink.real( fieldId, entry, real );
+		else
+			sink.number( fieldId, entry, RDMUtils::dataBufferToDouble( dataBuffer ) );
+		break;
+	}
+	case IntConverter:
+		if ( dataBuffer.isBlank() )
+			sink.blank( fieldId, entry );
+		else
+			sink.integer( fieldId, entry, RDMUtils::dataBufferToInt( dataBuffer ), FieldValue::IntEnum );
+		break;
+	case LongConverter:
+		if ( dataBuffer.isBlank() )
+			sink.blank( fieldId, entry );
+		else
+			sink.integer( fieldId, entry, RDMUtils::dataBufferToLong( dataBuffer ), FieldValue::LongEnum );
+		break;
+	case DateConverter:
+	case TimeConverter:
+	case DateTimeConverter:
+		if ( sink.typedDateTime() || _dateTimeMode != DateTimeString )
+		{
+			rfa::common::Int64 nanos;
+			if ( dateTimeToNanos( dataBuffer, converter, nanos ) )
+				sink.dateTime( fieldId, entry, dateTimeType( converter ), nanos );
+			else
+				sink.blank( fieldId, entry );
+			break;
+		}
+		// the string RFA formats
+	default:
+		sink.string( fieldId, entry, trimmedString( dataBuffer ) );
+		break;
+	}
+}
+
+#endif // _FIELD_DECODE_TABLE_H_
@@ -0,0 +1,31 @@
+#include "FieldFilter.h"
+
+FieldFilter::FieldFilter() :
+ _size( 0 )
+{
+}
+
+void FieldFilter::set( const std::vector<rfa::common::Int16> &fieldIds )
+{
+	clear();
+	for ( size_t i = 0; i < fieldIds.size(); i++ )
+	{
+		const rfa::common::Int16 fieldId = fieldIds[i];
+		std::vector<bool> &fields = fieldId >= 0 ? _posFields : _negFields;
+		const size_t index = fieldId >= 0 ? (size_t)fieldId : (size_t)-fieldId;
+		if ( index >= fields.size() )
+			fields.resize( index + 1, false );
+		if ( !fields[index] )
+		{
+			fields[index] = true;
+			_size++;
+		}
+	}
+}
+
+void FieldFilter::clear()
+{
+	_posFields.clear();
+	_negFields.clear();
+	_size = 0;
+}
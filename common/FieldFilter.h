@@ -0,0 +1,37 @@
+#ifndef _FIELD_FILTER_H_
+#define _FIELD_FILTER_H_
+
+#include "StdAfx.h"
+
+#include <vector>
+
+// client side projection of field lists, the FIDs a handler decodes.
+// decoders check it before any conversion so the other fields only cost
+// the iteration. indexed by FID like the decode table, an empty set lets
+// every field through.
+class FieldFilter
+{
+public:
+	FieldFilter();
+
+	void			set( const std::vector<rfa::common::Int16> &fieldIds );
+	void			clear();
+	bool			isEnabled() const	{ return _size > 0; }
+	size_t			size() const		{ return _size; }
+
+	bool			accepts( rfa::common::Int16 fieldId ) const
+	{
+		if ( _size == 0 )
+			return true;
+		if ( fieldId >= 0 )
+			return fieldId < (rfa::common::Int)_posFields.size() && _posFields[fieldId];
+		return -fieldId < (rfa::common::Int)_negFields.size() && _negFields[-fieldId];
+	}
+
+private:
+	std::vector<bool>	_posFields;
+	std::vector<bool>	_negFields;
+	size_t				_size;
+};
+
+#endif // _FIELD_FILTER_H_
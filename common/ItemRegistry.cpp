@@ -0,0 +1,131 @@
+#include "ItemRegistry.h"
+
+using namespace boost::python;
+
+static object pyString( PyObject *&cache, const std::string &value )
+{
+	if ( !cache )
+		cache = incref( object( value ).ptr() );
+	return object( handle<>( borrowed( cache ) ) );
+}
+
+object ItemInfo::getPyItemName() const
+{
+	return pyString( pyItemName, itemName );
+}
+
+object ItemInfo::getPyServiceName() const
+{
+	return pyString( pyServiceName, serviceName );
+}
+
+ItemRegistry::ItemRegistry()
+{
+}
+
+ItemRegistry::~ItemRegistry()
+{
+	clear();
+}
+
+bool ItemRegistry::add( rfa::common::Handle *handle, const std::string &itemName, const std::string &serviceName )
+{
+	ItemKey name( serviceName, itemName );
+	if ( _byHandle.find( handle ) != _byHandle.end() || _byName.find( name ) != _byName.end() )
+		return false;
+
+	ItemInfo *item = new ItemInfo();
+	item->itemName = itemName;
+	item->serviceName = serviceName;
+	item->watchName = itemName + "." + serviceName;
+	item->pyItemName = 0;
+	item->pyServiceName = 0;
+
+	_byHandle[handle] = item;
+	_byName[name] = handle;
+	return true;
+}
+
+bool ItemRegistry::remove( rfa::common::Handle *handle )
+{
+	HandleIndex::iterator it = _byHandle.find( handle );
+	if ( it == _byHandle.end() )
+		return false;
+
+	ItemInfo *item = it->second;
+	_byName.erase( ItemKey( item->serviceName, item->itemName ) );
+	_byHandle.erase( it );
+	if ( item->pyItemName || item->pyServiceName )
+		_removed.push_back( item );
+	else
+		delete item;
+	return true;
+}
+
+void ItemRegistry::clear()
+{
+	for ( HandleIndex::iterator it = _byHandle.begin(); it != _byHandle.end(); ++it )
+		_removed.push_back( it->second );
+	_byHandle.clear();
+	_byName.clear();
+	_pending.clear();
+	_batches.clear();
+	collect();
+}
+
+// drop the items removed since the last call
+void ItemRegistry::collect()
+{
+	for ( size_t i = 0; i < _removed.size(); i++ )
+	{
+		Py_XDECREF( _removed[i]->pyItemName );
+		Py_XDECREF( _removed[i]->pyServiceName );
+		delete _removed[i];
+	}
+	_removed.clear();
+}
+
+const ItemInfo* ItemRegistry::find( rfa::common::Handle *handle ) const
+{
+	HandleIndex::const_iterator it = _byHandle.find( handle );
+	return it != _byHandle.end() ? it->second : 0;
+}
+
+rfa::common::Handle* ItemRegistry::findHandle( const std::string &itemName, const std::string &serviceName ) const
+{
+	NameIndex::const_iterator it = _byName.find( ItemKey( serviceName, itemName ) );
+	return it != _byName.end() ? it->second : 0;
+}
+
+void ItemRegistry::addPending( const std::string &itemName, const std::string &serviceName )
+{
+	_pending[ItemKey( serviceName, itemName )] = false;
+}
+
+bool ItemRegistry::isPending( const std::string &itemName, const std::string &serviceName ) const
+{
+	PendingIndex::const_iterator it = _pending.find( ItemKey( serviceName, itemName ) );
+	return it != _pending.end() && !it->second;
+}
+
+bool ItemRegistry::cancelPending( const std::string &itemName, const std::string &serviceName )
+{
+	PendingIndex::iterator it = _pending.find( ItemKey( serviceName, itemName ) );
+	if ( it == _pending.end() || it->second )
+		return false;
+	it->second = true;
+	return true;
+}
+
+const ItemInfo* ItemRegistry::adopt( rfa::common::Handle *handle, const std::string &itemName, const std::string &serviceName, bool &cancelled )
+{
+	cancelled = false;
+	PendingIndex::iterator it = _pending.find( ItemKey( serviceName, itemName ) );
+	if ( it == _pending.end() )
+		return 0;
+	cancelled = it->second;
+	_pending.erase( it );
+	if ( cancelled || !add( handle, itemName, serviceName ) )
+		return 0;
+	return find( handle );
+}
@@ -0,0 +1,86 @@
+#ifndef _ITEM_REGISTRY_H_
+#define _ITEM_REGISTRY_H_
+
+#include "Python.h"
+#include "StdAfx.h"
+
+#include <boost/python.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+// one subscribed item, names are split once when it is registered
+struct ItemInfo
+{
+	std::string		itemName;
+	std::string		serviceName;
+	std::string		watchName;		// "item.service" as listed by getWatchList
+
+	// Python strings of the names, made on first use. GIL only
+	boost::python::object	getPyItemName() const;
+	boost::python::object	getPyServiceName() const;
+
+	mutable PyObject		*pyItemName;	// owned references
+	mutable PyObject		*pyServiceName;
+};
+
+// watchlist of a consumer handler.
+// hash indexes from handle to item and from (service, item) to handle
+// so per-message lookups and close/reissue stay constant time.
+class ItemRegistry
+{
+public:
+	typedef boost::unordered_map<rfa::common::Handle*, ItemInfo*>	HandleIndex;
+
+	ItemRegistry();
+	// must be destroyed with the GIL held
+	~ItemRegistry();
+
+	// safe without the GIL, false if the handle or the name is already registered
+	bool					add( rfa::common::Handle *handle, const std::string &itemName, const std::string &serviceName );
+	// safe without the GIL, Python strings of removed items wait for collect()
+	bool					remove( rfa::common::Handle *handle );
+	// GIL required
+	void					clear();
+	void					collect();
+
+	// 0 if not registered
+	const ItemInfo*			find( rfa::common::Handle *handle ) const;
+	rfa::common::Handle*	findHandle( const std::string &itemName, const std::string &serviceName ) const;
+
+	size_t					size() const	{ return _byHandle.size(); }
+	const HandleIndex&		items() const	{ return _byHandle; }
+
+	// batch requests only get item handles with the first response of each item.
+	// items are pending until adopt() registers them under that handle.
+	// a pending item closed before that is only marked, adopt() then sets cancelled
+	// so the caller can close the stream it just learnt about.
+	void					addPending( const std::string &itemName, const std::string &serviceName );
+	bool					isPending( const std::string &itemName, const std::string &serviceName ) const;
+	bool					cancelPending( const std::string &itemName, const std::string &serviceName );
+	const ItemInfo*			adopt( rfa::common::Handle *handle, const std::string &itemName, const std::string &serviceName, bool &cancelled );
+
+	// handles of the batch requests themselves, they carry no item data
+	void					addBatch( rfa::common::Handle *handle )			{ _batches.insert( handle ); }
+	bool					isBatch( rfa::common::Handle *handle ) const	{ return _batches.find( handle ) != _batches.end(); }
+	void					removeBatch( rfa::common::Handle *handle )		{ _batches.erase( handle ); }
+
+private:
+	typedef std::pair<std::string, std::string>					ItemKey;
+	typedef boost::unordered_map<ItemKey, rfa::common::Handle*>	NameIndex;
+	typedef boost::unordered_map<ItemKey, bool>					PendingIndex;	// true once cancelled
+
+	HandleIndex									_byHandle;
+	NameIndex									_byName;
+	PendingIndex								_pending;
+	boost::unordered_set<rfa::common::Handle*>	_batches;
+	std::vector<ItemInfo*>						_removed;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	ItemRegistry( const ItemRegistry & );
+	ItemRegistry & operator=( const ItemRegistry & );
+};
+
+#endif // _ITEM_REGISTRY_H_
@@ -0,0 +1,70 @@
+#include "LastValueCache.h"
+
+#include <algorithm>
+
+static bool fieldIdLess( const FieldValue &a, const FieldValue &b )
+{
+	return a.fieldId < b.fieldId;
+}
+
+LastValueCache::LastValueCache()
+{
+}
+
+void LastValueCache::merge( rfa::common::Handle *handle, const std::vector<FieldValue> &fields, bool reset )
+{
+	mergeFields( _images[handle], fields, reset );
+}
+
+void LastValueCache::mergeFields( Image &image, const std::vector<FieldValue> &fields, bool reset )
+{
+	if ( reset || image.empty() )
+	{
+		image = fields;
+		std::stable_sort( image.begin(), image.end(), fieldIdLess );
+		// a FID repeated in one message keeps its last value
+		Image::iterator out = image.begin();
+		for ( Image::iterator it = image.begin(); it != image.end(); ++it )
+		{
+			if ( out != image.begin() && (out - 1)->fieldId == it->fieldId )
+				*(out - 1) = *it;
+			else
+				*out++ = *it;
+		}
+		image.erase( out, image.end() );
+		return;
+	}
+
+	for ( std::vector<FieldValue>::const_iterator it = fields.begin(); it != fields.end(); ++it )
+	{
+		Image::iterator pos = std::lower_bound( image.begin(), image.end(), *it, fieldIdLess );
+		if ( pos != image.end() && pos->fieldId == it->fieldId )
+			*pos = *it;
+		else
+			image.insert( pos, *it );
+	}
+}
+
+const LastValueCache::Image* LastValueCache::find( rfa::common::Handle *handle ) const
+{
+	boost::unordered_map<rfa::common::Handle*, Image>::const_iterator it = _images.find( handle );
+	return it != _images.end() ? &it->second : 0;
+}
+
+void LastValueCache::remove( rfa::common::Handle *handle )
+{
+	_images.erase( handle );
+}
+
+void LastValueCache::clear()
+{
+	_images.clear();
+}
+
+const FieldValue* LastValueCache::findField( const Image &image, rfa::common::Int16 fieldId )
+{
+	FieldValue key;
+	key.fieldId = fieldId;
+	Image::const_iterator pos = std::lower_bound( image.begin(), image.end(), key, fieldIdLess );
+	return pos != image.end() && pos->fieldId == fieldId ? &*pos : 0;
+}
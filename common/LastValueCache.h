@@ -0,0 +1,39 @@
+#ifndef _LAST_VALUE_CACHE_H_
+#define _LAST_VALUE_CACHE_H_
+
+#include "StdAfx.h"
+#include "EventRecord.h"
+
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+// last value of every field of the subscribed items, merged from refreshes and
+// updates and keyed by the item handles of the watchlist.
+// values stay native, no GIL is needed to maintain the cache.
+class LastValueCache
+{
+public:
+	// fields sorted by FID
+	typedef std::vector<FieldValue>	Image;
+
+	LastValueCache();
+
+	// reset drops the cached image first, for the first part of a refresh
+	void			merge( rfa::common::Handle *handle, const std::vector<FieldValue> &fields, bool reset );
+	// 0 if the item has no image yet
+	const Image*	find( rfa::common::Handle *handle ) const;
+	void			remove( rfa::common::Handle *handle );
+	void			clear();
+
+	size_t			size() const	{ return _images.size(); }
+
+	// value of one field of image, 0 if not cached
+	static const FieldValue*	findField( const Image &image, rfa::common::Int16 fieldId );
+	// merge fields into image by FID
+	static void					mergeFields( Image &image, const std::vector<FieldValue> &fields, bool reset );
+
+private:
+	boost::unordered_map<rfa::common::Handle*, Image>	_images;
+};
+
+#endif // _LAST_VALUE_CACHE_H_
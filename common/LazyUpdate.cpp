@@ -0,0 +1,164 @@
+#include "LazyUpdate.h"
+#include "RDMDict.h"
+
+using namespace boost::python;
+
+LazyUpdate::LazyUpdate( const unsigned char *data, size_t size, const boost::shared_ptr<const RDMFieldDict> &dict,
+						const boost::shared_ptr<const FieldDecodeTable> &decodeTable, const object &ric, const object &service, FieldDecodeTable::FixedKey mtype ) :
+ _payload( data, data + size ),
+ _pDict( dict ),
+ _pDecodeTable( decodeTable ),
+ _complete( false )
+{
+	if ( !_pDict || !_pDecodeTable )
+	{
+		PyErr_SetString( PyExc_RuntimeError, "[LazyUpdate::LazyUpdate] The field dictionary is not loaded." );
+		throw_error_already_set();
+	}
+	_pDecodeTable->setItem( _fields, FieldDecodeTable::RicKey, ric );
+	_pDecodeTable->setItem( _fields, FieldDecodeTable::ServiceKey, service );
+	_pDecodeTable->setItem( _fields, FieldDecodeTable::MTypeKey, mtype );
+}
+
+object LazyUpdate::getItem( const object &key )
+{
+	object value;
+	if ( !find( key, value ) )
+	{
+		PyErr_SetObject( PyExc_KeyError, key.ptr() );
+		throw_error_already_set();
+	}
+	return value;
+}
+
+object LazyUpdate::get( const object &key, const object &defaultValue )
+{
+	object value;
+	return find( key, value ) ? value : defaultValue;
+}
+
+bool LazyUpdate::contains( const object &key )
+{
+	object value;
+	return find( key, value );
+}
+
+size_t LazyUpdate::size()
+{
+	decodeAll();
+	return len( _fields );
+}
+
+boost::python::list LazyUpdate::keys()
+{
+	decodeAll();
+	return boost::python::list( _fields.keys() );
+}
+
+boost::python::list LazyUpdate::values()
+{
+	decodeAll();
+	return boost::python::list( _fields.values() );
+}
+
+boost::python::list LazyUpdate::items()
+{
+	decodeAll();
+	return boost::python::list( _fields.items() );
+}
+
+object LazyUpdate::iter()
+{
+	return object( handle<>( PyObject_GetIter( keys().ptr() ) ) );
+}
+
+dict LazyUpdate::toDict()
+{
+	decodeAll();
+	return _fields.copy();
+}
+
+object LazyUpdate::getRic() const
+{
+	return _fields.get( object( handle<>( borrowed( _pDecodeTable->getKey( FieldDecodeTable::RicKey ) ) ) ) );
+}
+
+bool LazyUpdate::find( const object &key, object &value )
+{
+	PyObject *found = PyDict_GetItem( _fields.ptr(), key.ptr() );
+	if ( found )
+	{
+		value = object( handle<>( borrowed( found ) ) );
+		return true;
+	}
+	if ( _complete )
+		return false;
+
+	// field name, or FID
+	rfa::common::Int16 fieldId;
+	extract<int> fid( key );
+	if ( fid.check() )
+	{
+		fieldId = (rfa::common::Int16)fid();
+	}
+	else
+	{
+		extract<std::string> name( key );
+		if ( !name.check() )
+			return false;
+		const RDMFieldDef *fieldDef = _pDict->getFieldDef( rfa::common::RFA_String( name().c_str() ) );
+		if ( !fieldDef )
+			return false;
+		fieldId = (rfa::common::Int16)fieldDef->getFieldId();
+	}
+	if ( !decodeField( fieldId ) )
+		return false;
+
+	// decoded under its name, or under its FID when it is not in the dictionary
+	const FieldDecodeTable::Entry *entry = _pDecodeTable->getEntry( fieldId );
+	found = entry ? PyDict_GetItem( _fields.ptr(), entry->key ) : PyDict_GetItem( _fields.ptr(), object( fieldId ).ptr() );
+	if ( !found )
+		return false;
+	value = object( handle<>( borrowed( found ) ) );
+	return true;
+}
+
+bool LazyUpdate::decodeField( rfa::common::Int16 fieldId )
+{
+	if ( _payload.empty() )
+		return false;
+
+	rfa::common::Buffer buffer;
+	buffer.setFrom( &_payload[0], (rfa::common::UInt32)_payload.size(), (rfa::common::UInt32)_payload.size() );
+	rfa::data::FieldList fieldList;
+	fieldList.setEncodedBuffer( buffer );
+
+	FieldDecodeTable::DictSink sink( *_pDecodeTable, _fields );
+	rfa::data::FieldListReadIterator flri;
+	for ( flri.start( fieldList ); !flri.off(); flri.forth() )
+	{
+		if ( flri.value().getFieldID() == fieldId )
+		{
+			_pDecodeTable->decodeField( flri.value(), sink );
+			return true;
+		}
+	}
+	return false;
+}
+
+void LazyUpdate::decodeAll()
+{
+	if ( _complete )
+		return;
+	_complete = true;
+	if ( _payload.empty() )
+		return;
+
+	rfa::common::Buffer buffer;
+	buffer.setFrom( &_payload[0], (rfa::common::UInt32)_payload.size(), (rfa::common::UInt32)_payload.size() );
+	rfa::data::FieldList fieldList;
+	fieldList.setEncodedBuffer( buffer );
+
+	FieldDecodeTable::DictSink sink( *_pDecodeTable, _fields );
+	_pDecodeTable->decodeFieldList( fieldList, sink );
+}
@@ -0,0 +1,59 @@
+#ifndef _LAZY_UPDATE_H_
+#define _LAZY_UPDATE_H_
+
+#include "Python.h"
+#include "StdAfx.h"
+#include "FieldDecodeTable.h"
+
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+class RDMFieldDict;
+
+// a market price image or update whose fields are decoded when they are read.
+// it keeps a copy of the encoded field list and decodes one field per lookup
+// with the decode table, decoded fields are kept for later lookups.
+// keys(), items() and toDict() decode the rest in a single pass.
+// keys are the same as in the event dicts. the update shares the dictionary
+// and the decode table, it stays readable after cleanUp() or after its Pyrfa
+// object is gone. GIL only.
+class LazyUpdate
+{
+public:
+	LazyUpdate( const unsigned char *data, size_t size, const boost::shared_ptr<const RDMFieldDict> &dict,
+				const boost::shared_ptr<const FieldDecodeTable> &decodeTable, const boost::python::object &ric, const boost::python::object &service, FieldDecodeTable::FixedKey mtype );
+
+	// field by name, or by FID, KeyError if the update does not carry it
+	boost::python::object	getItem( const boost::python::object &key );
+	boost::python::object	get( const boost::python::object &key, const boost::python::object &defaultValue = boost::python::object() );
+	bool					contains( const boost::python::object &key );
+	size_t					size();
+
+	boost::python::list		keys();
+	boost::python::list		values();
+	boost::python::list		items();
+	boost::python::object	iter();
+	// a plain event dict, a copy
+	boost::python::dict		toDict();
+
+	boost::python::object	getRic() const;
+
+private:
+	// decode the field a key names, false if the update does not carry it
+	bool					find( const boost::python::object &key, boost::python::object &value );
+	bool					decodeField( rfa::common::Int16 fieldId );
+	void					decodeAll();
+
+	std::vector<unsigned char>	_payload;
+	boost::shared_ptr<const RDMFieldDict>		_pDict;
+	boost::shared_ptr<const FieldDecodeTable>	_pDecodeTable;
+	boost::python::dict			_fields;
+	bool						_complete;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	LazyUpdate( const LazyUpdate & );
+	LazyUpdate & operator=( const LazyUpdate & );
+};
+
+#endif // _LAZY_UPDATE_H_
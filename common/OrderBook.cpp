@@ -0,0 +1,222 @@
+#include "OrderBook.h"
+#include "RDMDict.h"
+
+OrderBook::FieldIds::FieldIds() :
+ side( 3428 ),
+ price( 3427 ),
+ size( 3429 ),
+ orders( 3430 )
+{
+}
+
+void OrderBook::FieldIds::resolve( const RDMFieldDict &dict )
+{
+	const RDMFieldDef *fieldDef = dict.getFieldDef( "ORDER_SIDE" );
+	if ( fieldDef )
+		side = (rfa::common::Int16)fieldDef->getFieldId();
+	fieldDef = dict.getFieldDef( "ORDER_PRC" );
+	if ( fieldDef )
+		price = (rfa::common::Int16)fieldDef->getFieldId();
+	fieldDef = dict.getFieldDef( "ORDER_SIZE" );
+	if ( fieldDef )
+		size = (rfa::common::Int16)fieldDef->getFieldId();
+	fieldDef = dict.getFieldDef( "NO_ORD" );
+	if ( fieldDef )
+		orders = (rfa::common::Int16)fieldDef->getFieldId();
+}
+
+void OrderBook::Sink::string( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *, const std::string &value )
+{
+	if ( fieldId != _fieldIds.side )
+		return;
+	if ( value == "BID" || value == "BUY" )
+		setSide( 1 );
+	else if ( value == "ASK" || value == "SELL" )
+		setSide( 2 );
+}
+
+void OrderBook::Sink::number( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *, double value )
+{
+	if ( fieldId == _fieldIds.price )
+	{
+		_change.price = value;
+		_change.mask |= Change::PriceFlag;
+	}
+	else if ( fieldId == _fieldIds.size )
+	{
+		_change.size = value;
+		_change.mask |= Change::SizeFlag;
+	}
+	else if ( fieldId == _fieldIds.orders && value >= 0 )
+	{
+		_change.orders = (size_t)value;
+		_change.mask |= Change::OrdersFlag;
+	}
+}
+
+void OrderBook::Sink::integer( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *entry, rfa::common::Int64 value, FieldValue::ValueType )
+{
+	if ( fieldId == _fieldIds.side )
+		setSide( value );
+	else
+		number( fieldId, entry, (double)value );
+}
+
+void OrderBook::Sink::setSide( rfa::common::Int64 side )
+{
+	if ( side != 1 && side != 2 )
+		return;
+	_change.side = side == 1 ? Bid : Ask;
+	_change.mask |= Change::SideFlag;
+}
+
+OrderBook::OrderBook()
+{
+}
+
+void OrderBook::setOrder( const std::string &key, const Change &change )
+{
+	boost::unordered_map<std::string, rfa::common::Int32>::iterator it = _index.find( key );
+	rfa::common::Int32 index;
+	if ( it == _index.end() )
+	{
+		if ( _free.empty() )
+		{
+			index = (rfa::common::Int32)_orders.size();
+			_orders.push_back( Order() );
+		}
+		else
+		{
+			index = _free.back();
+			_free.pop_back();
+		}
+		Order &order = _orders[index];
+		order.side = Bid;
+		order.price = 0;
+		order.size = 0;
+		order.mask = 0;
+		order.listed = false;
+		order.prev = -1;
+		order.next = -1;
+		_index.insert( std::make_pair( key, index ) );
+	}
+	else
+	{
+		index = it->second;
+	}
+
+	Order &order = _orders[index];
+	const bool moves = ( ( change.mask & Change::SideFlag ) && change.side != order.side )
+		|| ( ( change.mask & Change::PriceFlag ) && change.price != order.price );
+	if ( order.listed && moves )
+		unlink( index );
+
+	// a new size alone keeps the order's place in the queue
+	if ( change.mask & Change::SizeFlag )
+	{
+		if ( order.listed )
+			_levels[order.side].find( levelKey( order.side, order.price ) )->second.aggregate.size += change.size - order.size;
+		order.size = change.size;
+	}
+	if ( change.mask & Change::SideFlag )
+		order.side = change.side;
+	if ( change.mask & Change::PriceFlag )
+		order.price = change.price;
+	order.mask |= change.mask;
+
+	// an order joins a level once its side and price are known
+	if ( !order.listed && ( order.mask & ( Change::SideFlag | Change::PriceFlag ) ) == ( Change::SideFlag | Change::PriceFlag ) )
+		link( index );
+}
+
+void OrderBook::removeOrder( const std::string &key )
+{
+	boost::unordered_map<std::string, rfa::common::Int32>::iterator it = _index.find( key );
+	if ( it == _index.end() )
+		return;
+	if ( _orders[it->second].listed )
+		unlink( it->second );
+	_free.push_back( it->second );
+	_index.erase( it );
+}
+
+void OrderBook::clear()
+{
+	_orders.clear();
+	_free.clear();
+	_index.clear();
+	_levels[Bid].clear();
+	_levels[Ask].clear();
+}
+
+void OrderBook::link( rfa::common::Int32 index )
+{
+	Order &order = _orders[index];
+	Levels::iterator it = _levels[order.side].find( levelKey( order.side, order.price ) );
+	if ( it == _levels[order.side].end() )
+	{
+		Level level;
+		level.aggregate.price = order.price;
+		level.aggregate.size = 0;
+		level.aggregate.orders = 0;
+		level.first = -1;
+		level.last = -1;
+		it = _levels[order.side].insert( std::make_pair( levelKey( order.side, order.price ), level ) ).first;
+	}
+
+	Level &level = it->second;
+	order.prev = level.last;
+	order.next = -1;
+	if ( level.last >= 0 )
+		_orders[level.last].next = index;
+	else
+		level.first = index;
+	level.last = index;
+	level.aggregate.size += order.size;
+	level.aggregate.orders++;
+	order.listed = true;
+}
+
+void OrderBook::unlink( rfa::common::Int32 index )
+{
+	Order &order = _orders[index];
+	Levels::iterator it = _levels[order.side].find( levelKey( order.side, order.price ) );
+	order.listed = false;
+	if ( it == _levels[order.side].end() )
+		return;
+
+	Level &level = it->second;
+	if ( order.prev >= 0 )
+		_orders[order.prev].next = order.next;
+	else
+		level.first = order.next;
+	if ( order.next >= 0 )
+		_orders[order.next].prev = order.prev;
+	else
+		level.last = order.prev;
+	order.prev = -1;
+	order.next = -1;
+	level.aggregate.size -= order.size;
+	if ( --level.aggregate.orders == 0 )
+		_levels[order.side].erase( it );
+}
+
+void OrderBook::getDepth( Side side, size_t depth, Depth &levels ) const
+{
+	levels.clear();
+	for ( Levels::const_iterator it = _levels[side].begin(); it != _levels[side].end() && ( depth == 0 || levels.size() < depth ); ++it )
+		levels.push_back( it->second.aggregate );
+}
+
+const OrderBook::Aggregate* OrderBook::best( Side side ) const
+{
+	return _levels[side].empty() ? 0 : &_levels[side].begin()->second.aggregate;
+}
+
+boost::python::tuple OrderBook::toPython( const Depth &levels )
+{
+	boost::python::list l;
+	for ( size_t i = 0; i < levels.size(); i++ )
+		l.append( boost::python::make_tuple( levels[i].price, levels[i].size, levels[i].orders ) );
+	return boost::python::tuple( l );
+}
@@ -0,0 +1,148 @@
+#ifndef _ORDER_BOOK_H_
+#define _ORDER_BOOK_H_
+
+#include "StdAfx.h"
+#include "FieldDecodeTable.h"
+
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+class RDMFieldDict;
+
+// native order book of one market by order item, maintained from the map actions.
+// orders live in a pool and are hashed by order key, every price level queues its
+// orders in arrival order as an intrusive list through the pool. the levels of a
+// side are sorted best first and carry the aggregated size and order count.
+// no GIL is needed to maintain the book.
+class OrderBook
+{
+public:
+	enum Side { Bid = 0, Ask = 1 };
+
+	// FIDs of the book fields of an entry, ORDER_SIDE, ORDER_PRC, ORDER_SIZE and
+	// NO_ORD, the order count of a market by price level
+	struct FieldIds
+	{
+		FieldIds();
+		// the FIDs of dict, the RDM ones for names it does not have
+		void	resolve( const RDMFieldDict &dict );
+
+		rfa::common::Int16	side;
+		rfa::common::Int16	price;
+		rfa::common::Int16	size;
+		rfa::common::Int16	orders;
+	};
+
+	// book fields of a map entry, the flags tell the ones present
+	struct Change
+	{
+		enum { SideFlag = 1, PriceFlag = 2, SizeFlag = 4, OrdersFlag = 8 };
+
+		Change() : mask( 0 ), side( Bid ), price( 0 ), size( 0 ), orders( 0 ) {}
+
+		rfa::common::UInt8	mask;
+		Side				side;
+		double				price;
+		double				size;
+		size_t				orders;
+	};
+
+	// price, aggregated size and order count of a price level
+	struct Aggregate
+	{
+		double		price;
+		double		size;
+		size_t		orders;
+
+		bool		operator==( const Aggregate &other ) const
+		{
+			return price == other.price && size == other.size && orders == other.orders;
+		}
+	};
+	typedef std::vector<Aggregate>	Depth;
+
+	OrderBook();
+
+	// decode sink of the book fields of an entry, see FieldDecodeTable::decodeFieldList().
+	// ORDER_SIDE is a bid for "BID" or 1 and an ask for "ASK" or 2
+	class Sink
+	{
+	public:
+		Sink( const FieldIds &fieldIds, Change &change ) : _fieldIds( fieldIds ), _change( change ) {}
+
+		bool	accepts( rfa::common::Int16 fieldId ) const
+		{
+			return fieldId == _fieldIds.side || fieldId == _fieldIds.price || fieldId == _fieldIds.size || fieldId == _fieldIds.orders;
+		}
+		bool	typedDateTime() const	{ return true; }
+
+		void	blank( rfa::common::Int16, const FieldDecodeTable::Entry * ) {}
+		void	string( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *, const std::string &value );
+		void	number( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *, double value );
+		void	integer( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *entry, rfa::common::Int64 value, FieldValue::ValueType );
+		void	real( rfa::common::Int16 fieldId, const FieldDecodeTable::Entry *entry, const RealValue &value )
+		{
+			number( fieldId, entry, value.toDouble() );
+		}
+		void	dateTime( rfa::common::Int16, const FieldDecodeTable::Entry *, FieldValue::ValueType, rfa::common::Int64 ) {}
+
+	private:
+		void	setSide( rfa::common::Int64 side );
+
+		const FieldIds	&_fieldIds;
+		Change			&_change;
+	};
+
+	// add an order, or change the fields of an order in the book
+	void			setOrder( const std::string &key, const Change &change );
+	void			removeOrder( const std::string &key );
+	void			clear();
+
+	// the best levels of a side, all of them for depth 0
+	void			getDepth( Side side, size_t depth, Depth &levels ) const;
+	// 0 if the side is empty
+	const Aggregate*	best( Side side ) const;
+	size_t			orders() const	{ return _index.size(); }
+
+	// levels as a tuple of ( price, size, orders ) tuples. GIL required
+	static boost::python::tuple	toPython( const Depth &levels );
+
+private:
+	struct Order
+	{
+		Side				side;
+		double				price;
+		double				size;
+		rfa::common::UInt8	mask;		// Change flags of the fields known
+		bool				listed;		// queued in a level
+		rfa::common::Int32	prev;
+		rfa::common::Int32	next;
+	};
+
+	struct Level
+	{
+		Aggregate			aggregate;
+		rfa::common::Int32	first;
+		rfa::common::Int32	last;
+	};
+
+	// bids are keyed by the negated price so that both sides sort best first
+	typedef std::map<double, Level>	Levels;
+
+	static double		levelKey( Side side, double price )	{ return side == Bid ? -price : price; }
+	void				link( rfa::common::Int32 index );
+	void				unlink( rfa::common::Int32 index );
+
+	std::vector<Order>										_orders;
+	std::vector<rfa::common::Int32>							_free;
+	boost::unordered_map<std::string, rfa::common::Int32>	_index;
+	Levels													_levels[2];
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	OrderBook( const OrderBook & );
+	OrderBook & operator=( const OrderBook & );
+};
+
+#endif // _ORDER_BOOK_H_
@@ -0,0 +1,137 @@
+#include "PriceBook.h"
+
+#include <algorithm>
+
+// best first, bids by descending and asks by ascending price
+struct LevelOrder
+{
+	LevelOrder( OrderBook::Side side ) : bid( side == OrderBook::Bid ) {}
+
+	template <class Level>
+	bool	operator()( const Level &level, double price ) const
+	{
+		return bid ? level.aggregate.price > price : level.aggregate.price < price;
+	}
+
+	bool	bid;
+};
+
+PriceBook::PriceBook() :
+ _nextId( 0 )
+{
+}
+
+bool PriceBook::listed( const Slot &slot )
+{
+	return ( slot.mask & ( OrderBook::Change::SideFlag | OrderBook::Change::PriceFlag ) ) == ( OrderBook::Change::SideFlag | OrderBook::Change::PriceFlag );
+}
+
+std::vector<PriceBook::Level>::iterator PriceBook::lowerBound( OrderBook::Side side, double price )
+{
+	return std::lower_bound( _levels[side].begin(), _levels[side].end(), price, LevelOrder( side ) );
+}
+
+void PriceBook::list( const Slot &slot )
+{
+	Level level;
+	level.aggregate = slot.aggregate;
+	level.id = slot.id;
+	// after the levels of the same price
+	std::vector<Level>::iterator it = lowerBound( slot.side, slot.aggregate.price );
+	while ( it != _levels[slot.side].end() && it->aggregate.price == slot.aggregate.price )
+		++it;
+	_levels[slot.side].insert( it, level );
+}
+
+void PriceBook::unlist( const Slot &slot )
+{
+	for ( std::vector<Level>::iterator it = lowerBound( slot.side, slot.aggregate.price );
+		it != _levels[slot.side].end() && it->aggregate.price == slot.aggregate.price; ++it )
+	{
+		if ( it->id == slot.id )
+		{
+			_levels[slot.side].erase( it );
+			return;
+		}
+	}
+}
+
+void PriceBook::setLevel( const std::string &key, const OrderBook::Change &change )
+{
+	boost::unordered_map<std::string, Slot>::iterator it = _slots.find( key );
+	if ( it == _slots.end() )
+	{
+		Slot slot;
+		slot.id = _nextId++;
+		slot.mask = 0;
+		slot.aggregate.price = 0;
+		slot.aggregate.size = 0;
+		slot.aggregate.orders = 0;
+		slot.side = OrderBook::Bid;
+		it = _slots.insert( std::make_pair( key, slot ) ).first;
+	}
+
+	Slot &slot = it->second;
+	const bool wasListed = listed( slot );
+	const bool moves = ( ( change.mask & OrderBook::Change::SideFlag ) && change.side != slot.side )
+		|| ( ( change.mask & OrderBook::Change::PriceFlag ) && change.price != slot.aggregate.price );
+	if ( wasListed && moves )
+		unlist( slot );
+
+	if ( change.mask & OrderBook::Change::SideFlag )
+		slot.side = change.side;
+	if ( change.mask & OrderBook::Change::PriceFlag )
+		slot.aggregate.price = change.price;
+	if ( change.mask & OrderBook::Change::SizeFlag )
+		slot.aggregate.size = change.size;
+	if ( change.mask & OrderBook::Change::OrdersFlag )
+		slot.aggregate.orders = change.orders;
+	slot.mask |= change.mask;
+
+	if ( !listed( slot ) )
+		return;
+	if ( wasListed && !moves )
+	{
+		// a new size or order count, in place
+		for ( std::vector<Level>::iterator level = lowerBound( slot.side, slot.aggregate.price );
+			level != _levels[slot.side].end() && level->aggregate.price == slot.aggregate.price; ++level )
+		{
+			if ( level->id == slot.id )
+			{
+				level->aggregate = slot.aggregate;
+				return;
+			}
+		}
+	}
+	list( slot );
+}
+
+void PriceBook::removeLevel( const std::string &key )
+{
+	boost::unordered_map<std::string, Slot>::iterator it = _slots.find( key );
+	if ( it == _slots.end() )
+		return;
+	if ( listed( it->second ) )
+		unlist( it->second );
+	_slots.erase( it );
+}
+
+void PriceBook::clear()
+{
+	_slots.clear();
+	_levels[OrderBook::Bid].clear();
+	_levels[OrderBook::Ask].clear();
+}
+
+void PriceBook::getDepth( OrderBook::Side side, size_t depth, OrderBook::Depth &levels ) const
+{
+	const size_t count = depth == 0 ? _levels[side].size() : std::min( depth, _levels[side].size() );
+	levels.resize( count );
+	for ( size_t i = 0; i < count; i++ )
+		levels[i] = _levels[side][i].aggregate;
+}
+
+const OrderBook::Aggregate* PriceBook::best( OrderBook::Side side ) const
+{
+	return _levels[side].empty() ? 0 : &_levels[side].front().aggregate;
+}
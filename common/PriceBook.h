@@ -0,0 +1,63 @@
+#ifndef _PRICE_BOOK_H_
+#define _PRICE_BOOK_H_
+
+#include "StdAfx.h"
+#include "OrderBook.h"
+
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <vector>
+
+// native price level book of one market by price item, maintained from the map
+// actions. every side is a contiguous array of levels sorted best first, found
+// by binary search on the price, and the map keys are hashed to their level.
+// no GIL is needed to maintain the book.
+class PriceBook
+{
+public:
+	PriceBook();
+
+	// add a level, or change the fields of a level in the book.
+	// a level is listed once its side and price are known
+	void			setLevel( const std::string &key, const OrderBook::Change &change );
+	void			removeLevel( const std::string &key );
+	void			clear();
+
+	// the best levels of a side, all of them for depth 0
+	void			getDepth( OrderBook::Side side, size_t depth, OrderBook::Depth &levels ) const;
+	// 0 if the side is empty
+	const OrderBook::Aggregate*	best( OrderBook::Side side ) const;
+	size_t			levels() const	{ return _slots.size(); }
+
+private:
+	// fields of a map key, its level is listed when side and price are known
+	struct Slot
+	{
+		rfa::common::Int32		id;
+		rfa::common::UInt8		mask;
+		OrderBook::Aggregate	aggregate;
+		OrderBook::Side			side;
+	};
+
+	struct Level
+	{
+		OrderBook::Aggregate	aggregate;
+		rfa::common::Int32		id;
+	};
+
+	static bool		listed( const Slot &slot );
+	// first level of side not better than price
+	std::vector<Level>::iterator	lowerBound( OrderBook::Side side, double price );
+	void			list( const Slot &slot );
+	void			unlist( const Slot &slot );
+
+	boost::unordered_map<std::string, Slot>	_slots;
+	std::vector<Level>						_levels[2];
+	rfa::common::Int32						_nextId;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	PriceBook( const PriceBook & );
+	PriceBook & operator=( const PriceBook & );
+};
+
+#endif // _PRICE_BOOK_H_
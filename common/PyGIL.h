@@ -0,0 +1,36 @@
+#ifndef _C_PYGIL_H_
+#define _C_PYGIL_H_
+
+#include "Python.h"
+
+// release the Python GIL for the lifetime of the object.
+// the calling thread must hold the GIL on construction.
+class CPyGILRelease
+{
+public:
+	CPyGILRelease() : _state( PyEval_SaveThread() ) {}
+	~CPyGILRelease()								{ PyEval_RestoreThread( _state ); }
+private:
+	PyThreadState *_state;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	CPyGILRelease( const CPyGILRelease & );
+	CPyGILRelease & operator=( const CPyGILRelease & );
+};
+
+// acquire the Python GIL for the lifetime of the object.
+// safe to nest and safe to use from a thread that already holds the GIL.
+class CPyGILEnsure
+{
+public:
+	CPyGILEnsure() : _state( PyGILState_Ensure() ) {}
+	~CPyGILEnsure()								{ PyGILState_Release( _state ); }
+private:
+	PyGILState_STATE _state;
+
+	// Declared, but not implemented to prevent default behavior generated by compiler
+	CPyGILEnsure( const CPyGILEnsure & );
+	CPyGILEnsure & operator=( const CPyGILEnsure & );
+};
+
+#endif // _C_PYGIL_H_
@@ -1,5 +1,6 @@
 #include "common/RDMUtils.h"
 #include "common/RDMDictDef.h"
+#include "common/RealValue.h"
 #include <boost/lexical_cast.hpp>
 
 #include <sstream>
@@ -17,11 +18,11 @@ double RDMUtils::dataBufferToDouble(const rfa::data::DataBuffer& dataBuffer) {
         ret = dataBuffer.getDouble();
         break;
     case rfa::data::DataBuffer::Real32Enum:
+        // from the mantissa, getDouble() may turn 4.6 into 4.6000000000000005
+        ret = RealValue(dataBuffer.getReal32().getValue(), dataBuffer.getReal32().getMagnitudeType()).toDouble();
+        break;
     case rfa::data::DataBuffer::Real64Enum:
-        // Workaround: this may causes,for example, 4.6 tp become 4.6000000000000005 in python
-        // use scale to limit decimal point
-        ret = dataBuffer.getDouble();
-        //ret = floor(ret / scale) * scale;
+        ret = RealValue(dataBuffer.getReal().getValue(), dataBuffer.getReal().getMagnitudeType()).toDouble();
         break;
     default:
         ret = -1;
@@ -319,3 +320,26 @@ string RDMUtils::msgRespTypeToString(rfa::common::UInt32 respType)
             return "Invalid Response Type";
     }
 }
+
+void RDMUtils::encodeBatchItemList(const vector<string>& itemNames, rfa::data::ElementListWriteIterator& elwiter)
+{
+    rfa::data::ElementEntry element;
+    rfa::data::Array itemList;
+    rfa::data::ArrayWriteIterator arrWIt;
+    rfa::data::ArrayEntry arrayEntry;
+    rfa::data::DataBuffer dataBuffer;
+
+    arrWIt.start(itemList);
+    for(size_t i = 0; i < itemNames.size(); i++) {
+        dataBuffer.clear();
+        arrayEntry.clear();
+        dataBuffer.setFromString(itemNames[i].c_str(), rfa::data::DataBuffer::StringAsciiEnum);
+        arrayEntry.setData(dataBuffer);
+        arrWIt.bind(arrayEntry);
+    }
+    arrWIt.complete();
+
+    element.setName(rfa::rdm::ENAME_BATCH_ITEM_LIST);
+    element.setData(static_cast<const rfa::common::Data&>(itemList));
+    elwiter.bind(element);
+}
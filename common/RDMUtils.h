@@ -2,6 +2,7 @@
 #define RDMUTILS_H
 
 #include "StdAfx.h"
+#include <vector>
 
 class RDMEnumDef;
 
@@ -35,6 +36,9 @@ public:
     // converts response type to string
     static string msgRespTypeToString(rfa::common::UInt32 respType);
 
+    // encodes the :ItemList element of a batch request
+    static void encodeBatchItemList(const vector<string>& itemNames, rfa::data::ElementListWriteIterator& elwiter);
+
 private:
     RDMUtils(void);
     RDMUtils(RDMUtils&);   
@@ -0,0 +1,258 @@
+#include "RealValue.h"
+
+#include <boost/lexical_cast.hpp>
+#include <limits>
+
+static const double powersOfTen[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14
+};
+
+static const rfa::common::Int64 maxMantissa = std::numeric_limits<rfa::common::Int64>::max();
+
+// mantissa * factor, false on overflow
+static bool multiply( rfa::common::Int64 &mantissa, rfa::common::Int64 factor )
+{
+	if ( mantissa > maxMantissa / factor || mantissa < -( maxMantissa / factor ) )
+		return false;
+	mantissa *= factor;
+	return true;
+}
+
+static std::string digitsOf( rfa::common::Int64 mantissa )
+{
+	// the magnitude as unsigned, the lowest Int64 has no positive counterpart
+	const rfa::common::UInt64 magnitude = mantissa < 0 ? 0 - (rfa::common::UInt64)mantissa : (rfa::common::UInt64)mantissa;
+	return boost::lexical_cast<std::string>( magnitude );
+}
+
+bool RealValue::fromExponent( rfa::common::Int64 mantissa, int exponent, RealValue &value )
+{
+	if ( exponent < rfa::data::ExponentNeg14 - rfa::data::Exponent0 || exponent > rfa::data::Exponent7 - rfa::data::Exponent0 )
+		return false;
+	value = RealValue( mantissa, (rfa::common::UInt8)( exponent + rfa::data::Exponent0 ) );
+	return true;
+}
+
+bool RealValue::fromString( const std::string &str, RealValue &value )
+{
+	if ( str == "inf" || str == "+inf" )
+	{
+		value = RealValue( 0, rfa::data::Infinity );
+		return true;
+	}
+	if ( str == "-inf" )
+	{
+		value = RealValue( 0, rfa::data::NegInfinity );
+		return true;
+	}
+	if ( str == "nan" )
+	{
+		value = RealValue( 0, rfa::data::NotANumber );
+		return true;
+	}
+
+	size_t pos = 0;
+	const bool negative = pos < str.size() && str[pos] == '-';
+	if ( pos < str.size() && ( str[pos] == '-' || str[pos] == '+' ) )
+		pos++;
+
+	// digits, with a decimal point
+	rfa::common::Int64 mantissa = 0;
+	int exponent = 0;
+	bool digits = false;
+	bool point = false;
+	for ( ; pos < str.size(); pos++ )
+	{
+		const char c = str[pos];
+		if ( c == '.' && !point )
+		{
+			point = true;
+			continue;
+		}
+		if ( c < '0' || c > '9' )
+			break;
+		if ( !multiply( mantissa, 10 ) || mantissa > maxMantissa - ( c - '0' ) )
+			return false;
+		mantissa += c - '0';
+		digits = true;
+		if ( point )
+			exponent--;
+	}
+	if ( !digits )
+		return false;
+	if ( negative )
+		mantissa = -mantissa;
+
+	// fraction, the denominator a power of two up to 256
+	if ( pos < str.size() && str[pos] == '/' )
+	{
+		if ( point )
+			return false;
+		rfa::common::Int64 denominator;
+		try
+		{
+			denominator = boost::lexical_cast<rfa::common::Int64>( str.substr( pos + 1 ) );
+		}
+		catch ( boost::bad_lexical_cast & )
+		{
+			return false;
+		}
+		for ( int hint = rfa::data::Divisor1; hint <= rfa::data::Divisor256; hint++ )
+		{
+			if ( denominator == (rfa::common::Int64)1 << ( hint - rfa::data::Divisor1 ) )
+			{
+				value = RealValue( mantissa, (rfa::common::UInt8)hint );
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// scientific notation
+	if ( pos < str.size() && ( str[pos] == 'E' || str[pos] == 'e' ) )
+	{
+		try
+		{
+			exponent += boost::lexical_cast<int>( str.substr( pos + 1 ) );
+		}
+		catch ( boost::bad_lexical_cast & )
+		{
+			return false;
+		}
+		pos = str.size();
+	}
+	if ( pos != str.size() )
+		return false;
+
+	// into the range of the hints, without losing digits
+	while ( exponent > rfa::data::Exponent7 - rfa::data::Exponent0 )
+	{
+		if ( !multiply( mantissa, 10 ) )
+			return false;
+		exponent--;
+	}
+	while ( exponent < rfa::data::ExponentNeg14 - rfa::data::Exponent0 && mantissa % 10 == 0 )
+	{
+		mantissa /= 10;
+		exponent++;
+	}
+	return fromExponent( mantissa, exponent, value );
+}
+
+int RealValue::getExponent() const
+{
+	return _hint <= rfa::data::Exponent7 ? _hint - rfa::data::Exponent0 : 0;
+}
+
+rfa::common::Int64 RealValue::getDenominator() const
+{
+	if ( _hint >= rfa::data::Divisor1 && _hint <= rfa::data::Divisor256 )
+		return (rfa::common::Int64)1 << ( _hint - rfa::data::Divisor1 );
+	return 1;
+}
+
+double RealValue::toDouble() const
+{
+	if ( _hint == rfa::data::Infinity )
+		return std::numeric_limits<double>::infinity();
+	if ( _hint == rfa::data::NegInfinity )
+		return -std::numeric_limits<double>::infinity();
+	if ( _hint > rfa::data::Divisor256 )
+		return std::numeric_limits<double>::quiet_NaN();
+
+	// a single correctly rounded division, 4.6 is the double nearest to 4.6
+	const int exponent = getExponent();
+	if ( exponent < 0 )
+		return (double)_mantissa / powersOfTen[-exponent];
+	if ( exponent > 0 )
+		return (double)_mantissa * powersOfTen[exponent];
+	return (double)_mantissa / (double)getDenominator();
+}
+
+std::string RealValue::toString() const
+{
+	if ( _hint == rfa::data::Infinity )
+		return "inf";
+	if ( _hint == rfa::data::NegInfinity )
+		return "-inf";
+	if ( _hint > rfa::data::Divisor256 )
+		return "nan";
+
+	std::string str = digitsOf( _mantissa );
+	const int exponent = getExponent();
+	if ( exponent < 0 )
+	{
+		// as many decimals as the hint has, 460 with ExponentNeg2 is 4.60
+		const size_t decimals = (size_t)-exponent;
+		if ( str.size() <= decimals )
+			str.insert( 0, decimals - str.size() + 1, '0' );
+		str.insert( str.size() - decimals, 1, '.' );
+	}
+	else if ( exponent > 0 )
+	{
+		str += 'E';
+		str += boost::lexical_cast<std::string>( exponent );
+	}
+	else if ( getDenominator() > 1 )
+	{
+		str += '/';
+		str += boost::lexical_cast<std::string>( getDenominator() );
+	}
+	return _mantissa < 0 ? '-' + str : str;
+}
+
+std::string RealValue::repr() const
+{
+	if ( _hint <= rfa::data::Exponent7 )
+		return "Real(" + boost::lexical_cast<std::string>( _mantissa ) + ", " + boost::lexical_cast<std::string>( getExponent() ) + ")";
+	return "Real.fromHint(" + boost::lexical_cast<std::string>( _mantissa ) + ", " + boost::lexical_cast<std::string>( (int)_hint ) + ")";
+}
+
+bool RealValue::normalize( rfa::common::Int64 &mantissa, int &exponent ) const
+{
+	if ( _hint > rfa::data::Divisor256 )
+		return false;
+
+	mantissa = _mantissa;
+	exponent = getExponent();
+	// m / 2^n is m * 5^n / 10^n
+	for ( rfa::common::Int64 denominator = getDenominator(); denominator > 1; denominator /= 2 )
+	{
+		if ( !multiply( mantissa, 5 ) )
+			return false;
+		exponent--;
+	}
+	if ( mantissa == 0 )
+	{
+		exponent = 0;
+		return true;
+	}
+	while ( mantissa % 10 == 0 )
+	{
+		mantissa /= 10;
+		exponent++;
+	}
+	return true;
+}
+
+bool RealValue::operator==( const RealValue &other ) const
+{
+	rfa::common::Int64 mantissa, otherMantissa;
+	int exponent, otherExponent;
+	if ( normalize( mantissa, exponent ) && other.normalize( otherMantissa, otherExponent ) )
+		return mantissa == otherMantissa && exponent == otherExponent;
+
+	// infinities are equal to themselves, NaN to nothing
+	return _hint == other._hint && _hint != rfa::data::NotANumber
+		&& ( _hint == rfa::data::Infinity || _hint == rfa::data::NegInfinity || _mantissa == other._mantissa );
+}
+
+long RealValue::hash() const
+{
+	rfa::common::Int64 mantissa;
+	int exponent;
+	if ( !normalize( mantissa, exponent ) )
+		return _hint;
+	return (long)( mantissa ^ ( mantissa >> 32 ) ) * 31 + exponent;
+}
@@ -0,0 +1,47 @@
+#ifndef _REAL_VALUE_H_
+#define _REAL_VALUE_H_
+
+#include "StdAfx.h"
+
+#include <string>
+
+// an RFA Real32/Real64 kept exact, its mantissa and magnitude type (hint).
+// exponent hints are mantissa * 10^exponent, divisor hints mantissa / 2^n.
+// the double is only computed when asked for, the string is exact and is
+// what the encoder parses back into the same mantissa and hint.
+class RealValue
+{
+public:
+	RealValue() : _mantissa( 0 ), _hint( rfa::data::Exponent0 ) {}
+	RealValue( rfa::common::Int64 mantissa, rfa::common::UInt8 hint ) : _mantissa( mantissa ), _hint( hint ) {}
+
+	// false if the exponent is not in -14 to 7
+	static bool				fromExponent( rfa::common::Int64 mantissa, int exponent, RealValue &value );
+	// decimal "-4.60", scientific "46E2", fraction "13/4" and "inf", "-inf", "nan".
+	// false if str is none of them or does not fit the hints
+	static bool				fromString( const std::string &str, RealValue &value );
+
+	rfa::common::Int64		getMantissa() const		{ return _mantissa; }
+	rfa::common::UInt8		getHint() const			{ return _hint; }
+	// 0 for divisor hints
+	int						getExponent() const;
+	// 1 for exponent hints
+	rfa::common::Int64		getDenominator() const;
+
+	double					toDouble() const;
+	std::string				toString() const;
+	std::string				repr() const;
+	// same value, whatever the hints
+	bool					operator==( const RealValue &other ) const;
+	bool					operator!=( const RealValue &other ) const	{ return !( *this == other ); }
+	long					hash() const;
+
+private:
+	// value as mantissa * 10^exponent without trailing zeros, false if it does not fit or is no number
+	bool					normalize( rfa::common::Int64 &mantissa, int &exponent ) const;
+
+	rfa::common::Int64		_mantissa;
+	rfa::common::UInt8		_hint;
+};
+
+#endif // _REAL_VALUE_H_
@@ -0,0 +1,99 @@
+#include "RequestScheduler.h"
+
+RequestScheduler::RequestScheduler() :
+ _window( 0 ),
+ _timeout( 0 ),
+ _seq( 0 ),
+ _sentCount( 0 ),
+ _completeCount( 0 ),
+ _expiredCount( 0 )
+{
+}
+
+void RequestScheduler::setTimeout( long timeout )
+{
+	_timeout = timeout > 0 ? timeout : 0;
+	if ( _timeout == 0 )
+		_sent.clear();
+}
+
+bool RequestScheduler::enqueue( const Request &request, int priority )
+{
+	if ( _queued.find( request.itemName ) != _queued.end() || _outstanding.find( request.itemName ) != _outstanding.end() )
+		return false;
+
+	Entry entry;
+	entry.request = request;
+	entry.seq = ++_seq;
+	_queue[priority].push_back( entry );
+	_queued[request.itemName] = entry.seq;
+	return true;
+}
+
+bool RequestScheduler::next( Request &request )
+{
+	if ( _timeout > 0 )
+		expire();
+
+	while ( !_queue.empty() )
+	{
+		if ( _window > 0 && _outstanding.size() >= _window )
+			return false;
+
+		Queue::iterator level = _queue.begin();
+		Entry entry = level->second.front();
+		level->second.pop_front();
+		if ( level->second.empty() )
+			_queue.erase( level );
+
+		boost::unordered_map<std::string, unsigned long>::iterator it = _queued.find( entry.request.itemName );
+		if ( it == _queued.end() || it->second != entry.seq )
+			continue;
+		_queued.erase( it );
+
+		const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+		_outstanding[entry.request.itemName] = now;
+		if ( _timeout > 0 )
+			_sent.push_back( std::make_pair( now, entry.request.itemName ) );
+		_sentCount++;
+		request = entry.request;
+		return true;
+	}
+	return false;
+}
+
+void RequestScheduler::expire()
+{
+	const boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() - boost::posix_time::milliseconds( _timeout );
+	while ( !_sent.empty() && _sent.front().first <= deadline )
+	{
+		// skip the sends which completed, or were sent again since
+		Outstanding::iterator it = _outstanding.find( _sent.front().second );
+		if ( it != _outstanding.end() && it->second == _sent.front().first )
+		{
+			_outstanding.erase( it );
+			_expiredCount++;
+		}
+		_sent.pop_front();
+	}
+}
+
+void RequestScheduler::complete( const std::string &itemName )
+{
+	if ( _outstanding.erase( itemName ) > 0 )
+		_completeCount++;
+}
+
+void RequestScheduler::cancel( const std::string &itemName )
+{
+	_queued.erase( itemName );
+	_outstanding.erase( itemName );
+}
+
+void RequestScheduler::clear()
+{
+	_queue.clear();
+	_queued.clear();
+	_outstanding.clear();
+	_sent.clear();
+}
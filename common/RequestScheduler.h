@@ -0,0 +1,82 @@
+#ifndef _REQUEST_SCHEDULER_H_
+#define _REQUEST_SCHEDULER_H_
+
+#include "StdAfx.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/unordered_map.hpp>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+
+// paces the item requests of a consumer handler.
+// at most window requests wait for their refresh to complete, the rest are
+// queued by priority, higher first and in order of arrival within a priority.
+// a window of 0 lets every queued request through at once. with a timeout an
+// outstanding request gives its slot up after timeout milliseconds.
+class RequestScheduler
+{
+public:
+	struct Request
+	{
+		std::string			itemName;
+		std::string			viewFIDs;
+		rfa::common::UInt8	interactionType;
+	};
+
+	RequestScheduler();
+
+	void			setWindow( size_t window )	{ _window = window; }
+	size_t			window() const				{ return _window; }
+	bool			isEnabled() const			{ return _window > 0; }
+	// 0 waits for the refresh without limit
+	void			setTimeout( long timeout );
+	long			timeout() const				{ return _timeout; }
+
+	// false if the item is already queued or outstanding
+	bool			enqueue( const Request &request, int priority );
+	// next request the window lets through, it is outstanding from then on
+	bool			next( Request &request );
+	// refresh complete, frees a slot of the window
+	void			complete( const std::string &itemName );
+	// item closed, whether it was queued or outstanding
+	void			cancel( const std::string &itemName );
+	void			clear();
+
+	size_t			queued() const			{ return _queued.size(); }
+	size_t			outstanding() const		{ return _outstanding.size(); }
+	unsigned long	sentCount() const		{ return _sentCount; }
+	unsigned long	completeCount() const	{ return _completeCount; }
+	unsigned long	expiredCount() const	{ return _expiredCount; }
+
+private:
+	struct Entry
+	{
+		Request			request;
+		unsigned long	seq;
+	};
+	typedef std::map<int, std::deque<Entry>, std::greater<int> >	Queue;
+	typedef boost::unordered_map<std::string, boost::posix_time::ptime>	Outstanding;
+
+	// free the slots of the requests outstanding for longer than the timeout
+	void			expire();
+
+	Queue												_queue;
+	// sequence number of the live queue entry of each item, cancelled entries
+	// are left in _queue and skipped by next()
+	boost::unordered_map<std::string, unsigned long>	_queued;
+	// send time of the outstanding items
+	Outstanding											_outstanding;
+	// sends in order, for the timeout
+	std::deque<std::pair<boost::posix_time::ptime, std::string> >	_sent;
+	size_t												_window;
+	long												_timeout;
+	unsigned long										_seq;
+	unsigned long										_sentCount;
+	unsigned long										_completeCount;
+	unsigned long										_expiredCount;
+};
+
+#endif // _REQUEST_SCHEDULER_H_
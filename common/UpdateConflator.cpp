@@ -0,0 +1,124 @@
+#include "UpdateConflator.h"
+
+using namespace boost::posix_time;
+
+UpdateConflator::UpdateConflator() :
+ _heldCount( 0 ),
+ _releasedCount( 0 )
+{
+}
+
+void UpdateConflator::setItem( const std::string &itemName, rfa::common::Handle *handle, long interval, long tradeCount )
+{
+	Settings settings;
+	settings.interval = interval > 0 ? interval : 0;
+	settings.tradeCount = tradeCount > 0 ? tradeCount : 0;
+	if ( settings.interval > 0 )
+		_settings[itemName] = settings;
+	else
+		_settings.erase( itemName );
+
+	// a subscribed item takes the new settings with its next update
+	if ( handle )
+	{
+		ItemIndex::iterator it = _items.find( handle );
+		if ( it != _items.end() )
+			it->second.settings = settings;
+	}
+}
+
+void UpdateConflator::removeItem( const std::string &itemName, rfa::common::Handle *handle )
+{
+	_settings.erase( itemName );
+	if ( handle )
+		_items.erase( handle );
+}
+
+void UpdateConflator::clear()
+{
+	_settings.clear();
+	_items.clear();
+	_schedule.clear();
+}
+
+bool UpdateConflator::update( rfa::common::Handle *handle, const std::string &itemName, std::vector<FieldValue> &fields, bool trade, const ptime &now )
+{
+	ItemIndex::iterator it = _items.find( handle );
+	if ( it == _items.end() )
+	{
+		boost::unordered_map<std::string, Settings>::const_iterator settings = _settings.find( itemName );
+		if ( settings == _settings.end() )
+			return true;
+
+		ItemState state;
+		state.settings = settings->second;
+		state.trades = 0;
+		state.lastRelease = ptime( boost::posix_time::min_date_time );
+		state.scheduled = false;
+		it = _items.insert( std::make_pair( handle, state ) ).first;
+	}
+
+	ItemState &state = it->second;
+	LastValueCache::mergeFields( state.pending, fields, false );
+	if ( trade )
+		state.trades++;
+
+	if ( state.settings.interval <= 0
+		|| now >= state.lastRelease + milliseconds( state.settings.interval )
+		|| ( state.settings.tradeCount > 0 && state.trades >= state.settings.tradeCount ) )
+	{
+		releaseState( state, fields, now );
+		return true;
+	}
+
+	_heldCount++;
+	if ( !state.scheduled )
+	{
+		state.deadline = state.lastRelease + milliseconds( state.settings.interval );
+		state.scheduled = true;
+		_schedule.insert( std::make_pair( state.deadline, handle ) );
+	}
+	return false;
+}
+
+bool UpdateConflator::release( rfa::common::Handle *handle, std::vector<FieldValue> &fields, const ptime &now )
+{
+	ItemIndex::iterator it = _items.find( handle );
+	if ( it == _items.end() || it->second.pending.empty() )
+		return false;
+	releaseState( it->second, fields, now );
+	return true;
+}
+
+void UpdateConflator::releaseState( ItemState &state, std::vector<FieldValue> &fields, const ptime &now )
+{
+	fields.swap( state.pending );
+	state.pending.clear();
+	state.trades = 0;
+	state.lastRelease = now;
+	state.scheduled = false;
+	_releasedCount++;
+}
+
+void UpdateConflator::drop( rfa::common::Handle *handle )
+{
+	ItemIndex::iterator it = _items.find( handle );
+	if ( it == _items.end() )
+		return;
+	it->second.pending.clear();
+	it->second.trades = 0;
+	it->second.scheduled = false;
+}
+
+void UpdateConflator::due( const ptime &now, std::vector<rfa::common::Handle*> &handles )
+{
+	while ( !_schedule.empty() && _schedule.begin()->first <= now )
+	{
+		std::multimap<ptime, rfa::common::Handle*>::iterator entry = _schedule.begin();
+		ItemIndex::iterator it = _items.find( entry->second );
+		// entries of released, dropped or closed items are stale
+		if ( it != _items.end() && it->second.scheduled && it->second.deadline == entry->first && !it->second.pending.empty() )
+			handles.push_back( entry->second );
+		_schedule.erase( entry );
+	}
+}
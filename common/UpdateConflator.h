@@ -0,0 +1,69 @@
+#ifndef _UPDATE_CONFLATOR_H_
+#define _UPDATE_CONFLATOR_H_
+
+#include "StdAfx.h"
+#include "LastValueCache.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// client side conflation of the updates of subscribed items.
+// the updates of a conflated item are merged field by field and released at most
+// once per interval, or as soon as tradeCount trade updates have been merged.
+// native only, no GIL is needed.
+class UpdateConflator
+{
+public:
+	UpdateConflator();
+
+	// interval in milliseconds, 0 stops conflating the item.
+	// handle is 0 for an item not subscribed yet
+	void			setItem( const std::string &itemName, rfa::common::Handle *handle, long interval, long tradeCount );
+	void			removeItem( const std::string &itemName, rfa::common::Handle *handle );
+	void			clear();
+	bool			isEnabled() const	{ return !_settings.empty() || !_items.empty(); }
+
+	// true if fields are to be delivered now, merged with the fields held back before
+	bool			update( rfa::common::Handle *handle, const std::string &itemName, std::vector<FieldValue> &fields, bool trade, const boost::posix_time::ptime &now );
+	// the fields held back for an item, false if there are none
+	bool			release( rfa::common::Handle *handle, std::vector<FieldValue> &fields, const boost::posix_time::ptime &now );
+	// a refresh makes the held back fields obsolete
+	void			drop( rfa::common::Handle *handle );
+	// items whose interval is over while they hold fields back
+	void			due( const boost::posix_time::ptime &now, std::vector<rfa::common::Handle*> &handles );
+
+	unsigned long	heldCount() const		{ return _heldCount; }
+	unsigned long	releasedCount() const	{ return _releasedCount; }
+
+private:
+	struct Settings
+	{
+		long		interval;
+		long		tradeCount;
+	};
+
+	struct ItemState
+	{
+		Settings					settings;
+		LastValueCache::Image		pending;
+		long						trades;
+		boost::posix_time::ptime	lastRelease;
+		boost::posix_time::ptime	deadline;
+		bool						scheduled;
+	};
+
+	void			releaseState( ItemState &state, std::vector<FieldValue> &fields, const boost::posix_time::ptime &now );
+
+	typedef boost::unordered_map<rfa::common::Handle*, ItemState>	ItemIndex;
+
+	boost::unordered_map<std::string, Settings>				_settings;
+	ItemIndex												_items;
+	std::multimap<boost::posix_time::ptime, rfa::common::Handle*>	_schedule;
+	unsigned long											_heldCount;
+	unsigned long											_releasedCount;
+};
+
+#endif // _UPDATE_CONFLATOR_H_
@@ -10,15 +10,24 @@
 #include "client/MarketPriceHandler.h"
 #include "client/MarketByOrderHandler.h"
 #include "client/MarketByPriceHandler.h"
+#include "client/ChainHandler.h"
 #include "client/TimeSeriesHandler.h"
 #include "client/RDMCProvServer.h"
 #include "client/HistoryHandler.h"
 #include "client/OMMPost.h"
 #include "client/OMMInteractiveProvider.h"
+#include "common/PyGIL.h"
+#include "common/Mutex.h"
+#include "common/EventRing.h"
+#include "common/DispatchThread.h"
+#include "common/LazyUpdate.h"
+#include "common/RealValue.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <boost/python/overloads.hpp>
+#include <boost/python/stl_iterator.hpp>
 
 using namespace std;
 
@@ -39,10 +48,10 @@ Pyrfa::Pyrfa() :
     _pDictionaryHandler(0),
     _pSymbolListHandler(0),
     _pMarketPriceHandler(0),
+    _pChainHandler(0),
     _pMarketByOrderHandler(0),
     _pMarketByPriceHandler(0),
     _pTimeSeriesHandler(0),
-    _pTimeSeries(0),
     _pTS1DictDb(0),
     _pHistoryHandler(0),
     _pConnHandle(0),
@@ -54,7 +63,6 @@ Pyrfa::Pyrfa() :
     _isSymbolListAvailable(false),
     _isHistoryAvailable(false),
     _isPublisher(false),
-    _out(),
     _eventData(),
     _log(""),
     _isConnectionUp(false),
@@ -63,15 +71,38 @@ Pyrfa::Pyrfa() :
     _pOMMPost(0),
     _symbolList(""),
     _watchList(""),
-    _timeSeries(""),
+    _timeSeries(boost::python::tuple()),
     _timeSeriesPeriod(rfa::ts1::TS1Series::Daily),
     _timeSeriesMaxRecords(10),
+    _timeSeriesConcurrency(10),
+    _timeSeriesMode(TimeSeriesRecords),
     _userName(""),
     _interactionType(rfa::message::ReqMsg::InitialImageFlag | rfa::message::ReqMsg::InterestAfterRefreshFlag),
     _viewFIDs(""),
     _fieldDictionaryFilename(""),
     _enumTypeFilename(""),
-    _directory("")
+    _directory(""),
+    _callbacks(),
+    _ricCallbacks(),
+    _pDispatchThread(0),
+    _pEventRing(0),
+    _pMarketPriceMutex(new CMutex()),
+    _pCompletions(new CompletionRegistry()),
+    _requestWindow(0),
+    _requestTimeout(0),
+    _cacheImages(false),
+    _mergeUpdates(false),
+    _conflationInterval(0),
+    _conflationTradeCount(0),
+    _columnFields(),
+    _columnCapacity(0),
+    _fieldFilters(),
+    _lazyDecode(false),
+    _marketByOrderBatch(false),
+    _marketByOrderBookDepth(0),
+    _marketByPriceBookDepth(0),
+    _dateTimeMode(FieldDecodeTable::DateTimeString),
+    _realMode(FieldDecodeTable::RealDouble)
 {
     initPythonLib();
     initializeRFA();
@@ -80,12 +111,19 @@ Pyrfa::Pyrfa() :
 Pyrfa::~Pyrfa()
 {
     cleanUp();
+    delete _pMarketPriceMutex;
+    delete _pCompletions;
 }
 
 int Pyrfa::initPythonLib() {
     try {
         //initialize python intepreter.
         Py_Initialize();
+#if PY_VERSION_HEX < 0x03070000
+        // the GIL is released while blocking in EventQueue::dispatch
+        // and re-acquired from processEvent, so threads must be set up.
+        PyEval_InitThreads();
+#endif
         object main_module = import("__main__");
         object main_namespace = main_module.attr("__dict__");
         object ignored = exec("import time", main_namespace);
@@ -524,6 +562,8 @@ void Pyrfa::dictionaryRequest() {
         }
         _pDictionaryHandler = new DictionaryHandler(_fieldDictionaryFilename.c_str(), _enumTypeFilename.c_str(), *_pComponentLogger);
         _pDictionaryHandler->setDebugMode(_debug);
+        _pDictionaryHandler->setDateTimeMode(_dateTimeMode);
+        _pDictionaryHandler->setRealMode(_realMode);
     } else {
         if(_debug)
             _logInfo("[Pyrfa::dictionaryRequest] Downloading data dictionary from server... ");
@@ -539,6 +579,9 @@ void Pyrfa::dictionaryRequest() {
         }
         _pDictionaryHandler = new DictionaryHandler(_pOMMConsumer, _pEventQueue, this, _serviceName, dictTraceLevel, *_pComponentLogger);
         _pDictionaryHandler->setDebugMode(_debug);
+        _pDictionaryHandler->setDateTimeMode(_dateTimeMode);
+        _pDictionaryHandler->setRealMode(_realMode);
+        _pDictionaryHandler->setDecodeLock(_pMarketPriceMutex);
         if(_pDirectoryHandler == NULL) {
             _logError("[Pyrfa::dictionaryRequest] ERROR. Using network dict. Must invoke Directory request first!!");
             return;
@@ -603,13 +646,19 @@ bool Pyrfa::isHistoryRefreshComplete() const {
 bool Pyrfa::isConnectionUp() const {
     return _isConnectionUp;
 }
-void Pyrfa::symbolListRequest(object const &argv=object()) {
+/*
+* Subscribe to symbol lists. With members a list delivers MEMBERS records with the
+* members added and removed instead of a record per entry, with subscribe the members
+* are subscribed to as market price items and follow the list.
+*/
+object Pyrfa::symbolListRequest(object const &argv=object(), bool members=false, bool subscribe=false) {
+    vector<string> requested;
     if(!_pOMMConsumer)
-        return;
+        return newCompletion(CompletionRegistry::SymbolList, requested);
 
     if(_pDictionaryHandler == NULL || _pDirectoryHandler == NULL) {
         _logError("[Pyrfa::symbolListRequest] ERROR. Must invoke Directory/Dictionary requests first!!");
-        return;
+        return newCompletion(CompletionRegistry::SymbolList, requested);
     }
 
     std::string itemName = "";
@@ -623,8 +672,9 @@ void Pyrfa::symbolListRequest(object const &argv=object()) {
 
     rfa::common::RFA_String fullname;
     if(_pSymbolListHandler == NULL) {
-        _pSymbolListHandler = new SymbolListHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), *_pComponentLogger);
+        _pSymbolListHandler = new SymbolListHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
         _pSymbolListHandler->setDebugMode(_debug);
+        _pSymbolListHandler->setCompletions(_pCompletions);
     }
 
     if(_pDirectoryHandler->isServiceUp()) {
@@ -646,7 +696,8 @@ void Pyrfa::symbolListRequest(object const &argv=object()) {
             boost::trim(itemList[i]);
             if(itemList[i].empty())
                 continue;
-            _pSymbolListHandler->sendRequest(itemList[i]);
+            _pSymbolListHandler->sendRequest(itemList[i], members, subscribe);
+            requested.push_back(itemList[i]);
         }
         _isSymbolListAvailable = true;
     } else {
@@ -655,6 +706,7 @@ void Pyrfa::symbolListRequest(object const &argv=object()) {
         _logError(_log.c_str());
         _isSymbolListAvailable = false;
     }
+    return newCompletion(CompletionRegistry::SymbolList, requested);
 }
 
 std::string Pyrfa::getSymbolList(object const &argv) {
@@ -673,19 +725,21 @@ std::string Pyrfa::getSymbolList(object const &argv) {
         boost::trim(itemList[i]);
         if(itemList[i].empty())
             continue;
-        symbolListRequest(str(itemList[i]));
-        while (!isSymbolListRefreshComplete()) {
-            dispatchEventQueue(0);
+        // a list already subscribed to keeps its members up to date
+        const bool subscribed = _pSymbolListHandler && _pSymbolListHandler->getHandle(itemList[i]);
+        if(!subscribed) {
+            object completion = symbolListRequest(str(itemList[i]), true, false);
+            waitFor(extract<boost::shared_ptr<Completion> >(completion)());
+        } else if(!_pSymbolListHandler->isRefreshComplete(itemList[i])) {
+            waitFor(addCompletion(CompletionRegistry::SymbolList, vector<string>(1, itemList[i])));
         }
-        symbolListCloseRequest(str(itemList[i]));
         if(_isSymbolListAvailable) {
             if(!_pSymbolListHandler)
                 return "";
-            const std::list<std::string> *symbolList;
-            symbolList = _pSymbolListHandler->getSymbolList();
-            if(symbolList->size() > 0) {
-                for(std::list<std::string>::const_iterator i=symbolList->begin(); (i != symbolList->end()); ++i) {
-                    _symbolList.append(*i);
+            const boost::unordered_set<std::string> *symbolList = _pSymbolListHandler->getSymbolList(itemList[i]);
+            if(symbolList && symbolList->size() > 0) {
+                for(boost::unordered_set<std::string>::const_iterator it = symbolList->begin(); it != symbolList->end(); ++it) {
+                    _symbolList.append(*it);
                     _symbolList.append(" ");
                 }
             } else {
@@ -696,6 +750,8 @@ std::string Pyrfa::getSymbolList(object const &argv) {
                 }
             }
         }
+        if(!subscribed)
+            symbolListCloseRequest(str(itemList[i]));
     }
     return _symbolList;
 }
@@ -717,11 +773,14 @@ void Pyrfa::symbolListCloseRequest(object const &argv) {
             continue;
         _pSymbolListHandler->closeRequest(itemList[i]);
     }
+    updateSubscriptions();
 }
 
 void Pyrfa::symbolListCloseAllRequest() {
-    if(!_pSymbolListHandler)
+    if(_pSymbolListHandler) {
         _pSymbolListHandler->closeAllRequest();
+        updateSubscriptions();
+    }
 }
 
 std::string Pyrfa::getSymbolListWatchList() {
@@ -730,13 +789,12 @@ std::string Pyrfa::getSymbolListWatchList() {
 
     _watchList.clear();
 
-    std::map<rfa::common::Handle*,std::string> watchList;
-    watchList = _pSymbolListHandler->getWatchList();
+    const ItemRegistry::HandleIndex& watchList = _pSymbolListHandler->getWatchList().items();
 
-    std::map<rfa::common::Handle*,std::string>::iterator it = watchList.begin();
+    ItemRegistry::HandleIndex::const_iterator it;
     for(it = watchList.begin(); it != watchList.end(); it++) {
         // serialize into a Tcl list
-        _watchList.append(it->second);
+        _watchList.append(it->second->watchName);
         _watchList.append(" ");
     }
     return _watchList;
@@ -748,13 +806,13 @@ std::string Pyrfa::getMarketPriceWatchList() {
 
     _watchList.clear();
 
-    std::map<rfa::common::Handle*,std::string> watchList;
-    watchList = _pMarketPriceHandler->getWatchList();
+    CMutex::CGuard guard(*_pMarketPriceMutex);
+    const ItemRegistry::HandleIndex& watchList = _pMarketPriceHandler->getWatchList().items();
 
-    std::map<rfa::common::Handle*,std::string>::iterator it = watchList.begin();
+    ItemRegistry::HandleIndex::const_iterator it;
     for(it = watchList.begin(); it != watchList.end(); it++) {
         // serialize into a list
-        _watchList.append(it->second);
+        _watchList.append(it->second->watchName);
         _watchList.append(" ");
     }
     return _watchList;
@@ -766,13 +824,12 @@ std::string Pyrfa::getMarketByOrderWatchList() {
 
     _watchList.clear();
 
-    std::map<rfa::common::Handle*,std::string> watchList;
-    watchList = _pMarketByOrderHandler->getWatchList();
+    const ItemRegistry::HandleIndex& watchList = _pMarketByOrderHandler->getWatchList().items();
 
-    std::map<rfa::common::Handle*,std::string>::iterator it = watchList.begin();
+    ItemRegistry::HandleIndex::const_iterator it;
     for(it = watchList.begin(); it != watchList.end(); it++) {
         // serialize into a Tcl list
-        _watchList.append(it->second);
+        _watchList.append(it->second->watchName);
         _watchList.append(" ");
     }
     return _watchList;
@@ -784,13 +841,12 @@ std::string Pyrfa::getMarketByPriceWatchList() {
 
     _watchList.clear();
 
-    std::map<rfa::common::Handle*,std::string> watchList;
-    watchList = _pMarketByPriceHandler->getWatchList();
+    const ItemRegistry::HandleIndex& watchList = _pMarketByPriceHandler->getWatchList().items();
 
-    std::map<rfa::common::Handle*,std::string>::iterator it = watchList.begin();
+    ItemRegistry::HandleIndex::const_iterator it;
     for(it = watchList.begin(); it != watchList.end(); it++) {
         // serialize into a Tcl list
-        _watchList.append(it->second);
+        _watchList.append(it->second->watchName);
         _watchList.append(" ");
     }
     return _watchList;
@@ -802,13 +858,12 @@ std::string Pyrfa::getTimeSeriesWatchList() {
 
     _watchList.clear();
 
-    std::map<rfa::common::Handle*,std::string> watchList;
-    watchList = _pTimeSeriesHandler->getWatchList();
+    const ItemRegistry::HandleIndex& watchList = _pTimeSeriesHandler->getWatchList().items();
 
-    std::map<rfa::common::Handle*,std::string>::iterator it = watchList.begin();
+    ItemRegistry::HandleIndex::const_iterator it;
     for(it = watchList.begin(); it != watchList.end(); it++) {
         // serialize into a Tcl list
-        _watchList.append(it->second);
+        _watchList.append(it->second->watchName);
         _watchList.append(" ");
     }
     return _watchList;
@@ -820,25 +875,27 @@ std::string Pyrfa::getHistoryWatchList() {
 
     _watchList.clear();
 
-    std::map<rfa::common::Handle*,std::string> watchList;
-    watchList = _pHistoryHandler->getWatchList();
+    const ItemRegistry::HandleIndex& watchList = _pHistoryHandler->getWatchList().items();
 
-    std::map<rfa::common::Handle*,std::string>::iterator it = watchList.begin();
+    ItemRegistry::HandleIndex::const_iterator it;
     for(it = watchList.begin(); it != watchList.end(); it++) {
         // serialize into a list
-        _watchList.append(it->second);
+        _watchList.append(it->second->watchName);
         _watchList.append(" ");
     }
     return _watchList;
 }
 
-void Pyrfa::marketByPriceRequest(object const &argv) {
+void Pyrfa::marketByPriceRequest(object const &argv, int priority=0) {
     if(!_pOMMConsumer)
         return;
 
     if(_pMarketByPriceHandler == NULL) {
-        _pMarketByPriceHandler = new MarketByPriceHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), *_pComponentLogger);
+        _pMarketByPriceHandler = new MarketByPriceHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
         _pMarketByPriceHandler->setDebugMode(_debug);
+        _pMarketByPriceHandler->setRequestWindow(_requestWindow, _requestTimeout);
+        _pMarketByPriceHandler->setFieldFilter(_fieldFilters[rfa::rdm::MMT_MARKET_BY_PRICE]);
+        _pMarketByPriceHandler->setBookDepth(_marketByPriceBookDepth);
         if(_debug) {
             _log = "[Pyrfa::marketByPriceRequest] Subscribe to a service: ";
             _log.append(_serviceName.c_str());
@@ -860,13 +917,55 @@ void Pyrfa::marketByPriceRequest(object const &argv) {
                 continue;
             if(_interactionType == rfa::message::ReqMsg::InitialImageFlag)
                 _pMarketByPriceHandler->closeRequest(itemList[i]);
-            _pMarketByPriceHandler->sendRequest(itemList[i], _interactionType);
+            _pMarketByPriceHandler->queueRequest(itemList[i], _interactionType, priority);
         }
     } else {
         _logError("[Pyrfa::marketByPriceRequest] Dictionary not made available or user not logged in");
     }
 }
 
+/*
+* Subscribe to many items with batch requests of at most chunkSize items each.
+*/
+void Pyrfa::marketByPriceBatchRequest(object const &argv, long chunkSize=1000) {
+    if(!_pOMMConsumer)
+        return;
+
+    if(chunkSize <= 0) {
+        _log = "[Pyrfa::marketByPriceBatchRequest] Chunk size must be positive.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    if(_pMarketByPriceHandler == NULL) {
+        _pMarketByPriceHandler = new MarketByPriceHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
+        _pMarketByPriceHandler->setDebugMode(_debug);
+        _pMarketByPriceHandler->setRequestWindow(_requestWindow, _requestTimeout);
+        _pMarketByPriceHandler->setFieldFilter(_fieldFilters[rfa::rdm::MMT_MARKET_BY_PRICE]);
+        _pMarketByPriceHandler->setBookDepth(_marketByPriceBookDepth);
+        if(_debug) {
+            _log = "[Pyrfa::marketByPriceBatchRequest] Subscribe to a service: ";
+            _log.append(_serviceName.c_str());
+            _logInfo(_log.c_str());
+        }
+    }
+
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
+        if(_interactionType == rfa::message::ReqMsg::InitialImageFlag) {
+            for(size_t i = 0; i < itemList.size(); i++)
+                _pMarketByPriceHandler->closeRequest(itemList[i]);
+        }
+        for(size_t i = 0; i < itemList.size(); i += (size_t)chunkSize) {
+            vector<string> chunk(itemList.begin() + i, itemList.begin() + std::min(itemList.size(), i + (size_t)chunkSize));
+            _pMarketByPriceHandler->sendBatchRequest(chunk, _interactionType);
+        }
+    } else {
+        _logError("[Pyrfa::marketByPriceBatchRequest] Dictionary not made available or user not logged in");
+    }
+}
+
 void Pyrfa::marketByPriceCloseRequest(object const &argv) {
     if(!_pMarketByPriceHandler)
         return;
@@ -892,45 +991,183 @@ void Pyrfa::marketByPriceCloseAllRequest() {
 }
 
 
-void Pyrfa::marketPriceRequest(object const &argv) {
+/*
+* Subscribe to market price items, one or more comma separated names. The Completion
+* returned is done once every item has a complete refresh.
+*/
+object Pyrfa::marketPriceRequest(object const &argv, int priority=0) {
+    vector<string> itemList;
+    if(_pOMMConsumer) {
+        #if PY_MAJOR_VERSION >= 3
+        std::string itemName = extract<string>(argv);
+        #else
+        std::string itemName = extract<string>(str(argv).encode("utf-8"));
+        #endif
+        boost::split(itemList, itemName, boost::is_any_of(","));
+    }
+
+    // the user is an owner of the items, besides the chains and symbol lists
+    vector<string> requested;
+    for(size_t i = 0; i < itemList.size(); i++) {
+        boost::trim(itemList[i]);
+        if(itemList[i].empty())
+            continue;
+        requested.push_back(itemList[i]);
+        if(_userItems.insert(itemList[i]).second)
+            _itemOwners[itemList[i]]++;
+    }
+    return object(requestMarketPrice(requested, priority));
+}
+
+/*
+* Request market price items for the user or for the auto-subscribed chains and symbol lists.
+*/
+boost::shared_ptr<Completion> Pyrfa::requestMarketPrice(const vector<string> &itemList, int priority) {
+    vector<string> requested;
     if(!_pOMMConsumer)
-        return;
+        return addCompletion(CompletionRegistry::MarketPrice, requested);
+    const bool available = _pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn();
 
-    if(_pMarketPriceHandler == NULL) {
-        _pMarketPriceHandler = new MarketPriceHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), *_pComponentLogger);
-        _pMarketPriceHandler->setDebugMode(_debug);
-        if(_debug) {
-            _log = "[Pyrfa::marketPriceRequest] Subscribe to a service: ";
-            _log.append(_serviceName.c_str());
-            _logInfo(_log.c_str());
+    bool created = false;
+    boost::shared_ptr<Completion> completion;
+    {
+        // the dispatch thread decodes market price outside the GIL,
+        // nothing may give the GIL up while the lock is held
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        created = createMarketPriceHandler();
+        if(available) {
+            for(size_t i = 0; i < itemList.size(); i++) {
+                if(_interactionType == rfa::message::ReqMsg::InitialImageFlag)
+                    _pMarketPriceHandler->closeRequest(itemList[i]);
+                if(_conflationInterval > 0)
+                    _pMarketPriceHandler->setConflation(itemList[i], _conflationInterval, _conflationTradeCount);
+                _pMarketPriceHandler->queueRequest(itemList[i], _viewFIDs, _interactionType, priority);
+                requested.push_back(itemList[i]);
+            }
         }
+        // registered under the lock, before the dispatch thread can see the refreshes
+        completion = addCompletion(CompletionRegistry::MarketPrice, requested);
+    }
+
+    // the logger dispatches its queue without the GIL
+    if(created && _debug) {
+        _log = "[Pyrfa::marketPriceRequest] Subscribe to a service: ";
+        _log.append(_serviceName.c_str());
+        _logInfo(_log.c_str());
     }
+    if(!available)
+        _logError("[Pyrfa::marketPriceRequest] Dictionary not made available or user not logged in");
+    return completion;
+}
 
+/*
+* Create the market price handler on the first request, with the market price lock held.
+* return true if it is created.
+*/
+bool Pyrfa::createMarketPriceHandler() {
+    if(_pMarketPriceHandler)
+        return false;
+    _pMarketPriceHandler = new MarketPriceHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getSharedDictionary(), _pDictionaryHandler->getSharedDecodeTable(), *_pComponentLogger);
+    _pMarketPriceHandler->setDebugMode(_debug);
+    _pMarketPriceHandler->setRequestWindow(_requestWindow, _requestTimeout);
+    _pMarketPriceHandler->setFieldFilter(_fieldFilters[rfa::rdm::MMT_MARKET_PRICE]);
+    _pMarketPriceHandler->setImageCache(_cacheImages, _mergeUpdates);
+    _pMarketPriceHandler->setColumns(_columnFields, (size_t)_columnCapacity);
+    _pMarketPriceHandler->setLazyDecode(_lazyDecode);
+    _pMarketPriceHandler->setCompletions(_pCompletions);
+    return true;
+}
+
+/*
+* Item names of a batch request: a comma separated string as the other requests take,
+* or any Python iterable of names.
+*/
+void Pyrfa::batchItemList(object const &argv, vector<string> &itemList) {
     #if PY_MAJOR_VERSION >= 3
-    std::string itemName = extract<string>(argv);
+    if(PyUnicode_Check(argv.ptr())) {
+        std::string itemName = extract<string>(argv);
     #else
-    std::string itemName = extract<string>(str(argv).encode("utf-8"));
+    if(PyString_Check(argv.ptr()) || PyUnicode_Check(argv.ptr())) {
+        std::string itemName = extract<string>(str(argv).encode("utf-8"));
     #endif
-    vector<string> itemList;
-    boost::split(itemList, itemName, boost::is_any_of(","));
-    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
-        for(size_t i = 0; i < itemList.size(); i++) {
-            boost::trim(itemList[i]);
-            if(itemList[i].empty())
-                continue;
-            if(_interactionType == rfa::message::ReqMsg::InitialImageFlag)
-                _pMarketPriceHandler->closeRequest(itemList[i]);
-            _pMarketPriceHandler->sendRequest(itemList[i], _viewFIDs, _interactionType);
-        }
+        boost::split(itemList, itemName, boost::is_any_of(","));
     } else {
-        _logError("[Pyrfa::marketPriceRequest] Dictionary not made available or user not logged in");
+        stl_input_iterator<object> it(argv), end;
+        for(; it != end; ++it) {
+            #if PY_MAJOR_VERSION >= 3
+            itemList.push_back(extract<string>(*it));
+            #else
+            itemList.push_back(extract<string>(str(*it).encode("utf-8")));
+            #endif
+        }
     }
+
+    // trim and drop the blanks in place
+    size_t n = 0;
+    for(size_t i = 0; i < itemList.size(); i++) {
+        boost::trim(itemList[i]);
+        if(!itemList[i].empty())
+            itemList[n++] = itemList[i];
+    }
+    itemList.resize(n);
 }
 
-void Pyrfa::marketPriceCloseRequest(object const &argv) {
-    if(!_pMarketPriceHandler)
+/*
+* Subscribe to many items with batch requests of at most chunkSize items each.
+*/
+void Pyrfa::marketPriceBatchRequest(object const &argv, long chunkSize=1000) {
+    if(!_pOMMConsumer)
         return;
 
+    if(chunkSize <= 0) {
+        _log = "[Pyrfa::marketPriceBatchRequest] Chunk size must be positive.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+    for(size_t i = 0; i < itemList.size(); i++) {
+        if(_userItems.insert(itemList[i]).second)
+            _itemOwners[itemList[i]]++;
+    }
+    const bool available = _pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn();
+
+    bool created = false;
+    {
+        // the dispatch thread decodes market price outside the GIL
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        created = createMarketPriceHandler();
+        if(available) {
+            if(_interactionType == rfa::message::ReqMsg::InitialImageFlag) {
+                for(size_t i = 0; i < itemList.size(); i++)
+                    _pMarketPriceHandler->closeRequest(itemList[i]);
+            }
+            if(_conflationInterval > 0) {
+                for(size_t i = 0; i < itemList.size(); i++)
+                    _pMarketPriceHandler->setConflation(itemList[i], _conflationInterval, _conflationTradeCount);
+            }
+            for(size_t i = 0; i < itemList.size(); i += (size_t)chunkSize) {
+                vector<string> chunk(itemList.begin() + i, itemList.begin() + std::min(itemList.size(), i + (size_t)chunkSize));
+                _pMarketPriceHandler->sendBatchRequest(chunk, _viewFIDs, _interactionType);
+            }
+        }
+    }
+
+    if(created && _debug) {
+        _log = "[Pyrfa::marketPriceBatchRequest] Subscribe to a service: ";
+        _log.append(_serviceName.c_str());
+        _logInfo(_log.c_str());
+    }
+    if(!available)
+        _logError("[Pyrfa::marketPriceBatchRequest] Dictionary not made available or user not logged in");
+}
+
+/*
+* Close market price items of the user. The ones an auto-subscribed chain or symbol
+* list still holds stay open.
+*/
+void Pyrfa::marketPriceCloseRequest(object const &argv) {
     #if PY_MAJOR_VERSION >= 3
     std::string itemName = extract<string>(argv);
     #else
@@ -938,15 +1175,43 @@ void Pyrfa::marketPriceCloseRequest(object const &argv) {
     #endif
     vector<string> itemList;
     boost::split(itemList, itemName, boost::is_any_of(","));
+
+    vector<string> closed;
     for(size_t i = 0; i < itemList.size(); i++) {
         boost::trim(itemList[i]);
         if(itemList[i].empty())
             continue;
-        _pMarketPriceHandler->closeRequest(itemList[i]);
+        boost::unordered_map<std::string, int>::iterator owners = _itemOwners.find(itemList[i]);
+        if(owners != _itemOwners.end()) {
+            if(!_userItems.erase(itemList[i]))
+                continue;
+            if(--owners->second > 0)
+                continue;
+            _itemOwners.erase(owners);
+        }
+        closed.push_back(itemList[i]);
     }
+    closeMarketPrice(closed);
+}
+
+void Pyrfa::closeMarketPrice(const vector<string> &itemList) {
+    if(itemList.empty())
+        return;
+    CMutex::CGuard guard(*_pMarketPriceMutex);
+    if(!_pMarketPriceHandler)
+        return;
+    for(size_t i = 0; i < itemList.size(); i++)
+        _pMarketPriceHandler->closeRequest(itemList[i]);
 }
 
+/*
+* Close every market price item, the ones of the auto-subscribed chains and symbol lists too.
+* Their members are subscribed again as they are added.
+*/
 void Pyrfa::marketPriceCloseAllRequest() {
+    _itemOwners.clear();
+    _userItems.clear();
+    CMutex::CGuard guard(*_pMarketPriceMutex);
     if(_pMarketPriceHandler)
         _pMarketPriceHandler->closeAllRequest();
 }
@@ -963,6 +1228,7 @@ void Pyrfa::marketPricePause(object const &argv) {
     vector<string> itemList;
     boost::split(itemList, itemName, boost::is_any_of(","));
     if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
         for(size_t i = 0; i < itemList.size(); i++) {
             boost::trim(itemList[i]);
             if(itemList[i].empty())
@@ -991,6 +1257,7 @@ void Pyrfa::marketPriceResume(object const &argv) {
     vector<string> itemList;
     boost::split(itemList, itemName, boost::is_any_of(","));
     if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
         for(size_t i = 0; i < itemList.size(); i++) {
             boost::trim(itemList[i]);
             if(itemList[i].empty())
@@ -1007,14 +1274,154 @@ void Pyrfa::marketPriceResume(object const &argv) {
     }
 }
 
+/*
+* Resolve chains natively, one or more comma separated chain RICs. The constituents
+* come as a CHAIN record once the chain is resolved. With track the chain records are
+* kept open and later CHAIN records carry the constituents added and removed, with
+* subscribe the constituents are subscribed to as market price items and follow the chain.
+* The Completion is done once the chains are resolved or failed.
+*/
+object Pyrfa::chainRequest(object const &argv, bool subscribe=false, bool track=false) {
+    vector<string> requested;
+    if(!_pOMMConsumer)
+        return newCompletion(CompletionRegistry::Chain, requested);
+
+    if(_pChainHandler == NULL) {
+        // the dispatch thread asks for chain records with the market price lock held
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pChainHandler = new ChainHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
+        _pChainHandler->setDebugMode(_debug);
+        _pChainHandler->setCompletions(_pCompletions);
+    }
+
+    #if PY_MAJOR_VERSION >= 3
+    std::string chainName = extract<string>(argv);
+    #else
+    std::string chainName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    vector<string> chainList;
+    boost::split(chainList, chainName, boost::is_any_of(","));
+    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
+        for(size_t i = 0; i < chainList.size(); i++) {
+            boost::trim(chainList[i]);
+            if(chainList[i].empty())
+                continue;
+            _pChainHandler->sendRequest(chainList[i], subscribe, track);
+            // a tracked chain already resolved has nothing to wait for
+            if(!_pChainHandler->getConstituents(chainList[i]))
+                requested.push_back(chainList[i]);
+        }
+    } else {
+        _logError("[Pyrfa::chainRequest] Dictionary not made available or user not logged in");
+    }
+    return newCompletion(CompletionRegistry::Chain, requested);
+}
+
+/*
+* Stop resolving chains, the constituents subscribed to with them are closed.
+*/
+void Pyrfa::chainCloseRequest(object const &argv) {
+    if(!_pChainHandler)
+        return;
+
+    #if PY_MAJOR_VERSION >= 3
+    std::string chainName = extract<string>(argv);
+    #else
+    std::string chainName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    vector<string> chainList;
+    boost::split(chainList, chainName, boost::is_any_of(","));
+    for(size_t i = 0; i < chainList.size(); i++) {
+        boost::trim(chainList[i]);
+        if(chainList[i].empty())
+            continue;
+        _pChainHandler->closeRequest(chainList[i]);
+    }
+    updateSubscriptions();
+}
+
+/*
+* The constituents of a chain as a tuple, None until it is resolved.
+*/
+object Pyrfa::getChain(object const &argv) {
+    #if PY_MAJOR_VERSION >= 3
+    std::string chainName = extract<string>(argv);
+    #else
+    std::string chainName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    boost::trim(chainName);
+
+    const vector<string>* constituents = _pChainHandler ? _pChainHandler->getConstituents(chainName) : 0;
+    if(!constituents)
+        return object();
+    boost::python::list l;
+    for(size_t i = 0; i < constituents->size(); i++)
+        l.append((*constituents)[i]);
+    return tuple(l);
+}
+
+/*
+* Subscribe to the constituents added to the auto-subscribed chains and symbol lists
+* and close the removed ones. Every chain and list owns its members, an item opens
+* with its first owner and closes when the last one, the user included, lets it go.
+*/
+void Pyrfa::updateSubscriptions() {
+    vector<string> added;
+    vector<string> removed;
+    if(_pChainHandler)
+        _pChainHandler->takeSubscriptions(added, removed);
+    if(_pSymbolListHandler) {
+        vector<string> listAdded;
+        vector<string> listRemoved;
+        _pSymbolListHandler->takeSubscriptions(listAdded, listRemoved);
+        added.insert(added.end(), listAdded.begin(), listAdded.end());
+        removed.insert(removed.end(), listRemoved.begin(), listRemoved.end());
+    }
+    if(added.empty() && removed.empty())
+        return;
+
+    // owners before and after, an item moved from one chain or list to another stays open
+    boost::unordered_map<std::string, int> before;
+    for(size_t i = 0; i < added.size(); i++) {
+        int &owners = _itemOwners[added[i]];
+        before.insert(std::make_pair(added[i], owners));
+        owners++;
+    }
+    for(size_t i = 0; i < removed.size(); i++) {
+        boost::unordered_map<std::string, int>::iterator owners = _itemOwners.find(removed[i]);
+        if(owners == _itemOwners.end())
+            continue;
+        before.insert(std::make_pair(removed[i], owners->second));
+        if(--owners->second <= 0)
+            _itemOwners.erase(owners);
+    }
+
+    vector<string> subscribed;
+    vector<string> closed;
+    for(boost::unordered_map<std::string, int>::const_iterator it = before.begin(); it != before.end(); ++it) {
+        const bool owned = _itemOwners.find(it->first) != _itemOwners.end();
+        if(it->second == 0 && owned)
+            subscribed.push_back(it->first);
+        else if(it->second > 0 && !owned)
+            closed.push_back(it->first);
+    }
+    closeMarketPrice(closed);
+    if(!subscribed.empty())
+        requestMarketPrice(subscribed, 0);
+}
+
 
-void Pyrfa::marketByOrderRequest(object const &argv) {
+void Pyrfa::marketByOrderRequest(object const &argv, int priority=0) {
     if(!_pOMMConsumer)
         return;
 
     if(_pMarketByOrderHandler == NULL) {
-        _pMarketByOrderHandler = new MarketByOrderHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), *_pComponentLogger);
+        _pMarketByOrderHandler = new MarketByOrderHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
         _pMarketByOrderHandler->setDebugMode(_debug);
+        _pMarketByOrderHandler->setRequestWindow(_requestWindow, _requestTimeout);
+        _pMarketByOrderHandler->setFieldFilter(_fieldFilters[rfa::rdm::MMT_MARKET_BY_ORDER]);
+        _pMarketByOrderHandler->setBatchMode(_marketByOrderBatch);
+        _pMarketByOrderHandler->setBookDepth(_marketByOrderBookDepth);
         if(_debug) {
             _log = "[Pyrfa::marketByOrderRequest] Subscribe to a service: ";
             _log.append(_serviceName.c_str());
@@ -1036,13 +1443,56 @@ void Pyrfa::marketByOrderRequest(object const &argv) {
                 continue;
             if(_interactionType == rfa::message::ReqMsg::InitialImageFlag)
                 _pMarketByOrderHandler->closeRequest(itemList[i]);
-            _pMarketByOrderHandler->sendRequest(itemList[i], _interactionType);
+            _pMarketByOrderHandler->queueRequest(itemList[i], _interactionType, priority);
         }
     } else {
         _logError("[Pyrfa::marketByOrderRequest] Dictionary not made available or user not logged in");
     }
 }
 
+/*
+* Subscribe to many items with batch requests of at most chunkSize items each.
+*/
+void Pyrfa::marketByOrderBatchRequest(object const &argv, long chunkSize=1000) {
+    if(!_pOMMConsumer)
+        return;
+
+    if(chunkSize <= 0) {
+        _log = "[Pyrfa::marketByOrderBatchRequest] Chunk size must be positive.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    if(_pMarketByOrderHandler == NULL) {
+        _pMarketByOrderHandler = new MarketByOrderHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
+        _pMarketByOrderHandler->setDebugMode(_debug);
+        _pMarketByOrderHandler->setRequestWindow(_requestWindow, _requestTimeout);
+        _pMarketByOrderHandler->setFieldFilter(_fieldFilters[rfa::rdm::MMT_MARKET_BY_ORDER]);
+        _pMarketByOrderHandler->setBatchMode(_marketByOrderBatch);
+        _pMarketByOrderHandler->setBookDepth(_marketByOrderBookDepth);
+        if(_debug) {
+            _log = "[Pyrfa::marketByOrderBatchRequest] Subscribe to a service: ";
+            _log.append(_serviceName.c_str());
+            _logInfo(_log.c_str());
+        }
+    }
+
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
+        if(_interactionType == rfa::message::ReqMsg::InitialImageFlag) {
+            for(size_t i = 0; i < itemList.size(); i++)
+                _pMarketByOrderHandler->closeRequest(itemList[i]);
+        }
+        for(size_t i = 0; i < itemList.size(); i += (size_t)chunkSize) {
+            vector<string> chunk(itemList.begin() + i, itemList.begin() + std::min(itemList.size(), i + (size_t)chunkSize));
+            _pMarketByOrderHandler->sendBatchRequest(chunk, _interactionType);
+        }
+    } else {
+        _logError("[Pyrfa::marketByOrderBatchRequest] Dictionary not made available or user not logged in");
+    }
+}
+
 void Pyrfa::marketByOrderCloseRequest(object const &argv) {
     if(!_pMarketByOrderHandler)
         return;
@@ -1068,33 +1518,74 @@ void Pyrfa::marketByOrderCloseAllRequest() {
 }
 /*
 * Dispatch events from event queue
+* return all events until the queue is empty.
+*/
+boost::python::tuple Pyrfa::dispatchEventQueue(long timeout=0) {
+    // output returned to Python interpreter
+    boost::python::list out;
+    dispatchEventQueueInto(out, timeout, 0, 0);
+
+    // return output to Python only when pendingEvents=0 (nothing in the queue)
+    // So, one returned output often contains more that one update.
+    return boost::python::tuple(out);
+}
+
+/*
+* Dispatch events from event queue and append them to the out list.
+* Stop when the queue is empty, after maxEvents events or after
+* budget milliseconds, whichever comes first. 0 means no limit.
 * return pending events on the queue.
 *        or -1 if queue is inactive
 */
-boost::python::tuple Pyrfa::dispatchEventQueue(long timeout=0) {
-    // output string returned
-    // to Python interpreter
-    _out = boost::python::tuple();
+long Pyrfa::dispatchEventQueueInto(boost::python::list out, long timeout=0, long maxEvents=0, long budget=0) {
+    // events dispatched while waiting for completions come first
+    if(len(_heldEvents) > 0) {
+        out.extend(_heldEvents);
+        _heldEvents = boost::python::list();
+        timeout = 0;
+    }
+    return dispatchEvents(out, timeout, maxEvents, budget);
+}
+
+long Pyrfa::dispatchEvents(boost::python::list out, long timeout, long maxEvents, long budget) {
+    // chain and symbol list members left by the dispatch thread
+    updateSubscriptions();
+
+    // events decoded by the dispatch thread
+    if(_pEventRing) {
+        long pending = drainEventRing(out, timeout, maxEvents, budget);
+        if(_pDispatchThread || (pending > 0))
+            return pending;
+        // dispatch thread has been stopped and the ring is empty
+        delete _pEventRing;
+        _pEventRing = 0;
+    }
 
     // try at least once
     long pendingEvents = 1;
 
     long processedEvents = 0;
+    bool isInActive = false;
 
     clock_t startTime = clock();
+    boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(budget);
     while ( pendingEvents > 0 )
     {
         // dispatch with a xx milisecond timeout
-        switch ( pendingEvents = _pEventQueue->dispatch( timeout ) ) {
+        // other Python threads may run while RFA waits for events,
+        // processEvent takes the GIL back to hand each event to Python.
+        {
+            CPyGILRelease noGIL;
+            pendingEvents = _pEventQueue->dispatch( timeout );
+        }
+        switch ( pendingEvents ) {
             case rfa::common::Dispatchable::NothingDispatched:
-                // nothing in event queue, empty the output
-                _eventData = boost::python::tuple();
-                _out = boost::python::tuple();
+                // nothing in event queue
                 break;
             case rfa::common::Dispatchable::NothingDispatchedInActive:
                 _logError("[Pyrfa::dispatchEventQueue] Nothing dispatched - Inactive. The EventQueue has been deactivated.");
                 // if the event queue has been deactivated then exit the loop
-                pendingEvents = -1;
+                isInActive = true;
                 break;
             case rfa::common::Dispatchable::NothingDispatchedPartOfGroup:
                 _logError("[Pyrfa::dispatchEventQueue] Nothing dispatched - PartOfGroup. The EventQueue is part of an EventQueueGroup and should not be used directly.");
@@ -1109,10 +1600,24 @@ boost::python::tuple Pyrfa::dispatchEventQueue(long timeout=0) {
                     std::cout << "[Pyrfa::dispatchEventQueue] Event loop - approximate pending Events: " << pendingEvents << std::endl;
                 break;
         }
-        // append eventData from processEvent to Python shell
+
+        // conflated updates whose interval is over
+        flushConflated(_eventData);
+
+        // append eventData from processEvent to the output list
         // clear eventData after appending to avoid duplicate due to logging
-        _out += _eventData;
-        _eventData = boost::python::tuple();
+        if (len(_eventData) > 0) {
+            out.extend(_eventData);
+            _eventData = boost::python::list();
+        }
+
+        // leave the rest on the queue once the caller's limits are reached
+        if ( pendingEvents > 0 ) {
+            if ( (maxEvents > 0) && (processedEvents >= maxEvents) )
+                break;
+            if ( (budget > 0) && (boost::posix_time::microsec_clock::universal_time() >= deadline) )
+                break;
+        }
     }
 
     if(_debug && (processedEvents > 0)) {
@@ -1124,9 +1629,80 @@ boost::python::tuple Pyrfa::dispatchEventQueue(long timeout=0) {
     // get messages from loggerr
     dispatchLoggerEventQueue(0);
 
-    // return output to Python only when pendingEvents=0 (nothing in the queue)
-    // So, one returned output often contains more that one update.
-    return _out;
+    if (isInActive)
+        return -1;
+    return (pendingEvents > 0) ? pendingEvents : 0;
+}
+
+/*
+* Wait for one Completion, or an iterable of them, returned by the request functions.
+* Events keep being dispatched meanwhile, they are handed out by the next
+* dispatchEventQueue() or dispatchEventQueueInto().
+* return True once all of them are done, False after timeout milliseconds.
+*        A negative timeout waits without limit.
+*/
+bool Pyrfa::wait(object const &argv, long timeout=-1) {
+    vector<boost::shared_ptr<Completion> > completions;
+    extract<boost::shared_ptr<Completion> > single(argv);
+    if(single.check()) {
+        completions.push_back(single());
+    } else {
+        stl_input_iterator<object> it(argv), end;
+        for(; it != end; ++it) {
+            extract<boost::shared_ptr<Completion> > completion(*it);
+            if(!completion.check()) {
+                _log = "[Pyrfa::wait] Completion objects expected.";
+                _logError(_log.c_str());
+                throw py_error(_log.c_str());
+            }
+            completions.push_back(completion());
+        }
+    }
+    return waitFor(completions, timeout, _heldEvents);
+}
+
+bool Pyrfa::waitFor(const vector<boost::shared_ptr<Completion> > &completions, long timeout, boost::python::list &events) {
+    boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(timeout);
+    for(size_t i = 0; i < completions.size(); i++) {
+        while(!completions[i]->done()) {
+            if(!_pOMMConsumer || !_pEventQueue)
+                return false;
+            long remaining = 1000;
+            if(timeout >= 0) {
+                remaining = (long)(deadline - boost::posix_time::microsec_clock::universal_time()).total_milliseconds();
+                if(remaining <= 0)
+                    return false;
+            }
+            if(_pDispatchThread) {
+                // the dispatch thread completes it, wake up now and then to drain the ring
+                {
+                    CPyGILRelease noGIL;
+                    completions[i]->wait(std::min(remaining, 10L));
+                }
+                dispatchEvents(events, 0, 0, 0);
+            } else if(dispatchEvents(events, std::min(remaining, 1000L), 0, 0) < 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Pyrfa::waitFor(const boost::shared_ptr<Completion> &completion) {
+    // the events of a blocking call are not handed out
+    boost::python::list events;
+    return waitFor(vector<boost::shared_ptr<Completion> >(1, completion), -1, events);
+}
+
+boost::shared_ptr<Completion> Pyrfa::addCompletion(CompletionRegistry::Domain domain, const vector<string> &names) {
+    boost::shared_ptr<Completion> completion(new Completion(names));
+    if(!names.empty())
+        _pCompletions->add(domain, completion, names);
+    return completion;
+}
+
+object Pyrfa::newCompletion(CompletionRegistry::Domain domain, const vector<string> &names) {
+    return object(addCompletion(domain, names));
 }
 
 void Pyrfa::dispatchLoggerEventQueue(long timeout=0) {
@@ -1140,7 +1716,11 @@ void Pyrfa::dispatchLoggerEventQueue(long timeout=0) {
     while ( pendingEvents > 0 )
     {
         // dispatch with a xx milisecond timeout
-        switch ( pendingEvents = _pLoggerEventQueue->dispatch( timeout ) ) {
+        {
+            CPyGILRelease noGIL;
+            pendingEvents = _pLoggerEventQueue->dispatch( timeout );
+        }
+        switch ( pendingEvents ) {
             case rfa::common::Dispatchable::NothingDispatched:
                 break;
             case rfa::common::Dispatchable::NothingDispatchedInActive:
@@ -1185,6 +1765,9 @@ void Pyrfa::cleanUp() {
         _logInfo(_log.c_str());
     }
 
+    // dispatch thread must not see the handlers go away
+    stopDispatchThread();
+
     // stop sending events to event queue
     deactivateEventQueue();
 
@@ -1216,6 +1799,9 @@ void Pyrfa::cleanUp() {
     if(!getSymbolListWatchList().empty()) {
         symbolListCloseAllRequest();
     }
+    if(_pChainHandler) {
+        _pChainHandler->closeAllRequest();
+    }
     if(!getMarketPriceWatchList().empty()) {
         marketPriceCloseAllRequest();
     }
@@ -1300,6 +1886,13 @@ void Pyrfa::cleanUp() {
         delete _pMarketPriceHandler;
         _pMarketPriceHandler = 0;
     }
+    _itemOwners.clear();
+    _userItems.clear();
+
+    if(_pChainHandler) {
+        delete _pChainHandler;
+        _pChainHandler = 0;
+    }
 
     if(_pMarketByOrderHandler) {
         delete _pMarketByOrderHandler;
@@ -1311,9 +1904,9 @@ void Pyrfa::cleanUp() {
         _pMarketByPriceHandler = 0;
     }
 
-    if(_pTimeSeries) {
-        _pTimeSeries->destroy();
-        _pTimeSeries = 0;
+    if(_pTimeSeriesHandler) {
+        delete _pTimeSeriesHandler;
+        _pTimeSeriesHandler = 0;
     }
 
     if(_pTS1DictDb) {
@@ -1331,6 +1924,12 @@ void Pyrfa::cleanUp() {
         _pOMMPost = 0;
     }
 
+    // drop events which were never drained
+    if(_pEventRing) {
+        delete _pEventRing;
+        _pEventRing = 0;
+    }
+
     if(_pDictionaryHandler) {
         delete _pDictionaryHandler;
         _pDictionaryHandler = 0;
@@ -1431,6 +2030,15 @@ void Pyrfa::_logError(std::string log) {
 }
 
 void Pyrfa::processEvent(const rfa::common::Event& event){
+    // on the dispatch thread, market price is decoded without the GIL
+    if(_pDispatchThread && (event.getType() == rfa::sessionLayer::OMMItemEventEnum)) {
+        if(processNativeOMMItemEvent(static_cast<const rfa::sessionLayer::OMMItemEvent&>(event)))
+            return;
+    }
+
+    // called back from EventQueue::dispatch without the GIL
+    CPyGILEnsure withGIL;
+
     if(_debug)
         cout << "[Pyrfa::processEvent] @" << boost::posix_time::to_simple_string(boost::posix_time::microsec_clock::local_time().time_of_day()).c_str() << endl;
 
@@ -1485,6 +2093,215 @@ void Pyrfa::processEvent(const rfa::common::Event& event){
             }
         break;
     }
+
+    // on the dispatch thread, queue what the handlers decoded for Python
+    if(_pDispatchThread && (len(_eventData) > 0)) {
+        rfa::common::UInt8 msgModelType = 0;
+        if(event.getType() == rfa::sessionLayer::OMMItemEventEnum)
+            msgModelType = static_cast<const rfa::sessionLayer::OMMItemEvent&>(event).getMsg().getMsgModelType();
+        pushEventData(msgModelType);
+    }
+}
+
+/*
+* Decode market price into native records on the dispatch thread.
+* return false to fall back to the handlers which need the GIL.
+*/
+bool Pyrfa::processNativeOMMItemEvent(const rfa::sessionLayer::OMMItemEvent &OMMEvent) {
+    const rfa::message::RespMsg& respMsg = static_cast<const rfa::message::RespMsg&> (OMMEvent.getMsg());
+    if(respMsg.getMsgModelType() != rfa::rdm::MMT_MARKET_PRICE)
+        return false;
+
+    std::vector<EventRecord*> records;
+    {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        // chain records and time series are resolved with the GIL
+        if(!_pMarketPriceHandler || (_pChainHandler && _pChainHandler->isChainRecord(OMMEvent.getHandle())))
+            return false;
+        if(_pTimeSeriesHandler && _pTimeSeriesHandler->isTimeSeriesItem(OMMEvent.getHandle()))
+            return false;
+        _pMarketPriceHandler->processResponse(respMsg, OMMEvent.getHandle(), records);
+    }
+
+    for(size_t i = 0; i < records.size(); i++) {
+        // hold the dispatch thread back while Python catches up
+        while(!_pEventRing->push(records[i])) {
+            _pEventRing->full();
+            if(_pDispatchThread->stopRequested()) {
+                delete records[i];
+                break;
+            }
+            _pDispatchThread->Sleep(1);
+        }
+    }
+    return true;
+}
+
+/*
+* Move the Python events decoded on the dispatch thread to the ring.
+* Called with the GIL held.
+*/
+void Pyrfa::pushEventData(rfa::common::UInt8 msgModelType) {
+    for(int i = 0; i < len(_eventData); i++) {
+        EventRecord *record = new EventRecord();
+        record->msgModelType = msgModelType;
+        record->pyObject = boost::python::object(_eventData[i]).ptr();
+        Py_INCREF(record->pyObject);
+
+        while(!_pEventRing->push(record)) {
+            _pEventRing->full();
+            if(_pDispatchThread->stopRequested()) {
+                Py_DECREF(record->pyObject);
+                delete record;
+                break;
+            }
+            // let Python drain the ring
+            CPyGILRelease noGIL;
+            _pDispatchThread->Sleep(1);
+        }
+    }
+    _eventData = boost::python::list();
+}
+
+/*
+* Move decoded events from the ring of the dispatch thread to the out list.
+* Wait up to timeout milliseconds for the first event.
+* return events left in the ring.
+*/
+long Pyrfa::drainEventRing(boost::python::list out, long timeout, long maxEvents, long budget) {
+    long processedEvents = 0;
+    bool hasCallbacks = (len(_callbacks) > 0) || (len(_ricCallbacks) > 0);
+
+    // conflated updates whose interval is over
+    flushConflated(out);
+    boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
+    boost::posix_time::ptime timeoutTime = startTime + boost::posix_time::milliseconds(timeout);
+    boost::posix_time::ptime deadline = startTime + boost::posix_time::milliseconds(budget);
+
+    while( (maxEvents <= 0) || (processedEvents < maxEvents) ) {
+        EventRecord *record = _pEventRing->pop();
+        if(!record) {
+            // wait for the first event only, while the thread is running
+            if( (processedEvents > 0) || !_pDispatchThread || (boost::posix_time::microsec_clock::universal_time() >= timeoutTime) )
+                break;
+            CPyGILRelease noGIL;
+            _pDispatchThread->Sleep(1);
+            continue;
+        }
+        processedEvents++;
+
+        object event = eventRecordToPython(*record);
+        if(hasCallbacks) {
+            boost::python::list events;
+            events.append(event);
+            dispatchCallbacks(record->msgModelType, events);
+            out.extend(events);
+        } else {
+            out.append(event);
+        }
+        delete record;
+
+        if( (budget > 0) && (boost::posix_time::microsec_clock::universal_time() >= deadline) )
+            break;
+    }
+
+    // get messages from loggerr
+    dispatchLoggerEventQueue(0);
+
+    return (long)_pEventRing->depth();
+}
+
+/*
+* Convert a record of the ring to the same dict the Python handlers produce.
+*/
+object Pyrfa::eventRecordToPython(const EventRecord &record) {
+    // already decoded by a handler, take over its reference
+    if(record.pyObject)
+        return object(handle<>(record.pyObject));
+
+    if(record.mtype.empty())
+        return dict();
+
+    const FieldDecodeTable* pDecodeTable = _pDictionaryHandler->getDecodeTable();
+    if(!record.payload.empty()) {
+        FieldDecodeTable::FixedKey mtype = (record.mtype == "IMAGE") ? FieldDecodeTable::ImageValue : FieldDecodeTable::UpdateValue;
+        boost::shared_ptr<LazyUpdate> update(new LazyUpdate(&record.payload[0], record.payload.size(), _pDictionaryHandler->getSharedDictionary(), _pDictionaryHandler->getSharedDecodeTable(), object(record.itemName), object(record.serviceName), mtype));
+        return object(update);
+    }
+    dict d = FieldDecodeTable::newDict(record.fields.size() + 3);
+    for(std::vector<FieldValue>::const_iterator it = record.fields.begin(); it != record.fields.end(); ++it)
+        pDecodeTable->setField(d, *it);
+
+    pDecodeTable->setItem(d, FieldDecodeTable::RicKey, record.itemName);
+    pDecodeTable->setItem(d, FieldDecodeTable::ServiceKey, record.serviceName);
+    pDecodeTable->setItem(d, FieldDecodeTable::MTypeKey, record.mtype);
+    if(record.mtype == "STATUS") {
+        d["TEXT"] = record.text;
+        d["DATA_STATE"] = record.dataState;
+        d["STREAM_STATE"] = record.streamState;
+        d["STATUS_CODE"] = record.statusCode;
+    }
+    return d;
+}
+
+/*
+* Run RFA dispatching and market price decoding on a native thread.
+* dispatchEventQueue then only hands the decoded events to Python.
+*/
+void Pyrfa::startDispatchThread(long capacity=65536) {
+    if(!_pEventQueue || _pDispatchThread)
+        return;
+
+    if(capacity <= 0) {
+        _log = "[Pyrfa::startDispatchThread] Ring capacity must be positive.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    // leftovers of a previous run are kept until drained
+    if(!_pEventRing)
+        _pEventRing = new CEventRing((size_t)capacity);
+
+    _pDispatchThread = new DispatchThread(*_pEventQueue, 100);
+    _pDispatchThread->start();
+
+    if(_debug) {
+        _log = "[Pyrfa::startDispatchThread] Dispatch thread started. Ring capacity: ";
+        _log.append((int)_pEventRing->capacity());
+        _logInfo(_log.c_str());
+    }
+}
+
+void Pyrfa::stopDispatchThread() {
+    if(!_pDispatchThread)
+        return;
+
+    _pDispatchThread->stop();
+    {
+        // the thread may need the GIL to finish its last event
+        CPyGILRelease noGIL;
+        _pDispatchThread->wait();
+    }
+    delete _pDispatchThread;
+    _pDispatchThread = 0;
+
+    if(_debug)
+        _logInfo("[Pyrfa::stopDispatchThread] Dispatch thread stopped.");
+}
+
+/*
+* Ring statistics to monitor how far behind Python is.
+*/
+dict Pyrfa::getEventRingStats() {
+    dict d;
+    if(!_pEventRing)
+        return d;
+    d["DEPTH"] = _pEventRing->depth();
+    d["HIGH_WATER_MARK"] = _pEventRing->highWaterMark();
+    d["CAPACITY"] = _pEventRing->capacity();
+    d["COUNT"] = _pEventRing->pushCount();
+    d["FULL"] = _pEventRing->fullCount();
+    return d;
 }
 
 void Pyrfa::processConnectionEvent(const rfa::sessionLayer::ConnectionEvent & CEvent) {
@@ -1529,12 +2346,13 @@ void Pyrfa::processOMMActiveClientSessionEvent(const rfa::sessionLayer::OMMActiv
     }
 
     _pOMMInteractiveProvider->addClientWatchList(pCliSessHandle);
-    dispatchEventQueue(0);
+    if(!_pDispatchThread)
+        dispatchEventQueue(0);
 }
 
 void Pyrfa::processOMMInactiveClientSessionEvent(const rfa::sessionLayer::OMMInactiveClientSessionEvent& event) {
-    // output string meant for Python tuple
-    _eventData = boost::python::tuple();
+    // output meant for Python list
+    _eventData = boost::python::list();
 
     _log = "[Pyrfa::processOMMInactiveClientSessionEvent] Client session disconnected.";
     _logInfo(_log.c_str());
@@ -1545,8 +2363,8 @@ void Pyrfa::processOMMInactiveClientSessionEvent(const rfa::sessionLayer::OMMIna
 }
 
 void Pyrfa::processOMMSolicitedItemEvent(const rfa::sessionLayer::OMMSolicitedItemEvent& event) {
-    // output string meant for Python tuple
-    _eventData = boost::python::tuple();
+    // output meant for Python list
+    _eventData = boost::python::list();
 
     const rfa::common::Msg& msg = event.getMsg();
 	switch(msg.getMsgType())
@@ -1578,67 +2396,134 @@ std::string Pyrfa::getServiceName() {
     return _serviceName;
 }
 
-void Pyrfa::timeSeriesRequest(object const &argv) {
-    if(!_pOMMConsumer)
-        return;
+/*
+* Register a Python callable to receive each decoded event of a domain
+* directly from the dispatch loop. A callable registered for a RIC takes
+* precedence over the one of its domain. None removes the callable.
+* Events without a callable are still returned by dispatchEventQueue.
+*/
+void Pyrfa::setCallback(object const &argv1, object const &argv2, object const &argv3=object()) {
+    int domain = extract<int>(argv1);
+
+    if(!argv2.is_none() && !PyCallable_Check(argv2.ptr())) {
+        _log = "[Pyrfa::setCallback] Callback is not callable.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
 
-    // If timeseries is called before, destroy the old one first
-    if(_pTimeSeries) {
-        _pTimeSeries->destroy();
-        _pTimeSeries = 0;
+    if(argv3 == object()) {
+        if(argv2.is_none()) {
+            _callbacks.attr("pop")(domain, object());
+        } else {
+            _callbacks[domain] = argv2;
+        }
+        return;
     }
 
     #if PY_MAJOR_VERSION >= 3
-    std::string itemName = extract<string>(argv);
+    std::string itemName = extract<string>(argv3);
     #else
-    std::string itemName = extract<string>(str(argv).encode("utf-8"));
+    std::string itemName = extract<string>(str(argv3).encode("utf-8"));
     #endif
-    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
-        boost::trim(itemName);
-        if(itemName.empty())
-            return;
-        // Create a new TS1Series object
-        _pTimeSeries = rfa::ts1::TS1Series::createSeries(itemName.c_str(), _timeSeriesPeriod);
+    boost::trim(itemName);
+
+    if(!_ricCallbacks.has_key(domain))
+        _ricCallbacks[domain] = dict();
+    dict ricCallbacks = extract<dict>(_ricCallbacks[domain]);
+    if(argv2.is_none()) {
+        ricCallbacks.attr("pop")(itemName, object());
+    } else {
+        ricCallbacks[itemName] = argv2;
+    }
+}
 
+/*
+* Hand the events decoded from one RFA event to the registered callables.
+* Events which are handled are removed from the dispatch output.
+*/
+void Pyrfa::dispatchCallbacks(int domain, boost::python::list &events) {
+    object callback = _callbacks.get(domain);
+    object ricCallbacks = _ricCallbacks.get(domain);
+    if(callback.is_none() && ricCallbacks.is_none())
+        return;
+
+    boost::python::list unhandled;
+    for(int i = 0; i < len(events); i++) {
+        object event = events[i];
+        object handler = callback;
+        if(!ricCallbacks.is_none()) {
+            object ric;
+            extract<dict> eventDict(event);
+            extract<LazyUpdate&> lazyUpdate(event);
+            if(eventDict.check())
+                ric = eventDict().get("RIC");
+            else if(lazyUpdate.check())
+                ric = lazyUpdate().getRic();
+            object ricCallback = extract<dict>(ricCallbacks)().get(ric);
+            if(!ricCallback.is_none())
+                handler = ricCallback;
+        }
+        if(handler.is_none()) {
+            unhandled.append(event);
+            continue;
+        }
+        try {
+            handler(event);
+        } catch( error_already_set ) {
+            // do not let a Python exception unwind through the RFA dispatch
+            PyErr_Print();
+            _logError("[Pyrfa::dispatchCallbacks] Exception raised from callback.");
+        }
+    }
+    events = unhandled;
+}
+
+/*
+* Request the time series of items, one or more comma separated names or a list.
+* At most setTimeSeriesConcurrency() series are retrieved at once, the rest are queued.
+* The Completion returned is done once every series is parsed.
+*/
+object Pyrfa::timeSeriesRequest(object const &argv) {
+    vector<string> requested;
+    if(!_pOMMConsumer)
+        return newCompletion(CompletionRegistry::TimeSeries, requested);
+
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
         if(!_pTimeSeriesHandler) {
-            // Initiate TS1 DB object for once
+            // Initiate TS1 DB object for once, shared by every series
             _pTS1DictDb = rfa::ts1::TS1DefDb::createTS1DefDb();
-            _pTimeSeriesHandler = new TimeSeriesHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), *_pComponentLogger, *_pTS1DictDb);
-            _pTimeSeriesHandler->initTimeSeries(_pTimeSeries);
+            _pTimeSeriesHandler = new TimeSeriesHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger, *_pTS1DictDb);
             _pTimeSeriesHandler->setDebugMode(_debug);
-
-            // Request the TS1 Dictionary
+            _pTimeSeriesHandler->setCompletions(_pCompletions);
+            _pTimeSeriesHandler->setConcurrency(_timeSeriesConcurrency);
             if(_debug) {
                 _log = "[Pyrfa::timeSeriesRequest] TS1 DB RICs from ";
                 _log.append(_serviceName.c_str());
                 _logInfo(_log.c_str());
             }
-            for(int i=0; i < _pTS1DictDb->getNumberDbRics(); ++i ) {
-                _pTimeSeriesHandler->sendRequest(_pTS1DictDb->getTs1DbRics(i));
-            }
-            exec("time.sleep(0.1)");
-        } else {
-            _pTimeSeriesHandler->initTimeSeries(_pTimeSeries);
         }
 
-        // Request the TS1 Data.
-        _pTimeSeriesHandler->sendRequest(_pTimeSeries->getPrimaryRic());
+        // Request the TS1 Data, the TS1 DB RICs come with the first series.
+        for(size_t i = 0; i < itemList.size(); i++) {
+            _pTimeSeriesHandler->requestSeries(itemList[i], _timeSeriesPeriod);
+            requested.push_back(itemList[i]);
+        }
     } else {
         _logError("[Pyrfa::timeSeriesRequest] Dictionary not made available or user not logged in");
     }
+    return newCompletion(CompletionRegistry::TimeSeries, requested);
 }
 
 void Pyrfa::timeSeriesCloseRequest(object const &argv) {
     if(!_pTimeSeriesHandler)
         return;
 
-    #if PY_MAJOR_VERSION >= 3
-    std::string itemName = extract<string>(argv);
-    #else
-    std::string itemName = extract<string>(str(argv).encode("utf-8"));
-    #endif
-    boost::trim(itemName);
-    _pTimeSeriesHandler->closeRequest(itemName);
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+    for(size_t i = 0; i < itemList.size(); i++)
+        _pTimeSeriesHandler->closeSeries(itemList[i]);
 }
 
 void Pyrfa::timeSeriesCloseAllRequest() {
@@ -1666,79 +2551,196 @@ void Pyrfa::setTimeSeriesMaxRecords(int maxRecords) {
     _timeSeriesMaxRecords = maxRecords;
 }
 
-boost::python::tuple Pyrfa::getTimeSeries(object const &argv) {
-    // subscribe, wait for completion and unsubscribe add DB rics and data ric
-    // getTimeSeries supports only one RIC series retreival at a time
-    // #if PY_MAJOR_VERSION >= 3
-    // std::string itemName = extract<string>(argv);
-    // #else
-    // std::string itemName = extract<string>(str(argv).encode("utf-8"));
-    // #endif
-    // timeSeriesRequest(str(itemName));
-    timeSeriesRequest(argv);
-    while (!isTimeSeriesParseComplete()) {
-        dispatchEventQueue(100);
-    }
-    // timeSeriesCloseRequest(str(itemName));
-    timeSeriesCloseRequest(argv);
+/*
+* Number of series retrieved at once, 0 for no limit.
+*/
+void Pyrfa::setTimeSeriesConcurrency(int concurrency) {
+    _timeSeriesConcurrency = concurrency > 0 ? concurrency : 0;
+    if(_pTimeSeriesHandler)
+        _pTimeSeriesHandler->setConcurrency(_timeSeriesConcurrency);
+}
 
-    if(!_pTimeSeriesHandler)
+/*
+* Output of getTimeSeries(): 'records' (the default), a tuple of CSV strings with a header,
+* or 'days' and 'seconds', a dict of typed columns whose DATE column holds epoch days or seconds.
+*/
+void Pyrfa::setTimeSeriesMode(object const &argv) {
+#if PY_MAJOR_VERSION >= 3
+    std::string mode = extract<std::string>(argv);
+#else
+    std::string mode = extract<std::string>(str(argv).encode("utf-8"));
+#endif
+    if(mode == "records")
+        _timeSeriesMode = TimeSeriesRecords;
+    else if(mode == "days")
+        _timeSeriesMode = TimeSeriesDays;
+    else if(mode == "seconds")
+        _timeSeriesMode = TimeSeriesSeconds;
+    else {
+        _log = "[Pyrfa::setTimeSeriesMode] Mode must be 'records', 'days' or 'seconds'.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+}
+
+/*
+* A parsed series in the time series mode, an empty tuple or None if it failed.
+*/
+object Pyrfa::timeSeriesOutput(const std::string &itemName) {
+    if(_timeSeriesMode == TimeSeriesRecords)
+        return timeSeriesRecords(itemName);
+
+    dict columns;
+    if(!_pTimeSeriesHandler || !_pTimeSeriesHandler->getTimeSeriesColumns(itemName, _timeSeriesMaxRecords, _timeSeriesMode == TimeSeriesSeconds, columns)) {
+        if(_debug)
+            _logInfo("[Pyrfa::getTimeSeries] Timeseries is empty.");
+        return object();
+    }
+    return columns;
+}
+
+/*
+* Records of a parsed series as a tuple of strings, empty if it failed.
+*/
+boost::python::tuple Pyrfa::timeSeriesRecords(const std::string &itemName) {
+    std::list<std::string> timeSeries;
+    if(!_pTimeSeriesHandler || !_pTimeSeriesHandler->getTimeSeries(itemName, _timeSeriesMaxRecords, timeSeries) || timeSeries.empty()) {
+        if(_debug)
+            _logInfo("[Pyrfa::getTimeSeries] Timeseries is empty.");
         return boost::python::tuple();
+    }
+
+    boost::python::list timeSeriesList;
+    for(std::list<std::string>::const_iterator i=timeSeries.begin(); i != timeSeries.end(); ++i) {
+        if(_debug)
+            cout << *i << endl;
+        // serialize into a Python tuple
+        timeSeriesList.append(*i);
+    }
+    return boost::python::tuple(timeSeriesList);
+}
+
+object Pyrfa::getTimeSeries(object const &argv) {
+    // subscribe, wait for completion and unsubscribe add DB rics and data ric
+    #if PY_MAJOR_VERSION >= 3
+    std::string itemName = extract<string>(argv);
+    #else
+    std::string itemName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    boost::trim(itemName);
+    object completion = timeSeriesRequest(str(itemName));
+    waitFor(extract<boost::shared_ptr<Completion> >(completion)());
+
+    _timeSeries = timeSeriesOutput(itemName);
+    timeSeriesCloseRequest(str(itemName));
+    return _timeSeries;
+}
+
+/*
+* Retrieve the series of many items at once, comma separated names or a list.
+* return a dict of records by item, empty for the series which failed.
+*/
+dict Pyrfa::getTimeSeriesBatch(object const &argv) {
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+    boost::python::list items;
+    for(size_t i = 0; i < itemList.size(); i++)
+        items.append(itemList[i]);
+    object completion = timeSeriesRequest(items);
+    waitFor(extract<boost::shared_ptr<Completion> >(completion)());
+
+    dict timeSeries;
+    for(size_t i = 0; i < itemList.size(); i++) {
+        timeSeries[itemList[i]] = timeSeriesOutput(itemList[i]);
+        if(_pTimeSeriesHandler)
+            _pTimeSeriesHandler->closeSeries(itemList[i]);
+    }
+    return timeSeries;
+}
+
+/*
+* Request the history of items, one or more comma separated names. The Completion
+* returned is done once every item has a complete refresh.
+*/
+object Pyrfa::historyRequest(object const &argv) {
+    vector<string> requested;
+    if(!_pOMMConsumer)
+        return newCompletion(CompletionRegistry::History, requested);
+
+    if(_pHistoryHandler == NULL) {
+        _pHistoryHandler = new HistoryHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
+        _pHistoryHandler->setDebugMode(_debug);
+        _pHistoryHandler->setCompletions(_pCompletions);
+        if(_debug) {
+            _log = "[Pyrfa::historyRequest] Subscribe to a service: ";
+            _log.append(_serviceName.c_str());
+            _logInfo(_log.c_str());
+        }
+    }
 
-    const std::list<std::string> *timeSeries;
-    timeSeries = _pTimeSeriesHandler->getTimeSeries(_timeSeriesMaxRecords);
-    rfa::common::UInt32 timeSeriesRecordCount = timeSeries->size();
-    if(timeSeriesRecordCount > 0) {
-        rfa::common::UInt32 ii(0);
-        _timeSeries = boost::python::tuple();
-        for(std::list<std::string>::const_iterator i=timeSeries->begin(); i != timeSeries->end(); ++i) {
-            if(_debug)
-                cout << *i << endl;
-            // serialize into a Python tuple
-            _timeSeries += boost::python::make_tuple(*i);
-            ii++;
-        }
-        return _timeSeries;
+    #if PY_MAJOR_VERSION >= 3
+    std::string itemName = extract<string>(argv);
+    #else
+    std::string itemName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    vector<string> itemList;
+    boost::split(itemList, itemName, boost::is_any_of(","));
+    if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
+        for(size_t i = 0; i < itemList.size(); i++) {
+            boost::trim(itemList[i]);
+            if(itemList[i].empty())
+                continue;
+            if(_interactionType == rfa::message::ReqMsg::InitialImageFlag)
+                _pHistoryHandler->closeRequest(itemList[i]);
+            _pHistoryHandler->sendRequest(itemList[i], _interactionType);
+            requested.push_back(itemList[i]);
+        }
+        _isHistoryAvailable = true;
     } else {
-        if(_debug)
-            _logInfo("[Pyrfa::getTimeSeries] Timeseries is empty.");
-        return boost::python::tuple();
+        _logError("[Pyrfa::historyRequest] Dictionary not made available or user not logged in");
+        _isHistoryAvailable = false;
     }
+    return newCompletion(CompletionRegistry::History, requested);
 }
 
-void Pyrfa::historyRequest(object const &argv) {
+/*
+* Subscribe to many items with batch requests of at most chunkSize items each.
+*/
+void Pyrfa::historyBatchRequest(object const &argv, long chunkSize=1000) {
     if(!_pOMMConsumer)
         return;
 
+    if(chunkSize <= 0) {
+        _log = "[Pyrfa::historyBatchRequest] Chunk size must be positive.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
     if(_pHistoryHandler == NULL) {
-        _pHistoryHandler = new HistoryHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), *_pComponentLogger);
+        _pHistoryHandler = new HistoryHandler(_pOMMConsumer, *_pEventQueue, *this, _serviceName, _pDictionaryHandler->getDictionary(), _pDictionaryHandler->getDecodeTable(), *_pComponentLogger);
         _pHistoryHandler->setDebugMode(_debug);
+        _pHistoryHandler->setCompletions(_pCompletions);
         if(_debug) {
-            _log = "[Pyrfa::historyRequest] Subscribe to a service: ";
+            _log = "[Pyrfa::historyBatchRequest] Subscribe to a service: ";
             _log.append(_serviceName.c_str());
             _logInfo(_log.c_str());
         }
     }
 
-    #if PY_MAJOR_VERSION >= 3
-    std::string itemName = extract<string>(argv);
-    #else
-    std::string itemName = extract<string>(str(argv).encode("utf-8"));
-    #endif
     vector<string> itemList;
-    boost::split(itemList, itemName, boost::is_any_of(","));
+    batchItemList(argv, itemList);
     if (_pDictionaryHandler->isAvailable() && _pLoginHandler->isLoggedIn()) {
-        for(size_t i = 0; i < itemList.size(); i++) {
-            boost::trim(itemList[i]);
-            if(itemList[i].empty())
-                continue;
-            if(_interactionType == rfa::message::ReqMsg::InitialImageFlag)
+        if(_interactionType == rfa::message::ReqMsg::InitialImageFlag) {
+            for(size_t i = 0; i < itemList.size(); i++)
                 _pHistoryHandler->closeRequest(itemList[i]);
-            _pHistoryHandler->sendRequest(itemList[i], _interactionType);
+        }
+        for(size_t i = 0; i < itemList.size(); i += (size_t)chunkSize) {
+            vector<string> chunk(itemList.begin() + i, itemList.begin() + std::min(itemList.size(), i + (size_t)chunkSize));
+            _pHistoryHandler->sendBatchRequest(chunk, _interactionType);
         }
         _isHistoryAvailable = true;
     } else {
-        _logError("[Pyrfa::historyRequest] Dictionary not made available or user not logged in");
+        _logError("[Pyrfa::historyBatchRequest] Dictionary not made available or user not logged in");
         _isHistoryAvailable = false;
     }
 }
@@ -2581,8 +3583,8 @@ void Pyrfa::resumeAll() {
 
 void Pyrfa::processOMMItemEvent(const rfa::sessionLayer::OMMItemEvent &OMMEvent)
 {
-    // output string meant for Python tuple
-    _eventData = boost::python::tuple();
+    // output meant for Python list
+    _eventData = boost::python::list();
 
     const rfa::message::RespMsg& respMsg = static_cast<const rfa::message::RespMsg&> (OMMEvent.getMsg());
     switch (respMsg.getMsgModelType())
@@ -2598,12 +3600,20 @@ void Pyrfa::processOMMItemEvent(const rfa::sessionLayer::OMMItemEvent &OMMEvent)
         break;
     case rfa::rdm::MMT_SYMBOL_LIST:
         _pSymbolListHandler->processResponse(respMsg, OMMEvent.getHandle(), _eventData);
+        // the dispatch thread holds the GIL and must not wait for the market price lock,
+        // dispatchEvents() subscribes the members on the Python thread
+        if(!_pDispatchThread)
+            updateSubscriptions();
         break;
     case rfa::rdm::MMT_MARKET_PRICE:
-        if(_pMarketPriceHandler) {
-            _pMarketPriceHandler->processResponse(respMsg, OMMEvent.getHandle(), _eventData);
-        } else if(_pTimeSeriesHandler) {
+        if(_pChainHandler && _pChainHandler->isChainRecord(OMMEvent.getHandle())) {
+            _pChainHandler->processResponse(respMsg, OMMEvent.getHandle(), _eventData);
+            if(!_pDispatchThread)
+                updateSubscriptions();
+        } else if(_pTimeSeriesHandler && _pTimeSeriesHandler->isTimeSeriesItem(OMMEvent.getHandle())) {
             _pTimeSeriesHandler->processResponse(respMsg, OMMEvent.getHandle(), _eventData);
+        } else if(_pMarketPriceHandler) {
+            _pMarketPriceHandler->processResponse(respMsg, OMMEvent.getHandle(), _eventData);
         }
         break;
     case rfa::rdm::MMT_MARKET_BY_ORDER:
@@ -2622,6 +3632,11 @@ void Pyrfa::processOMMItemEvent(const rfa::sessionLayer::OMMItemEvent &OMMEvent)
         _logError(_log.c_str());
         break;
     }
+
+    // route to the registered callbacks, if any
+    // the dispatch thread leaves this to the thread draining the ring
+    if(!_pDispatchThread && (len(_eventData) > 0))
+        dispatchCallbacks(respMsg.getMsgModelType(), _eventData);
 }
 
 void Pyrfa::processOMMCmdErrorEvent(const rfa::sessionLayer::OMMCmdErrorEvent &CmdEvent) {
@@ -2654,6 +3669,520 @@ void Pyrfa::setView(object const &argv=object()) {
     _viewFIDs = viewFIDs;
 }
 
+/*
+* Cap the market price, market by order and market by price requests
+* still waiting for a complete refresh, per domain. 0 sends every request at once.
+* A request gives its slot up after timeout milliseconds, 0 waits without limit.
+*/
+void Pyrfa::setRequestWindow(long window, long timeout=0) {
+    if(window < 0 || timeout < 0) {
+        _log = "[Pyrfa::setRequestWindow] Request window and timeout must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    _requestWindow = window;
+    _requestTimeout = timeout;
+    if(_pMarketPriceHandler) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pMarketPriceHandler->setRequestWindow(_requestWindow, _requestTimeout);
+    }
+    if(_pMarketByOrderHandler)
+        _pMarketByOrderHandler->setRequestWindow(_requestWindow, _requestTimeout);
+    if(_pMarketByPriceHandler)
+        _pMarketByPriceHandler->setRequestWindow(_requestWindow, _requestTimeout);
+}
+
+// counters of a request scheduler, copied under the market price lock
+struct RequestSchedulerStats
+{
+    RequestSchedulerStats() : window(0), queued(0), outstanding(0), sent(0), complete(0), timeout(0), expired(0) {}
+    RequestSchedulerStats(const RequestScheduler &scheduler) :
+        window(scheduler.window()), queued(scheduler.queued()), outstanding(scheduler.outstanding()),
+        sent(scheduler.sentCount()), complete(scheduler.completeCount()), timeout(scheduler.timeout()),
+        expired(scheduler.expiredCount()) {}
+
+    size_t          window;
+    size_t          queued;
+    size_t          outstanding;
+    unsigned long   sent;
+    unsigned long   complete;
+    long            timeout;
+    unsigned long   expired;
+};
+
+static dict requestSchedulerStats(const RequestSchedulerStats &stats) {
+    dict d;
+    d["WINDOW"] = stats.window;
+    d["QUEUED"] = stats.queued;
+    d["OUTSTANDING"] = stats.outstanding;
+    d["SENT"] = stats.sent;
+    d["COMPLETE"] = stats.complete;
+    d["TIMEOUT"] = stats.timeout;
+    d["EXPIRED"] = stats.expired;
+    return d;
+}
+
+/*
+* Keep the last value of every field of the subscribed market price items.
+* With mergeUpdates every update is delivered as the whole merged image.
+*/
+void Pyrfa::setImageCache(bool enable, bool mergeUpdates=false) {
+    _cacheImages = enable;
+    _mergeUpdates = mergeUpdates;
+    if(_pMarketPriceHandler) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pMarketPriceHandler->setImageCache(_cacheImages, _mergeUpdates);
+    }
+}
+
+/*
+* FIDs of a comma separated string or an iterable of field names or FIDs.
+* return false if some names are neither in the dictionary nor numbers, those are left out.
+*/
+bool Pyrfa::fieldIdList(object const &argv, std::vector<rfa::common::Int16> &fieldIds) {
+    vector<string> fieldList;
+    #if PY_MAJOR_VERSION >= 3
+    if(PyUnicode_Check(argv.ptr())) {
+    #else
+    if(PyString_Check(argv.ptr()) || PyUnicode_Check(argv.ptr())) {
+    #endif
+        batchItemList(argv, fieldList);
+    } else {
+        stl_input_iterator<object> it(argv), end;
+        for(; it != end; ++it) {
+            extract<int> fieldId(*it);
+            if(fieldId.check()) {
+                fieldIds.push_back((rfa::common::Int16)fieldId());
+            } else {
+                #if PY_MAJOR_VERSION >= 3
+                fieldList.push_back(extract<string>(*it));
+                #else
+                fieldList.push_back(extract<string>(str(*it).encode("utf-8")));
+                #endif
+                boost::trim(fieldList.back());
+            }
+        }
+    }
+    bool resolved = true;
+    for(size_t i = 0; i < fieldList.size(); i++) {
+        if(fieldList[i].empty())
+            continue;
+        const RDMFieldDef* fieldDef = _pDictionaryHandler ? _pDictionaryHandler->getDictionary()->getFieldDef(boost::to_upper_copy(fieldList[i]).c_str()) : NULL;
+        if(fieldDef)
+            fieldIds.push_back((rfa::common::Int16)fieldDef->getFieldId());
+        else if(fieldList[i].find_first_not_of("-0123456789") == std::string::npos)
+            fieldIds.push_back((rfa::common::Int16)atoi(fieldList[i].c_str()));
+        else
+            resolved = false;
+    }
+    return resolved;
+}
+
+/*
+* Cached image of a market price item, no request goes to the network.
+* fields is a comma separated string or an iterable of field names or FIDs.
+*/
+dict Pyrfa::getImage(object const &argv1, object const &argv2=object()) {
+    #if PY_MAJOR_VERSION >= 3
+    std::string itemName = extract<string>(argv1);
+    #else
+    std::string itemName = extract<string>(str(argv1).encode("utf-8"));
+    #endif
+    boost::trim(itemName);
+
+    std::vector<rfa::common::Int16> fieldIds;
+    if(argv2 != object()) {
+        fieldIdList(argv2, fieldIds);
+        // none of the fields exist
+        if(fieldIds.empty())
+            return dict();
+    }
+
+    if(!_pMarketPriceHandler)
+        return dict();
+    LastValueCache::Image fields;
+    std::string serviceName;
+    bool found = false;
+    {
+        // copied under the lock, the dict is built without it
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        found = _pMarketPriceHandler->getImage(itemName, fieldIds, fields, serviceName);
+    }
+    if(!found)
+        return dict();
+    return _pMarketPriceHandler->imageToDict(itemName, serviceName, fields);
+}
+
+/*
+* Conflate the updates of the market price items requested from now on,
+* interval in milliseconds, 0 to deliver every update.
+* With tradeCount the merged update is delivered after that many trades even within the interval.
+*/
+void Pyrfa::setConflation(long interval, long tradeCount=0) {
+    if((interval < 0) || (tradeCount < 0)) {
+        _log = "[Pyrfa::setConflation] Interval and trade count must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    _conflationInterval = interval;
+    _conflationTradeCount = tradeCount;
+}
+
+/*
+* Conflate the updates of market price items, subscribed or not.
+*/
+void Pyrfa::setItemConflation(object const &argv, long interval, long tradeCount=0) {
+    if((interval < 0) || (tradeCount < 0)) {
+        _log = "[Pyrfa::setItemConflation] Interval and trade count must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    vector<string> itemList;
+    batchItemList(argv, itemList);
+
+    if(!_pMarketPriceHandler) {
+        _logError("[Pyrfa::setItemConflation] No market price item has been requested");
+        return;
+    }
+    CMutex::CGuard guard(*_pMarketPriceMutex);
+    for(size_t i = 0; i < itemList.size(); i++)
+        _pMarketPriceHandler->setConflation(itemList[i], interval, tradeCount);
+}
+
+dict Pyrfa::getConflationStats() {
+    unsigned long held = 0;
+    unsigned long released = 0;
+    if(_pMarketPriceHandler) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        held = _pMarketPriceHandler->getConflator().heldCount();
+        released = _pMarketPriceHandler->getConflator().releasedCount();
+    }
+    dict d;
+    d["HELD"] = held;
+    d["RELEASED"] = released;
+    return d;
+}
+
+/*
+* Append the conflated updates whose interval is over to out.
+*/
+void Pyrfa::flushConflated(boost::python::list &out) {
+    if(!_pMarketPriceHandler)
+        return;
+
+    std::vector<EventRecord*> records;
+    {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pMarketPriceHandler->flushConflated(records);
+    }
+    if(records.empty())
+        return;
+
+    boost::python::list events;
+    for(size_t i = 0; i < records.size(); i++) {
+        events.append(eventRecordToPython(*records[i]));
+        delete records[i];
+    }
+    if((len(_callbacks) > 0) || (len(_ricCallbacks) > 0))
+        dispatchCallbacks(rfa::rdm::MMT_MARKET_PRICE, events);
+    out.extend(events);
+}
+
+/*
+* Deliver market price images and updates as pyrfa.LazyUpdate objects,
+* a field is decoded only when it is read.
+*/
+void Pyrfa::setLazyDecode(bool lazy) {
+    _lazyDecode = lazy;
+    if(_pMarketPriceHandler) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pMarketPriceHandler->setLazyDecode(_lazyDecode);
+    }
+}
+
+/*
+* Deliver each market by order refresh and update message as one columnar record.
+*/
+void Pyrfa::setMarketByOrderBatch(bool batch) {
+    _marketByOrderBatch = batch;
+    if(_pMarketByOrderHandler)
+        _pMarketByOrderHandler->setBatchMode(_marketByOrderBatch);
+}
+
+/*
+* Keep a native order book per market by order item and deliver its depth best levels
+* as BOOK records instead of a record per order, 0 turns the books off.
+*/
+void Pyrfa::setMarketByOrderBook(long depth) {
+    if(depth < 0) {
+        _log = "[Pyrfa::setMarketByOrderBook] Depth must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    _marketByOrderBookDepth = (size_t)depth;
+    if(_pMarketByOrderHandler)
+        _pMarketByOrderHandler->setBookDepth(_marketByOrderBookDepth);
+}
+
+/*
+* The depth best levels of the native order book of an item, all of them for 0.
+* An empty dict if the item has no book.
+*/
+dict Pyrfa::getBook(object const &argv, long depth=0) {
+    #if PY_MAJOR_VERSION >= 3
+    std::string itemName = extract<string>(argv);
+    #else
+    std::string itemName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    boost::trim(itemName);
+    if(depth < 0) {
+        _log = "[Pyrfa::getBook] Depth must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    dict book;
+    if(_pMarketByOrderHandler)
+        _pMarketByOrderHandler->getBook(itemName, (size_t)depth, book);
+    return book;
+}
+
+/*
+* Keep a native price level book per market by price item and deliver its depth best
+* levels as BOOK records instead of a record per level, 0 turns the books off.
+*/
+void Pyrfa::setMarketByPriceBook(long depth) {
+    if(depth < 0) {
+        _log = "[Pyrfa::setMarketByPriceBook] Depth must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    _marketByPriceBookDepth = (size_t)depth;
+    if(_pMarketByPriceHandler)
+        _pMarketByPriceHandler->setBookDepth(_marketByPriceBookDepth);
+}
+
+/*
+* The depth best levels of the native price level book of an item, all of them for 0.
+* An empty dict if the item has no book.
+*/
+dict Pyrfa::getDepth(object const &argv, long depth=0) {
+    #if PY_MAJOR_VERSION >= 3
+    std::string itemName = extract<string>(argv);
+    #else
+    std::string itemName = extract<string>(str(argv).encode("utf-8"));
+    #endif
+    boost::trim(itemName);
+    if(depth < 0) {
+        _log = "[Pyrfa::getDepth] Depth must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    dict book;
+    if(_pMarketByPriceHandler)
+        _pMarketByPriceHandler->getDepth(itemName, (size_t)depth, book);
+    return book;
+}
+
+/*
+* Decode DATE, TIME and DATETIME fields as 'string' (the default, formatted by RFA),
+* 'epoch' (int nanoseconds since the epoch, TIME since midnight) or 'native'
+* (datetime.date, datetime.time and datetime.datetime in UTC).
+*/
+void Pyrfa::setDateTimeMode(object const &argv) {
+#if PY_MAJOR_VERSION >= 3
+    std::string mode = extract<std::string>(argv);
+#else
+    std::string mode = extract<std::string>(str(argv).encode("utf-8"));
+#endif
+    if(mode == "string")
+        _dateTimeMode = FieldDecodeTable::DateTimeString;
+    else if(mode == "epoch")
+        _dateTimeMode = FieldDecodeTable::DateTimeEpoch;
+    else if(mode == "native")
+        _dateTimeMode = FieldDecodeTable::DateTimeNative;
+    else {
+        _log = "[Pyrfa::setDateTimeMode] Mode must be 'string', 'epoch' or 'native'.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    if(_pDictionaryHandler) {
+        // the market price dispatch thread reads the mode while decoding
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pDictionaryHandler->setDateTimeMode(_dateTimeMode);
+    }
+}
+
+/*
+* Decode REAL32 and REAL64 fields as 'double' (the default) or as 'decimal',
+* exact pyrfa.Real objects of the mantissa and magnitude type sent by the server.
+*/
+void Pyrfa::setRealMode(object const &argv) {
+#if PY_MAJOR_VERSION >= 3
+    std::string mode = extract<std::string>(argv);
+#else
+    std::string mode = extract<std::string>(str(argv).encode("utf-8"));
+#endif
+    if(mode == "double")
+        _realMode = FieldDecodeTable::RealDouble;
+    else if(mode == "decimal")
+        _realMode = FieldDecodeTable::RealDecimal;
+    else {
+        _log = "[Pyrfa::setRealMode] Mode must be 'double' or 'decimal'.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+    if(_pDictionaryHandler) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pDictionaryHandler->setRealMode(_realMode);
+    }
+}
+
+/*
+* Client side projection: decode only the given fields of a domain
+* (6 - market price, 7 - market by order, 8 - market by price), None decodes every field.
+* Unlike setView() it needs no support from the service.
+*/
+void Pyrfa::setFieldFilter(object const &argv1, object const &argv2) {
+    int domain = extract<int>(argv1);
+    if((domain != rfa::rdm::MMT_MARKET_PRICE) && (domain != rfa::rdm::MMT_MARKET_BY_ORDER) && (domain != rfa::rdm::MMT_MARKET_BY_PRICE)) {
+        _log = "[Pyrfa::setFieldFilter] Field filters apply to market price, market by order and market by price only.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    std::vector<rfa::common::Int16> fieldIds;
+    if(!argv2.is_none()) {
+        if(!fieldIdList(argv2, fieldIds)) {
+            _log = "[Pyrfa::setFieldFilter] Unknown field name.";
+            _logError(_log.c_str());
+            throw py_error(_log.c_str());
+        }
+        if(fieldIds.empty()) {
+            _log = "[Pyrfa::setFieldFilter] No field given, use None to decode every field.";
+            _logError(_log.c_str());
+            throw py_error(_log.c_str());
+        }
+    }
+    _fieldFilters[domain] = fieldIds;
+
+    switch(domain) {
+        case rfa::rdm::MMT_MARKET_PRICE:
+            if(_pMarketPriceHandler) {
+                CMutex::CGuard guard(*_pMarketPriceMutex);
+                _pMarketPriceHandler->setFieldFilter(fieldIds);
+            }
+            break;
+        case rfa::rdm::MMT_MARKET_BY_ORDER:
+            if(_pMarketByOrderHandler)
+                _pMarketByOrderHandler->setFieldFilter(fieldIds);
+            break;
+        case rfa::rdm::MMT_MARKET_BY_PRICE:
+            if(_pMarketByPriceHandler)
+                _pMarketByPriceHandler->setFieldFilter(fieldIds);
+            break;
+    }
+}
+
+/*
+* Columnar mode: decode the images and updates of market price items into typed columns
+* of the given numeric fields instead of dicts, capacity rows are preallocated.
+* No fields goes back to dicts.
+*/
+void Pyrfa::setColumnFields(object const &argv, long capacity=0) {
+    if(capacity < 0) {
+        _log = "[Pyrfa::setColumnFields] Capacity must not be negative.";
+        _logError(_log.c_str());
+        throw py_error(_log.c_str());
+    }
+
+    std::vector<ColumnBuffer::Field> fields;
+    if(argv != object()) {
+        if(!_pDictionaryHandler || !_pDictionaryHandler->isAvailable()) {
+            _log = "[Pyrfa::setColumnFields] Dictionary not made available.";
+            _logError(_log.c_str());
+            throw py_error(_log.c_str());
+        }
+        std::vector<rfa::common::Int16> fieldIds;
+        if(!fieldIdList(argv, fieldIds)) {
+            _log = "[Pyrfa::setColumnFields] Unknown field name.";
+            _logError(_log.c_str());
+            throw py_error(_log.c_str());
+        }
+        for(size_t i = 0; i < fieldIds.size(); i++) {
+            const RDMFieldDef* fieldDef = _pDictionaryHandler->getDictionary()->getFieldDef(fieldIds[i]);
+            if(!fieldDef) {
+                _log = "[Pyrfa::setColumnFields] Unknown FID ";
+                _log.append(boost::lexical_cast<string>(fieldIds[i]).c_str());
+                _log.append(".");
+                _logError(_log.c_str());
+                throw py_error(_log.c_str());
+            }
+            ColumnBuffer::Field field;
+            field.fieldId = fieldIds[i];
+            field.name = fieldDef->getName().c_str();
+            switch(FieldDecodeTable::converterFor((rfa::common::UInt8)fieldDef->getDataType())) {
+                case FieldDecodeTable::DoubleConverter:
+                    field.format = 'd';
+                    break;
+                case FieldDecodeTable::IntConverter:
+                case FieldDecodeTable::LongConverter:
+                case FieldDecodeTable::DateConverter:
+                case FieldDecodeTable::TimeConverter:
+                case FieldDecodeTable::DateTimeConverter:
+                    field.format = 'q';
+                    break;
+                default:
+                    _log = "[Pyrfa::setColumnFields] Field ";
+                    _log.append(field.name.c_str());
+                    _log.append(" is not numeric.");
+                    _logError(_log.c_str());
+                    throw py_error(_log.c_str());
+            }
+            fields.push_back(field);
+        }
+    }
+
+    _columnFields = fields;
+    _columnCapacity = capacity;
+    if(_pMarketPriceHandler) {
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pMarketPriceHandler->setColumns(_columnFields, (size_t)_columnCapacity);
+    }
+}
+
+/*
+* Rows decoded in columnar mode since the last call, as pyrfa.Column objects
+* NumPy wraps without a copy.
+*/
+dict Pyrfa::getColumns() {
+    ColumnBuffer rows;
+    if(_pMarketPriceHandler) {
+        // the rows are moved under the lock, the columns are built without it
+        CMutex::CGuard guard(*_pMarketPriceMutex);
+        _pMarketPriceHandler->takeColumns(rows);
+    }
+    return rows.take();
+}
+
+dict Pyrfa::getRequestStats() {
+    dict d;
+    if(_pMarketPriceHandler) {
+        RequestSchedulerStats stats;
+        {
+            CMutex::CGuard guard(*_pMarketPriceMutex);
+            stats = RequestSchedulerStats(_pMarketPriceHandler->getScheduler());
+        }
+        d["MARKET_PRICE"] = requestSchedulerStats(stats);
+    }
+    if(_pMarketByOrderHandler)
+        d["MARKET_BY_ORDER"] = requestSchedulerStats(_pMarketByOrderHandler->getScheduler());
+    if(_pMarketByPriceHandler)
+        d["MARKET_BY_PRICE"] = requestSchedulerStats(_pMarketByPriceHandler->getScheduler());
+    return d;
+}
+
 int Pyrfa::getFieldType(object const &argv) {
     #if PY_MAJOR_VERSION >= 3
     const char* fieldName = extract<const char*>(argv);
@@ -2724,13 +4253,70 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_printConfigDb_overloads, Pyrfa::pri
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setDebugMode_overloads, Pyrfa::setDebugMode, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_login_overloads, Pyrfa::login, 0, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_dispatchEventQueue_overloads, Pyrfa::dispatchEventQueue, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_dispatchEventQueueInto_overloads, Pyrfa::dispatchEventQueueInto, 1, 4)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_wait_overloads, Pyrfa::wait, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setRequestWindow_overloads, Pyrfa::setRequestWindow, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_directorySubmit_overloads, Pyrfa::directorySubmit, 0, 2)
-BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_symbolListRequest_overloads, Pyrfa::symbolListRequest, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_symbolListRequest_overloads, Pyrfa::symbolListRequest, 0, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_serviceUpSubmit_overloads, Pyrfa::serviceUpSubmit, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_serviceDownSubmit_overloads, Pyrfa::serviceDownSubmit, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setView_overloads, Pyrfa::setView, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_closeSubmit_overloads, Pyrfa::closeSubmit, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_staleSubmit_overloads, Pyrfa::staleSubmit, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setCallback_overloads, Pyrfa::setCallback, 2, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_startDispatchThread_overloads, Pyrfa::startDispatchThread, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setImageCache_overloads, Pyrfa::setImageCache, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_getImage_overloads, Pyrfa::getImage, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setConflation_overloads, Pyrfa::setConflation, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setItemConflation_overloads, Pyrfa::setItemConflation, 2, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_setColumnFields_overloads, Pyrfa::setColumnFields, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_getBook_overloads, Pyrfa::getBook, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_getDepth_overloads, Pyrfa::getDepth, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(LazyUpdate_get_overloads, LazyUpdate::get, 1, 2)
+
+// pyrfa.Real(mantissa, exponent=0) and pyrfa.Real.fromHint(mantissa, hint)
+static boost::shared_ptr<RealValue> newReal(rfa::common::Int64 mantissa, int exponent) {
+    RealValue real;
+    if(!RealValue::fromExponent(mantissa, exponent, real)) {
+        PyErr_SetString(PyExc_ValueError, "Real exponent must be in -14 to 7");
+        throw_error_already_set();
+    }
+    return boost::shared_ptr<RealValue>(new RealValue(real));
+}
+
+static boost::shared_ptr<RealValue> newRealMantissa(rfa::common::Int64 mantissa) {
+    return newReal(mantissa, 0);
+}
+
+static RealValue realFromHint(rfa::common::Int64 mantissa, int hint) {
+    if(hint < 0 || hint > rfa::data::NotANumber) {
+        PyErr_SetString(PyExc_ValueError, "Real hint must be in 0 to 35");
+        throw_error_already_set();
+    }
+    return RealValue(mantissa, (rfa::common::UInt8)hint);
+}
+
+static object realEquals(const RealValue &real, object const &other) {
+    extract<const RealValue&> otherReal(other);
+    if(!otherReal.check())
+        return object(handle<>(borrowed(Py_NotImplemented)));
+    return object(real == otherReal());
+}
+
+static object realNotEquals(const RealValue &real, object const &other) {
+    extract<const RealValue&> otherReal(other);
+    if(!otherReal.check())
+        return object(handle<>(borrowed(Py_NotImplemented)));
+    return object(real != otherReal());
+}
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_marketPriceRequest_overloads, Pyrfa::marketPriceRequest, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_chainRequest_overloads, Pyrfa::chainRequest, 1, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_marketByOrderRequest_overloads, Pyrfa::marketByOrderRequest, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_marketByPriceRequest_overloads, Pyrfa::marketByPriceRequest, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_marketPriceBatchRequest_overloads, Pyrfa::marketPriceBatchRequest, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_marketByOrderBatchRequest_overloads, Pyrfa::marketByOrderBatchRequest, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_marketByPriceBatchRequest_overloads, Pyrfa::marketByPriceBatchRequest, 1, 2)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Pyrfa_historyBatchRequest_overloads, Pyrfa::historyBatchRequest, 1, 2)
 
 BOOST_PYTHON_MODULE(pyrfa)
 {
@@ -2759,7 +4345,7 @@ BOOST_PYTHON_MODULE(pyrfa)
         .def("getFieldID", &Pyrfa::getFieldID)
         .def("isNetworkDictionaryAvailable", &Pyrfa::isNetworkDictionaryAvailable)
         .def("isConnectionUp", &Pyrfa::isConnectionUp)
-        .def("symbolListRequest", &Pyrfa::symbolListRequest, Pyrfa_symbolListRequest_overloads( args("argv") ))
+        .def("symbolListRequest", &Pyrfa::symbolListRequest, Pyrfa_symbolListRequest_overloads( args("argv", "members", "subscribe") ))
         .def("symbolListCloseRequest", &Pyrfa::symbolListCloseRequest)
         .def("symbolListCloseAllRequest", &Pyrfa::symbolListCloseAllRequest)
         .def("isSymbolListRefreshComplete", &Pyrfa::isSymbolListRefreshComplete)
@@ -2768,6 +4354,7 @@ BOOST_PYTHON_MODULE(pyrfa)
         .def("getServiceName", &Pyrfa::getServiceName)
         .def("getSymbolList", &Pyrfa::getSymbolList)
         .def("getTimeSeries", &Pyrfa::getTimeSeries)
+        .def("getTimeSeriesBatch", &Pyrfa::getTimeSeriesBatch)
         .def("getWatchList", &Pyrfa::getMarketPriceWatchList)
         .def("getSymbolListWatchList", &Pyrfa::getSymbolListWatchList)
         .def("getMarketPriceWatchList", &Pyrfa::getMarketPriceWatchList)
@@ -2775,25 +4362,52 @@ BOOST_PYTHON_MODULE(pyrfa)
         .def("getMarketByPriceWatchList", &Pyrfa::getMarketByPriceWatchList)
         .def("getTimeSeriesWatchList", &Pyrfa::getTimeSeriesWatchList)
         .def("getHistoryWatchList", &Pyrfa::getHistoryWatchList)
-        .def("marketPriceRequest", &Pyrfa::marketPriceRequest)
+        .def("marketPriceRequest", &Pyrfa::marketPriceRequest, Pyrfa_marketPriceRequest_overloads( args("argv", "priority") ))
+        .def("marketPriceBatchRequest", &Pyrfa::marketPriceBatchRequest, Pyrfa_marketPriceBatchRequest_overloads( args("argv", "chunkSize") ))
         .def("marketPriceCloseRequest", &Pyrfa::marketPriceCloseRequest)
         .def("marketPriceCloseAllRequest", &Pyrfa::marketPriceCloseAllRequest)
         .def("marketPricePause", &Pyrfa::marketPricePause)
         .def("marketPriceResume", &Pyrfa::marketPriceResume)
-        .def("marketByOrderRequest", &Pyrfa::marketByOrderRequest)
+        .def("chainRequest", &Pyrfa::chainRequest, Pyrfa_chainRequest_overloads( args("ric", "subscribe", "track") ))
+        .def("chainCloseRequest", &Pyrfa::chainCloseRequest)
+        .def("getChain", &Pyrfa::getChain)
+        .def("marketByOrderRequest", &Pyrfa::marketByOrderRequest, Pyrfa_marketByOrderRequest_overloads( args("argv", "priority") ))
+        .def("marketByOrderBatchRequest", &Pyrfa::marketByOrderBatchRequest, Pyrfa_marketByOrderBatchRequest_overloads( args("argv", "chunkSize") ))
         .def("marketByOrderCloseRequest", &Pyrfa::marketByOrderCloseRequest)
         .def("marketByOrderCloseAllRequest", &Pyrfa::marketByOrderCloseAllRequest)
-        .def("marketByPriceRequest", &Pyrfa::marketByPriceRequest)
+        .def("marketByPriceRequest", &Pyrfa::marketByPriceRequest, Pyrfa_marketByPriceRequest_overloads( args("argv", "priority") ))
+        .def("marketByPriceBatchRequest", &Pyrfa::marketByPriceBatchRequest, Pyrfa_marketByPriceBatchRequest_overloads( args("argv", "chunkSize") ))
         .def("marketByPriceCloseRequest", &Pyrfa::marketByPriceCloseRequest)
         .def("marketByPriceCloseAllRequest", &Pyrfa::marketByPriceCloseAllRequest)
         .def("setInteractionType", &Pyrfa::setInteractionType)
         .def("setView", &Pyrfa::setView, Pyrfa_setView_overloads( args("argv") ))
+        .def("setRequestWindow", &Pyrfa::setRequestWindow, Pyrfa_setRequestWindow_overloads( args("window", "timeout") ))
+        .def("getRequestStats", &Pyrfa::getRequestStats)
+        .def("setImageCache", &Pyrfa::setImageCache, Pyrfa_setImageCache_overloads( args("enable", "mergeUpdates") ))
+        .def("getImage", &Pyrfa::getImage, Pyrfa_getImage_overloads( args("ric", "fields") ))
+        .def("setConflation", &Pyrfa::setConflation, Pyrfa_setConflation_overloads( args("interval", "tradeCount") ))
+        .def("setItemConflation", &Pyrfa::setItemConflation, Pyrfa_setItemConflation_overloads( args("argv", "interval", "tradeCount") ))
+        .def("getConflationStats", &Pyrfa::getConflationStats)
+        .def("setColumnFields", &Pyrfa::setColumnFields, Pyrfa_setColumnFields_overloads( args("fields", "capacity") ))
+        .def("getColumns", &Pyrfa::getColumns)
+        .def("setFieldFilter", &Pyrfa::setFieldFilter)
+        .def("setLazyDecode", &Pyrfa::setLazyDecode)
+        .def("setMarketByOrderBatch", &Pyrfa::setMarketByOrderBatch)
+        .def("setMarketByOrderBook", &Pyrfa::setMarketByOrderBook)
+        .def("getBook", &Pyrfa::getBook, Pyrfa_getBook_overloads( args("ric", "depth") ))
+        .def("setMarketByPriceBook", &Pyrfa::setMarketByPriceBook)
+        .def("getDepth", &Pyrfa::getDepth, Pyrfa_getDepth_overloads( args("ric", "depth") ))
+        .def("setDateTimeMode", &Pyrfa::setDateTimeMode)
+        .def("setRealMode", &Pyrfa::setRealMode)
         .def("setTimeSeriesPeriod", &Pyrfa::setTimeSeriesPeriod)
         .def("setTimeSeriesMaxRecords", &Pyrfa::setTimeSeriesMaxRecords)
+        .def("setTimeSeriesConcurrency", &Pyrfa::setTimeSeriesConcurrency)
+        .def("setTimeSeriesMode", &Pyrfa::setTimeSeriesMode)
         .def("timeSeriesRequest", &Pyrfa::timeSeriesRequest)
         .def("timeSeriesCloseRequest", &Pyrfa::timeSeriesCloseRequest)
         .def("timeSeriesCloseAllRequest", &Pyrfa::timeSeriesCloseAllRequest)
         .def("historyRequest", &Pyrfa::historyRequest)
+        .def("historyBatchRequest", &Pyrfa::historyBatchRequest, Pyrfa_historyBatchRequest_overloads( args("argv", "chunkSize") ))
         .def("historyCloseRequest", &Pyrfa::historyCloseRequest)
         .def("historyCloseAllRequest", &Pyrfa::historyCloseAllRequest)
         .def("directorySubmit", &Pyrfa::directorySubmit, Pyrfa_directorySubmit_overloads( args("argv1","argv2") ))
@@ -2816,6 +4430,47 @@ BOOST_PYTHON_MODULE(pyrfa)
         .def("getClientSessions", &Pyrfa::getClientSessions)
         .def("getClientWatchList", &Pyrfa::getClientWatchList)
         .def("dispatchEventQueue", &Pyrfa::dispatchEventQueue, Pyrfa_dispatchEventQueue_overloads( args("timeout") ))
+        .def("startDispatchThread", &Pyrfa::startDispatchThread, Pyrfa_startDispatchThread_overloads( args("capacity") ))
+        .def("stopDispatchThread", &Pyrfa::stopDispatchThread)
+        .def("getEventRingStats", &Pyrfa::getEventRingStats)
+        .def("setCallback", &Pyrfa::setCallback, Pyrfa_setCallback_overloads( args("domain", "callback", "ric") ))
+        .def("dispatchEventQueueInto", &Pyrfa::dispatchEventQueueInto, Pyrfa_dispatchEventQueueInto_overloads( args("out", "timeout", "maxEvents", "budget") ))
+        .def("wait", &Pyrfa::wait, Pyrfa_wait_overloads( args("completions", "timeout") ))
         //.def("deactivateEventQueue", &Pyrfa::deactivateEventQueue);
         ;
+
+    class_<Completion, boost::shared_ptr<Completion>, boost::noncopyable>("Completion", no_init)
+        .def("done", &Completion::done)
+        .def("pending", &Completion::pending)
+        .def("failed", &Completion::failed)
+        ;
+
+    class_<LazyUpdate, boost::shared_ptr<LazyUpdate>, boost::noncopyable>("LazyUpdate", no_init)
+        .def("__getitem__", &LazyUpdate::getItem)
+        .def("__contains__", &LazyUpdate::contains)
+        .def("__len__", &LazyUpdate::size)
+        .def("__iter__", &LazyUpdate::iter)
+        .def("get", &LazyUpdate::get, LazyUpdate_get_overloads( args("key", "default") ))
+        .def("keys", &LazyUpdate::keys)
+        .def("values", &LazyUpdate::values)
+        .def("items", &LazyUpdate::items)
+        .def("toDict", &LazyUpdate::toDict)
+        ;
+
+    class_<RealValue, boost::shared_ptr<RealValue> >("Real", no_init)
+        .def("__init__", make_constructor(&newReal, default_call_policies(), args("mantissa", "exponent")))
+        .def("__init__", make_constructor(&newRealMantissa, default_call_policies(), args("mantissa")))
+        .def("fromHint", &realFromHint)
+        .staticmethod("fromHint")
+        .add_property("mantissa", &RealValue::getMantissa)
+        .add_property("hint", &RealValue::getHint)
+        .add_property("exponent", &RealValue::getExponent)
+        .add_property("denominator", &RealValue::getDenominator)
+        .def("__float__", &RealValue::toDouble)
+        .def("__str__", &RealValue::toString)
+        .def("__repr__", &RealValue::repr)
+        .def("__eq__", &realEquals)
+        .def("__ne__", &realNotEquals)
+        .def("__hash__", &RealValue::hash)
+        ;
 }
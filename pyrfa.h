@@ -5,11 +5,17 @@
 #include "Python.h"
 #include "StdAfx.h"
 #include "config/configdb.h"
+#include "common/ColumnBuffer.h"
+#include "common/Completion.h"
+#include "common/FieldDecodeTable.h"
 
 //Boost Header files
 #include <boost/python.hpp>
 #include <boost/python/module.hpp>
 #include <boost/python/def.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <map>
 
 // class forwarding
 class LoginHandler;
@@ -17,6 +23,7 @@ class DirectoryHandler;
 class DictionaryHandler;
 class SymbolListHandler;
 class MarketPriceHandler;
+class ChainHandler;
 class MarketByOrderHandler;
 class MarketByPriceHandler;
 class OMMCProvServer;
@@ -26,6 +33,10 @@ class TS1DefDb;
 class TS1Series;
 class HistoryHandler;
 class OMMPost;
+class DispatchThread;
+class CEventRing;
+class CMutex;
+struct EventRecord;
 
 //RFA Header files
 
@@ -57,7 +68,7 @@ public:
     void                            dictionaryRequest();
     int                             getFieldType(object const &argv);
     int                             getFieldID(object const &argv);
-    void                            symbolListRequest(object const &argv);
+    object                          symbolListRequest(object const &argv, bool members, bool subscribe);
     void                            symbolListCloseRequest(object const &argv);
     void                            symbolListCloseAllRequest();
     bool                            isNetworkDictionaryAvailable() const;
@@ -66,36 +77,69 @@ public:
     bool                            isHistoryRefreshComplete() const;
     bool                            isConnectionUp() const;
     std::string                     getSymbolList(object const &argv);
-    boost::python::tuple            getTimeSeries(object const &argv);
+    object                          getTimeSeries(object const &argv);
+    dict                            getTimeSeriesBatch(object const &argv);
     std::string                     getSymbolListWatchList();
     std::string                     getMarketPriceWatchList();
     std::string                     getMarketByOrderWatchList();
     std::string                     getMarketByPriceWatchList();
     std::string                     getTimeSeriesWatchList();
     std::string                     getHistoryWatchList();
-    void                            marketPriceRequest(object const &argv);
+    object                          marketPriceRequest(object const &argv, int priority);
+    void                            marketPriceBatchRequest(object const &argv, long chunkSize);
     void                            marketPriceCloseRequest(object const &argv);
     void                            marketPriceCloseAllRequest();
     void                            marketPricePause(object const &argv);
     void                            marketPriceResume(object const &argv);
-    void                            marketByOrderRequest(object const &argv);
+    object                          chainRequest(object const &argv, bool subscribe, bool track);
+    void                            chainCloseRequest(object const &argv);
+    object                          getChain(object const &argv);
+    void                            marketByOrderRequest(object const &argv, int priority);
+    void                            marketByOrderBatchRequest(object const &argv, long chunkSize);
     void                            marketByOrderCloseRequest(object const &argv);
     void                            marketByOrderCloseAllRequest();
-    void                            marketByPriceRequest(object const &argv);
+    void                            marketByPriceRequest(object const &argv, int priority);
+    void                            marketByPriceBatchRequest(object const &argv, long chunkSize);
     void                            marketByPriceCloseRequest(object const &argv);
     void                            marketByPriceCloseAllRequest();
     void                            setInteractionType(object const &argv);
     void                            setView(object const &argv);
+    void                            setRequestWindow(long window, long timeout);
+    dict                            getRequestStats();
+    void                            setImageCache(bool enable, bool mergeUpdates);
+    dict                            getImage(object const &argv1, object const &argv2);
+    void                            setConflation(long interval, long tradeCount);
+    void                            setItemConflation(object const &argv, long interval, long tradeCount);
+    dict                            getConflationStats();
+    void                            setFieldFilter(object const &argv1, object const &argv2);
+    void                            setLazyDecode(bool lazy);
+    void                            setMarketByOrderBatch(bool batch);
+    void                            setMarketByOrderBook(long depth);
+    dict                            getBook(object const &argv, long depth);
+    void                            setMarketByPriceBook(long depth);
+    dict                            getDepth(object const &argv, long depth);
+    void                            setDateTimeMode(object const &argv);
+    void                            setRealMode(object const &argv);
+    void                            setColumnFields(object const &argv, long capacity);
+    dict                            getColumns();
     void                            setTimeSeriesPeriod(object const &argv);
     void                            setTimeSeriesMaxRecords(int maxRecords);
-    void                            timeSeriesRequest(object const &argv);
+    void                            setTimeSeriesConcurrency(int concurrency);
+    void                            setTimeSeriesMode(object const &argv);
+    object                          timeSeriesRequest(object const &argv);
     void                            timeSeriesCloseRequest(object const &argv);
     void                            timeSeriesCloseAllRequest();
-    void                            historyRequest(object const &argv);
+    object                          historyRequest(object const &argv);
+    void                            historyBatchRequest(object const &argv, long chunkSize);
     void                            historyCloseRequest(object const &argv);
     void                            historyCloseAllRequest();
     boost::python::tuple            dispatchEventQueue(long timeout);
+    long                            dispatchEventQueueInto(boost::python::list out, long timeout, long maxEvents, long budget);
+    bool                            wait(object const &argv, long timeout);
     void                            dispatchLoggerEventQueue(long timeout);
+    void                            startDispatchThread(long capacity);
+    void                            stopDispatchThread();
+    dict                            getEventRingStats();
     void                            deactivateEventQueue();
     void                            directorySubmit(object const &argv1, object const &argv2);
     void                            marketPriceSubmit(object const &argv);
@@ -123,6 +167,7 @@ public:
     void                            logError(object const &argv);
     void                            setServiceName(object const &argv);
     std::string                     getServiceName();
+    void                            setCallback(object const &argv1, object const &argv2, object const &argv3);
     rfa::common::EventQueue&        eventQueue() { return *_pEventQueue; }
     rfa::logger::ApplicationLogger& logger() { return *_pLogger; }
     rfa::sessionLayer::Session&     session() { return *_pSession; }
@@ -132,12 +177,36 @@ protected:
     void processEvent(const rfa::common::Event& event); // must implement
 
 private:
+    // output of getTimeSeries(), CSV records or typed columns dated in epoch days or seconds
+    enum TimeSeriesMode { TimeSeriesRecords, TimeSeriesDays, TimeSeriesSeconds };
+
     void                            processConnectionEvent(const rfa::sessionLayer::ConnectionEvent & CEvent);
     void                            processOMMItemEvent(const rfa::sessionLayer::OMMItemEvent &OMMEvent);
     void                            processOMMCmdErrorEvent(const rfa::sessionLayer::OMMCmdErrorEvent &CmdEvent);
     void                            processOMMActiveClientSessionEvent(const rfa::sessionLayer::OMMActiveClientSessionEvent& event);
     void                            processOMMInactiveClientSessionEvent(const rfa::sessionLayer::OMMInactiveClientSessionEvent& event);
     void                            processOMMSolicitedItemEvent(const rfa::sessionLayer::OMMSolicitedItemEvent& event);
+    void                            dispatchCallbacks(int domain, boost::python::list &events);
+    bool                            processNativeOMMItemEvent(const rfa::sessionLayer::OMMItemEvent &OMMEvent);
+    void                            pushEventData(rfa::common::UInt8 msgModelType);
+    long                            drainEventRing(boost::python::list out, long timeout, long maxEvents, long budget);
+    object                          eventRecordToPython(const EventRecord &record);
+    void                            flushConflated(boost::python::list &out);
+    void                            batchItemList(object const &argv, vector<string> &itemList);
+    boost::python::tuple            timeSeriesRecords(const std::string &itemName);
+    object                          timeSeriesOutput(const std::string &itemName);
+    void                            updateSubscriptions();
+    // with the market price lock held
+    bool                            createMarketPriceHandler();
+    boost::shared_ptr<Completion>   requestMarketPrice(const vector<string> &itemList, int priority);
+    void                            closeMarketPrice(const vector<string> &itemList);
+    long                            dispatchEvents(boost::python::list out, long timeout, long maxEvents, long budget);
+    boost::shared_ptr<Completion>   addCompletion(CompletionRegistry::Domain domain, const vector<string> &names);
+    object                          newCompletion(CompletionRegistry::Domain domain, const vector<string> &names);
+    // dispatch until every completion is done, the events dispatched meanwhile go to events
+    bool                            waitFor(const vector<boost::shared_ptr<Completion> > &completions, long timeout, boost::python::list &events);
+    bool                            waitFor(const boost::shared_ptr<Completion> &completion);
+    bool                            fieldIdList(object const &argv, std::vector<rfa::common::Int16> &fieldIds);
     void                            _logInfo(std::string log);
     void                            _logWarning(std::string log);
     void                            _logError(std::string log);
@@ -155,10 +224,10 @@ private:
     DictionaryHandler               *_pDictionaryHandler;
     SymbolListHandler               *_pSymbolListHandler;
     MarketPriceHandler              *_pMarketPriceHandler;
+    ChainHandler                    *_pChainHandler;
     MarketByOrderHandler            *_pMarketByOrderHandler;
     MarketByPriceHandler            *_pMarketByPriceHandler;
     TimeSeriesHandler               *_pTimeSeriesHandler;
-    rfa::ts1::TS1Series             *_pTimeSeries;
     rfa::ts1::TS1DefDb              *_pTS1DictDb;
     HistoryHandler                  *_pHistoryHandler;
     rfa::common::Handle             *_pConnHandle;
@@ -170,8 +239,7 @@ private:
     bool                            _isSymbolListAvailable;
     bool                            _isHistoryAvailable;
     bool                            _isPublisher;
-    boost::python::tuple            _out;
-    boost::python::tuple            _eventData;
+    boost::python::list             _eventData;
     rfa::common::RFA_String         _log;
     bool                            _isConnectionUp;
     OMMCProvServer                  *_pOMMCProvServer;
@@ -182,15 +250,44 @@ private:
     std::string                     _serviceName;
     std::string                     _vendorName;
     std::string                     _connectionType;
-    boost::python::tuple            _timeSeries;
+    object                          _timeSeries;
     rfa::ts1::TS1Series::Period     _timeSeriesPeriod;
     int                             _timeSeriesMaxRecords;
+    int                             _timeSeriesConcurrency;
+    TimeSeriesMode                  _timeSeriesMode;
     std::string                     _userName;
     rfa::common::UInt8              _interactionType;
     std::string                     _viewFIDs;
     rfa::common::RFA_String         _fieldDictionaryFilename;
     rfa::common::RFA_String         _enumTypeFilename;
     boost::python::tuple            _directory;
+    boost::python::dict             _callbacks;
+    boost::python::dict             _ricCallbacks;
+    DispatchThread                  *_pDispatchThread;
+    CEventRing                      *_pEventRing;
+    CMutex                          *_pMarketPriceMutex;
+    CompletionRegistry              *_pCompletions;
+    // events dispatched by wait(), handed out by the next dispatchEventQueueInto()
+    boost::python::list             _heldEvents;
+    long                            _requestWindow;
+    long                            _requestTimeout;
+    // owners of the market price items, the user and each auto-subscribed chain and symbol list.
+    // an item is closed once it has none left
+    boost::unordered_map<std::string, int> _itemOwners;
+    boost::unordered_set<std::string> _userItems;
+    bool                            _cacheImages;
+    bool                            _mergeUpdates;
+    long                            _conflationInterval;
+    long                            _conflationTradeCount;
+    std::vector<ColumnBuffer::Field> _columnFields;
+    long                            _columnCapacity;
+    std::map<int, std::vector<rfa::common::Int16> > _fieldFilters;
+    bool                            _lazyDecode;
+    bool                            _marketByOrderBatch;
+    size_t                          _marketByOrderBookDepth;
+    size_t                          _marketByPriceBookDepth;
+    FieldDecodeTable::DateTimeMode  _dateTimeMode;
+    FieldDecodeTable::RealMode      _realMode;
 };
 
 class py_error {